@@ -0,0 +1,121 @@
+#include "AdmissionController.h"
+
+#include <algorithm>
+
+#include "HailoProcessorStats.h"
+
+using namespace std::chrono;
+
+AdmissionController::AdmissionController(const HailoProcessorStats& stats, uint32_t deviceSlots)
+	: _stats(stats), _deviceSlots(std::max<uint32_t>(deviceSlots, 1))
+{
+}
+
+void AdmissionController::Configure(const AdmissionConfig& config)
+{
+	std::lock_guard<std::mutex> lock(_mx);
+	_config = config;
+	_nextAdmission = steady_clock::time_point();
+}
+
+AdmissionConfig AdmissionController::Config()
+{
+	std::lock_guard<std::mutex> lock(_mx);
+	return _config;
+}
+
+// Each stage adds its service time, plus the time to work off what is queued in front of it:
+// the device completes one write per service time / slots, the other stages one frame per service time / threads.
+nanoseconds AdmissionController::Predict(const PipelineLoad& load, uint32_t cost) const
+{
+	const nanoseconds device = _stats.readInterferenceProcessing.ServiceTime();
+	if (device == nanoseconds::zero())
+		return nanoseconds::zero();
+	const nanoseconds post = _stats.postProcessing.ServiceTime();
+	const nanoseconds callback = _stats.callbackProcessing.ServiceTime();
+	const int postThreads = std::max(_stats.postProcessing.ThreadCount(), 1);
+	const int callbackThreads = std::max(_stats.callbackProcessing.ThreadCount(), 1);
+
+	const auto ahead = static_cast<int64_t>(load.Scheduled + load.Device + cost - 1);
+	nanoseconds total = device + device * ahead / static_cast<int64_t>(_deviceSlots);
+	total += std::max(post, post * static_cast<int64_t>(load.PostProcessing + cost) / postThreads);
+	total += std::max(callback, callback * static_cast<int64_t>(load.Callback + 1) / callbackThreads);
+	return total;
+}
+
+nanoseconds AdmissionController::Bottleneck() const
+{
+	const int postThreads = std::max(_stats.postProcessing.ThreadCount(), 1);
+	const int callbackThreads = std::max(_stats.callbackProcessing.ThreadCount(), 1);
+	return std::max({ _stats.readInterferenceProcessing.ServiceTime() / static_cast<int64_t>(_deviceSlots),
+		_stats.postProcessing.ServiceTime() / postThreads,
+		_stats.callbackProcessing.ServiceTime() / callbackThreads });
+}
+
+AdmissionDecision AdmissionController::Decide(const PipelineLoad& load, uint32_t cost)
+{
+	const AdmissionConfig config = Config();
+	const nanoseconds predicted = Predict(load, cost);
+	_predicted.store(predicted.count(), std::memory_order_relaxed);
+
+	AdmissionDecision decision = AdmissionDecision::Admit;
+	if (config.Mode == AdmissionMode::Latency)
+		decision = DecideLatency(config, load, cost, predicted);
+	else if (config.Mode == AdmissionMode::Throughput)
+		decision = DecideThroughput(config, cost);
+
+	switch (decision) {
+		case AdmissionDecision::Admit: _admitted.fetch_add(1, std::memory_order_relaxed); break;
+		case AdmissionDecision::Drop: _dropped.fetch_add(1, std::memory_order_relaxed); break;
+		case AdmissionDecision::Downscale: _downscaled.fetch_add(1, std::memory_order_relaxed); break;
+	}
+	return decision;
+}
+
+AdmissionDecision AdmissionController::DecideLatency(const AdmissionConfig& config, const PipelineLoad& load, uint32_t cost, nanoseconds predicted)
+{
+	// nothing measured yet.
+	if (predicted == nanoseconds::zero() || predicted <= config.MaxLatency)
+		return AdmissionDecision::Admit;
+	if (config.AllowDownscale && cost > 1 && Predict(load, 1) <= config.MaxLatency)
+		return AdmissionDecision::Downscale;
+	return AdmissionDecision::Drop;
+}
+
+// Admissions are spaced by the time the frame occupies the slowest stage, or by 1 / TargetFps when that is longer.
+// A frame arriving a little late keeps the schedule, so jitter does not cost throughput; after an idle period
+// the schedule restarts instead of admitting a burst.
+AdmissionDecision AdmissionController::DecideThroughput(const AdmissionConfig& config, uint32_t cost)
+{
+	const nanoseconds frame = config.TargetFps > 0.0f
+		? duration_cast<nanoseconds>(duration<double>(1.0 / config.TargetFps))
+		: nanoseconds::zero();
+	const nanoseconds bottleneck = Bottleneck();
+
+	AdmissionDecision decision = AdmissionDecision::Admit;
+	const nanoseconds full = bottleneck * static_cast<int64_t>(cost);
+	nanoseconds interval = std::max(frame, full);
+	if (config.AllowDownscale && cost > 1 && frame > nanoseconds::zero() && full > frame && bottleneck <= frame) {
+		decision = AdmissionDecision::Downscale;
+		interval = frame;
+	}
+
+	std::lock_guard<std::mutex> lock(_mx);
+	const auto now = steady_clock::now();
+	if (now < _nextAdmission)
+		return AdmissionDecision::Drop;
+	_nextAdmission = std::max(_nextAdmission + interval, now + interval / 2);
+	return decision;
+}
+
+void AdmissionController::Snapshot(AdmissionStatsDto& dto)
+{
+	dto.mode = static_cast<int>(Config().Mode);
+	dto.admitted = _admitted.load(std::memory_order_relaxed);
+	dto.dropped = _dropped.load(std::memory_order_relaxed);
+	dto.downscaled = _downscaled.load(std::memory_order_relaxed);
+	dto.predictedLatency = _predicted.load(std::memory_order_relaxed);
+	dto.deviceServiceTime = _stats.readInterferenceProcessing.ServiceTime().count();
+	dto.postProcessingServiceTime = _stats.postProcessing.ServiceTime().count();
+	dto.callbackServiceTime = _stats.callbackProcessing.ServiceTime().count();
+}
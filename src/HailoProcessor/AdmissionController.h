@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include "HailoProcessorStatsDto.h"
+
+struct HailoProcessorStats;
+
+enum class AdmissionMode {
+	// Every frame is admitted; the prediction and the counters are still updated.
+	Off,
+	// Admits a frame when its predicted end-to-end latency is within MaxLatency.
+	Latency,
+	// Paces admissions to TargetFps, or to what the slowest stage sustains when that is lower.
+	Throughput
+};
+
+enum class AdmissionDecision {
+	Admit,
+	Drop,
+	// Run a tiled frame as a single inference over the whole ROI.
+	Downscale
+};
+
+struct AdmissionConfig {
+	AdmissionMode Mode = AdmissionMode::Off;
+	std::chrono::nanoseconds MaxLatency{0};
+	// Frames per second over all cameras, 0 for as many as the pipeline sustains.
+	float TargetFps = 0.0f;
+	// A tiled frame that does not fit may be downscaled instead of dropped.
+	bool AllowDownscale = true;
+};
+
+// What is waiting in front of each stage when a frame is offered.
+struct PipelineLoad {
+	// Device writes queued in the camera queues.
+	size_t Scheduled = 0;
+	// Writes on the device.
+	size_t Device = 0;
+	size_t PostProcessing = 0;
+	size_t Callback = 0;
+};
+
+// Decides per frame whether it enters the pipeline, from the EWMA service times of the stages (StageStats::ServiceTime)
+// and the current backlog, so latency stays bounded under bursts instead of frames going stale in the queues.
+class AdmissionController {
+public:
+	using AdmissionStatsDto = HailoProcessorStatsDto::AdmissionStatsDto;
+
+	// deviceSlots - writes the device holds at once.
+	AdmissionController(const HailoProcessorStats& stats, uint32_t deviceSlots);
+
+	void Configure(const AdmissionConfig& config);
+	AdmissionConfig Config();
+
+	// cost - device writes of the frame, more than one for tiled frames which are the only ones that can be downscaled.
+	AdmissionDecision Decide(const PipelineLoad& load, uint32_t cost);
+	// End-to-end latency of a frame of cost writes offered under load, zero until every stage processed a frame.
+	std::chrono::nanoseconds Predict(const PipelineLoad& load, uint32_t cost) const;
+
+	void Snapshot(AdmissionStatsDto& dto);
+private:
+	AdmissionDecision DecideLatency(const AdmissionConfig& config, const PipelineLoad& load, uint32_t cost, std::chrono::nanoseconds predicted);
+	AdmissionDecision DecideThroughput(const AdmissionConfig& config, uint32_t cost);
+	// Time per device write of the slowest stage.
+	std::chrono::nanoseconds Bottleneck() const;
+
+	const HailoProcessorStats& _stats;
+	const uint32_t _deviceSlots;
+	std::mutex _mx;
+	AdmissionConfig _config;
+	std::chrono::steady_clock::time_point _nextAdmission;
+
+	std::atomic<uint64_t> _admitted{0};
+	std::atomic<uint64_t> _dropped{0};
+	std::atomic<uint64_t> _downscaled{0};
+	std::atomic<std::chrono::nanoseconds::rep> _predicted{0};
+};
@@ -0,0 +1,242 @@
+#include "Allocator.h"
+
+#include <algorithm>
+#include <fstream>
+#include <new>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "Channel.hpp"
+
+// classes from one page up to 2^MAX_CLASS_SHIFT bytes.
+#define MAX_CLASS_SHIFT 28
+// bytes kept per class in the freelist, FREE_LIST_DEPTH blocks at most and two at least.
+#define FREE_LIST_BYTES (64 << 20)
+#define FREE_LIST_DEPTH 32
+// classes up to 2^THREAD_CACHE_SHIFT bytes are cached per thread, THREAD_CACHE_DEPTH blocks each.
+#define THREAD_CACHE_SHIFT 18
+#define THREAD_CACHE_DEPTH 4
+
+namespace {
+
+constexpr int MaxClasses = MAX_CLASS_SHIFT - 11;
+
+size_t Log2(size_t value)
+{
+	size_t shift = 0;
+	while ((size_t(1) << shift) < value)
+		shift++;
+	return shift;
+}
+
+size_t HugePageSize()
+{
+	std::ifstream meminfo("/proc/meminfo");
+	std::string key;
+	size_t kb = 0;
+	while (meminfo >> key) {
+		if (key == "Hugepagesize:" && meminfo >> kb)
+			return kb * 1024;
+		meminfo.ignore(256, '\n');
+	}
+	return 2 << 20;
+}
+
+// set when the thread's cache is destroyed, buffers released after that by other thread_local or static objects bypass it.
+thread_local bool ThreadCacheGone = false;
+
+void UpdatePeak(std::atomic<uint64_t>& peak, uint64_t value)
+{
+	uint64_t current = peak.load(std::memory_order_relaxed);
+	while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) ;
+}
+
+}
+
+struct PageAlignedMemoryPool::FreeList {
+	std::unique_ptr<channel_detail::MpmcRing<void*>> Blocks;
+};
+
+// Flushed to the freelists when the thread exits.
+struct PageAlignedMemoryPool::ThreadCache {
+	struct Bin {
+		void* Blocks[THREAD_CACHE_DEPTH];
+		uint32_t Count = 0;
+	};
+	Bin Bins[MaxClasses];
+
+	~ThreadCache() {
+		ThreadCacheGone = true;
+		auto& pool = PageAlignedMemoryPool::Shared();
+		for (int c = 0; c < MaxClasses; c++) {
+			auto& bin = Bins[c];
+			while (bin.Count > 0) {
+				void* block = bin.Blocks[--bin.Count];
+				if (!pool._freeLists[c].Blocks->TryPush(block))
+					pool.Unmap(block, pool.ClassSize(c));
+			}
+		}
+	}
+};
+
+PageAlignedMemoryPool& PageAlignedMemoryPool::Shared()
+{
+	// never destroyed: threads flush their caches into it on exit, which may be after static destruction.
+	static PageAlignedMemoryPool* pool = new PageAlignedMemoryPool();
+	return *pool;
+}
+
+PageAlignedMemoryPool::PageAlignedMemoryPool()
+	: _pageShift(Log2(static_cast<size_t>(sysconf(_SC_PAGESIZE)))),
+	_hugePageSize(HugePageSize()),
+	_freeLists(new FreeList[MaxClasses])
+{
+	for (int c = 0; c < MaxClasses; c++) {
+		const size_t depth = std::clamp<size_t>(FREE_LIST_BYTES / ClassSize(c), 2, FREE_LIST_DEPTH);
+		_freeLists[c].Blocks = std::make_unique<channel_detail::MpmcRing<void*>>(depth);
+	}
+}
+
+void PageAlignedMemoryPool::Configure(const MemoryPoolOptions& options)
+{
+	_hugePages.store(options.HugePages, std::memory_order_relaxed);
+	_lock.store(options.Lock, std::memory_order_relaxed);
+}
+
+MemoryPoolOptions PageAlignedMemoryPool::Options() const
+{
+	MemoryPoolOptions options;
+	options.HugePages = _hugePages.load(std::memory_order_relaxed);
+	options.Lock = _lock.load(std::memory_order_relaxed);
+	return options;
+}
+
+int PageAlignedMemoryPool::ClassOf(size_t size) const
+{
+	const size_t shift = std::max(Log2(size), _pageShift);
+	if (shift > MAX_CLASS_SHIFT || shift - _pageShift >= MaxClasses)
+		return -1;
+	return static_cast<int>(shift - _pageShift);
+}
+
+size_t PageAlignedMemoryPool::ClassSize(int sizeClass) const
+{
+	return size_t(1) << (_pageShift + sizeClass);
+}
+
+PageAlignedMemoryPool::ThreadCache* PageAlignedMemoryPool::LocalCache()
+{
+	if (ThreadCacheGone)
+		return nullptr;
+	thread_local ThreadCache cache;
+	return &cache;
+}
+
+void* PageAlignedMemoryPool::Rent(size_t size)
+{
+	_rents.fetch_add(1, std::memory_order_relaxed);
+	const int c = ClassOf(size);
+	if (c < 0) {
+		const size_t mapped = (size + ClassSize(0) - 1) & ~(ClassSize(0) - 1);
+		Used(static_cast<int64_t>(mapped));
+		return Map(mapped);
+	}
+	const size_t classSize = ClassSize(c);
+	Used(static_cast<int64_t>(classSize));
+
+	ThreadCache* cache = _pageShift + c <= THREAD_CACHE_SHIFT ? LocalCache() : nullptr;
+	if (cache != nullptr && cache->Bins[c].Count > 0) {
+		_threadCacheHits.fetch_add(1, std::memory_order_relaxed);
+		auto& bin = cache->Bins[c];
+		return bin.Blocks[--bin.Count];
+	}
+	void* block;
+	if (_freeLists[c].Blocks->TryPop(block)) {
+		_freeListHits.fetch_add(1, std::memory_order_relaxed);
+		return block;
+	}
+	return Map(classSize);
+}
+
+void PageAlignedMemoryPool::Return(void* buffer, size_t size)
+{
+	if (buffer == nullptr)
+		return;
+	const int c = ClassOf(size);
+	if (c < 0) {
+		const size_t mapped = (size + ClassSize(0) - 1) & ~(ClassSize(0) - 1);
+		Used(-static_cast<int64_t>(mapped));
+		Unmap(buffer, mapped);
+		return;
+	}
+	const size_t classSize = ClassSize(c);
+	Used(-static_cast<int64_t>(classSize));
+
+	ThreadCache* cache = _pageShift + c <= THREAD_CACHE_SHIFT ? LocalCache() : nullptr;
+	if (cache != nullptr && cache->Bins[c].Count < THREAD_CACHE_DEPTH) {
+		auto& bin = cache->Bins[c];
+		bin.Blocks[bin.Count++] = buffer;
+		return;
+	}
+	if (!_freeLists[c].Blocks->TryPush(buffer))
+		Unmap(buffer, classSize);
+}
+
+void PageAlignedMemoryPool::Used(int64_t bytes)
+{
+	const uint64_t used = _inUse.fetch_add(static_cast<uint64_t>(bytes), std::memory_order_relaxed) + static_cast<uint64_t>(bytes);
+	if (bytes > 0)
+		UpdatePeak(_peakInUse, used);
+}
+
+void* PageAlignedMemoryPool::Map(size_t size)
+{
+	const MemoryPoolOptions options = Options();
+	void* block = MAP_FAILED;
+	if (options.HugePages && size >= _hugePageSize && size % _hugePageSize == 0) {
+		block = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (block != MAP_FAILED)
+			_hugePageBlocks.fetch_add(1, std::memory_order_relaxed);
+	}
+	if (block == MAP_FAILED) {
+		block = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (block == MAP_FAILED)
+			throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+		// no hugepages reserved, let khugepaged back it instead.
+		if (options.HugePages && size >= _hugePageSize)
+			madvise(block, size, MADV_HUGEPAGE);
+#endif
+	}
+	if (options.Lock && mlock(block, size) != 0)
+		_lockFailures.fetch_add(1, std::memory_order_relaxed);
+
+	_maps.fetch_add(1, std::memory_order_relaxed);
+	UpdatePeak(_peakMapped, _mapped.fetch_add(size, std::memory_order_relaxed) + size);
+	return block;
+}
+
+void PageAlignedMemoryPool::Unmap(void* buffer, size_t size)
+{
+	munmap(buffer, size);
+	_unmaps.fetch_add(1, std::memory_order_relaxed);
+	_mapped.fetch_sub(size, std::memory_order_relaxed);
+}
+
+void PageAlignedMemoryPool::Snapshot(MemoryPoolStatsDto& dto) const
+{
+	dto.hugePages = _hugePages.load(std::memory_order_relaxed) ? 1 : 0;
+	dto.locked = _lock.load(std::memory_order_relaxed) ? 1 : 0;
+	dto.mappedBytes = _mapped.load(std::memory_order_relaxed);
+	dto.peakMappedBytes = _peakMapped.load(std::memory_order_relaxed);
+	dto.inUseBytes = _inUse.load(std::memory_order_relaxed);
+	dto.peakInUseBytes = _peakInUse.load(std::memory_order_relaxed);
+	dto.rents = _rents.load(std::memory_order_relaxed);
+	dto.threadCacheHits = _threadCacheHits.load(std::memory_order_relaxed);
+	dto.freeListHits = _freeListHits.load(std::memory_order_relaxed);
+	dto.maps = _maps.load(std::memory_order_relaxed);
+	dto.unmaps = _unmaps.load(std::memory_order_relaxed);
+	dto.hugePageBlocks = _hugePageBlocks.load(std::memory_order_relaxed);
+	dto.lockFailures = _lockFailures.load(std::memory_order_relaxed);
+}
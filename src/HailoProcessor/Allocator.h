@@ -1,69 +1,110 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <vector>
-#include <stdlib.h>
-#include <sys/mman.h>
-
-// A very simple page-aligned memory heap.
-// DO NOT use this if you are allocating more than a handful of buffers.
-// All operations are O(n) where n is the number of buffers allocated.
-// We only reuse buffers when the requested size matches 100%.
-// So this is intended for frequent re-use where the buffer sizes are consistent.
+
+#include "HailoProcessorStatsDto.h"
+
+struct MemoryPoolOptions {
+	// Blocks of a hugepage and more are mapped with MAP_HUGETLB when hugepages are reserved,
+	// otherwise advised as transparent hugepages.
+	bool HugePages = false;
+	// Blocks are locked in memory, so the pipeline never takes a page fault on them. Limited by RLIMIT_MEMLOCK.
+	bool Lock = false;
+};
+
+// Page-aligned buffers for frames and tensors, one pool per process (Shared).
+// Sizes are rounded up to a power-of-two class, at least a page. A returned block is kept for the next rent
+// of its class: first in a small per-thread cache, then in a lock-free freelist per class, and only unmapped
+// when both are full. A freelist holds a bounded number of bytes, so the larger the class the fewer blocks
+// it keeps. Blocks above the largest class are mapped and unmapped directly.
+// Options apply to the blocks mapped after they were set.
 class PageAlignedMemoryPool {
 public:
-	struct Buffer {
-		void* P;
-		size_t Size;
-	};
-	std::vector<Buffer> Used;
-	std::vector<Buffer> Available;
-
-	~PageAlignedMemoryPool() {
-		for (auto b : Used)
-			munmap(b.P, b.Size);
-		for (auto b : Available)
-			munmap(b.P, b.Size);
-	}
+	using MemoryPoolStatsDto = HailoProcessorStatsDto::MemoryPoolStatsDto;
+
+	static PageAlignedMemoryPool& Shared();
+
+	void Configure(const MemoryPoolOptions& options);
+	MemoryPoolOptions Options() const;
+
+	void* Rent(size_t size);
+	// size as passed to Rent.
+	void Return(void* buffer, size_t size);
+
 	template <typename T>
 	std::shared_ptr<T> Rent(size_t count) {
 		size_t size = count * sizeof(T);
 		void* memory = Rent(size);
 
 		// Custom deleter to return memory to the pool
-		auto deleter = [this](T* ptr) {
-			this->Return(ptr);
+		auto deleter = [this, size](T* ptr) {
+			this->Return(ptr, size);
 			};
 
 		return std::shared_ptr<T>(static_cast<T*>(memory), deleter);
 	}
-	void* Rent(size_t size) {
-		for (size_t i = 0; i < Available.size(); i++) {
-			if (Available[i].Size == size) {
-				void* p = Available[i].P;
-				Used.push_back(Available[i]);
-				std::swap(Available[i], Available.back());
-				Available.pop_back();
-				return p;
-			}
-		}
-		Buffer b;
-		b.P = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-		b.Size = size;
-		Used.push_back(b);
-		return b.P;
+
+	void Snapshot(MemoryPoolStatsDto& dto) const;
+private:
+	PageAlignedMemoryPool();
+	PageAlignedMemoryPool(const PageAlignedMemoryPool&) = delete;
+	PageAlignedMemoryPool& operator=(const PageAlignedMemoryPool&) = delete;
+
+	struct ThreadCache;
+	struct FreeList;
+	// nullptr once the calling thread's cache was destroyed.
+	static ThreadCache* LocalCache();
+
+	// -1 above the largest class.
+	int ClassOf(size_t size) const;
+	size_t ClassSize(int sizeClass) const;
+	void* Map(size_t size);
+	void Unmap(void* buffer, size_t size);
+	void Used(int64_t bytes);
+
+	size_t _pageShift;
+	size_t _hugePageSize;
+	std::unique_ptr<FreeList[]> _freeLists;
+	std::atomic<bool> _hugePages{false};
+	std::atomic<bool> _lock{false};
+
+	std::atomic<uint64_t> _mapped{0};
+	std::atomic<uint64_t> _peakMapped{0};
+	std::atomic<uint64_t> _inUse{0};
+	std::atomic<uint64_t> _peakInUse{0};
+	std::atomic<uint64_t> _rents{0};
+	std::atomic<uint64_t> _threadCacheHits{0};
+	std::atomic<uint64_t> _freeListHits{0};
+	std::atomic<uint64_t> _maps{0};
+	std::atomic<uint64_t> _unmaps{0};
+	std::atomic<uint64_t> _hugePageBlocks{0};
+	std::atomic<uint64_t> _lockFailures{0};
+};
+
+// Standard allocator over the shared pool, for containers holding pipeline buffers.
+template<typename T>
+struct PoolAllocator {
+	using value_type = T;
+
+	PoolAllocator() noexcept = default;
+	template<typename U>
+	PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+	T* allocate(size_t count) {
+		return static_cast<T*>(PageAlignedMemoryPool::Shared().Rent(count * sizeof(T)));
 	}
-	
-
-	void Return(void* buf) {
-		
-		for (size_t i = 0; i < Used.size(); i++) {
-			if (Used[i].P == buf) {
-				//cout << "Returning bytes: " << Used[i].Size << endl;
-				Available.push_back(Used[i]);
-				std::swap(Used[i], Used.back());
-				Used.pop_back();
-				return;
-			}
-		}
+	void deallocate(T* buffer, size_t count) noexcept {
+		PageAlignedMemoryPool::Shared().Return(buffer, count * sizeof(T));
 	}
-};
\ No newline at end of file
+
+	template<typename U>
+	bool operator==(const PoolAllocator<U>&) const noexcept { return true; }
+	template<typename U>
+	bool operator!=(const PoolAllocator<U>&) const noexcept { return false; }
+};
+
+using PooledBytes = std::vector<uint8_t, PoolAllocator<uint8_t>>;
@@ -0,0 +1,165 @@
+#include "Arena.h"
+
+#include <algorithm>
+#include <new>
+
+#include "Allocator.h"
+#include "HailoProcessorStats.h"
+
+// overflow blocks of one frame, reserved so recording them does not allocate.
+#define ARENA_OVERFLOW_BLOCKS 16
+// the alignment of cv::fastMalloc, so SIMD kernels see the same alignment as on heap Mats.
+#define ARENA_MAT_ALIGNMENT 64
+
+namespace {
+
+size_t AlignUp(size_t value, size_t alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+void UpdatePeak(std::atomic<uint64_t>& peak, uint64_t value)
+{
+	uint64_t current = peak.load(std::memory_order_relaxed);
+	while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) ;
+}
+
+}
+
+Arena::Arena(size_t capacity, ArenaStats* stats) : _block{nullptr, 0}, _matAllocator(*this), _stats(stats)
+{
+	_overflow.reserve(ARENA_OVERFLOW_BLOCKS);
+	Allocate(capacity);
+}
+
+Arena::~Arena()
+{
+	Reset();
+	if (_stats)
+		_stats->Capacity.fetch_sub(_block.Size, std::memory_order_relaxed);
+	PageAlignedMemoryPool::Shared().Return(_block.Data, _block.Size);
+}
+
+void Arena::Allocate(size_t capacity)
+{
+	auto& pool = PageAlignedMemoryPool::Shared();
+	if (_block.Data != nullptr) {
+		pool.Return(_block.Data, _block.Size);
+		if (_stats)
+			_stats->Capacity.fetch_sub(_block.Size, std::memory_order_relaxed);
+	}
+	_block.Size = std::max<size_t>(capacity, 4096);
+	_block.Data = static_cast<uint8_t*>(pool.Rent(_block.Size));
+	if (_stats)
+		_stats->Capacity.fetch_add(_block.Size, std::memory_order_relaxed);
+}
+
+void Arena::Reset()
+{
+	const size_t frame = _used + _overflowed;
+	_peak = std::max(_peak, frame);
+	if (!_overflow.empty()) {
+		for (auto& b : _overflow)
+			PageAlignedMemoryPool::Shared().Return(b.Data, b.Size);
+		_overflow.clear();
+		// the next frame of the same size fits; the pool rounds to a power of two anyway.
+		Allocate(frame);
+		if (_stats)
+			_stats->Overflows.fetch_add(1, std::memory_order_relaxed);
+	}
+	if (_stats)
+		UpdatePeak(_stats->Peak, frame);
+	_used = 0;
+	_overflowed = 0;
+}
+
+void* Arena::do_allocate(size_t bytes, size_t alignment)
+{
+	const size_t offset = AlignUp(_used, alignment);
+	if (offset + bytes <= _block.Size) {
+		_used = offset + bytes;
+		return _block.Data + offset;
+	}
+	// the block is page aligned, so is every overflow block.
+	Block b{static_cast<uint8_t*>(PageAlignedMemoryPool::Shared().Rent(bytes)), bytes};
+	_overflow.push_back(b);
+	_overflowed += bytes;
+	return b.Data;
+}
+
+void Arena::do_deallocate(void*, size_t, size_t)
+{
+	// released by Reset.
+}
+
+bool Arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+	return this == &other;
+}
+
+cv::Mat Arena::Mat()
+{
+	cv::Mat mat;
+	mat.allocator = &_matAllocator;
+	return mat;
+}
+
+cv::Mat Arena::Mat(const cv::Size& size, int type)
+{
+	cv::Mat mat = Mat();
+	mat.create(size, type);
+	return mat;
+}
+
+size_t Arena::Used() const
+{
+	return _used + _overflowed;
+}
+
+size_t Arena::Capacity() const
+{
+	return _block.Size;
+}
+
+size_t Arena::Peak() const
+{
+	return _peak;
+}
+
+// As cv::StdMatAllocator, with the header and the pixels bumped from the arena.
+cv::UMatData* Arena::MatAllocator::allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+	cv::AccessFlag, cv::UMatUsageFlags) const
+{
+	size_t total = CV_ELEM_SIZE(type);
+	for (int i = dims - 1; i >= 0; i--) {
+		if (step) {
+			if (data && step[i] != CV_AUTOSTEP) {
+				CV_Assert(total <= step[i]);
+				total = step[i];
+			}
+			else
+				step[i] = total;
+		}
+		total *= sizes[i];
+	}
+	void* header = _arena.allocate(sizeof(cv::UMatData), alignof(cv::UMatData));
+	auto u = new (header) cv::UMatData(this);
+	u->data = u->origdata = data ? static_cast<uchar*>(data) : static_cast<uchar*>(_arena.allocate(total, ARENA_MAT_ALIGNMENT));
+	u->size = total;
+	if (data)
+		u->flags |= cv::UMatData::USER_ALLOCATED;
+	return u;
+}
+
+bool Arena::MatAllocator::allocate(cv::UMatData* data, cv::AccessFlag, cv::UMatUsageFlags) const
+{
+	return data != nullptr;
+}
+
+void Arena::MatAllocator::deallocate(cv::UMatData* data) const
+{
+	if (data == nullptr)
+		return;
+	// the memory stays until Reset.
+	data->~UMatData();
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+#include <opencv2/core.hpp>
+
+struct ArenaStats;
+
+// Bump allocator for the temporaries of one post-processing frame, owned by a single worker.
+// Containers take it as a std::pmr::memory_resource and cv::Mat as an allocator (see Mat);
+// nothing is freed individually, Reset releases everything of the frame at once.
+// A frame that does not fit continues in overflow blocks, and the next Reset grows the block to what the frame needed,
+// so after a few frames the worker runs on a single block. Blocks come from PageAlignedMemoryPool.
+class Arena : public std::pmr::memory_resource {
+public:
+	explicit Arena(size_t capacity, ArenaStats* stats = nullptr);
+	~Arena() override;
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	// Every container and Mat allocated from the arena must be gone or cleared by then.
+	void Reset();
+
+	// An empty Mat; create(), and OpenCV functions writing to it, allocate from the arena.
+	cv::Mat Mat();
+	cv::Mat Mat(const cv::Size& size, int type);
+
+	size_t Used() const;
+	size_t Capacity() const;
+	size_t Peak() const;
+protected:
+	void* do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+private:
+	class MatAllocator : public cv::MatAllocator {
+	public:
+		explicit MatAllocator(Arena& arena) : _arena(arena) {}
+		cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+			cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override;
+		bool allocate(cv::UMatData* data, cv::AccessFlag accessFlags, cv::UMatUsageFlags usageFlags) const override;
+		void deallocate(cv::UMatData* data) const override;
+	private:
+		Arena& _arena;
+	};
+	struct Block {
+		uint8_t* Data;
+		size_t Size;
+	};
+
+	void Allocate(size_t capacity);
+
+	Block _block;
+	size_t _used = 0;
+	// bytes of the current frame in overflow blocks.
+	size_t _overflowed = 0;
+	size_t _peak = 0;
+	std::vector<Block> _overflow;
+	MatAllocator _matAllocator;
+	ArenaStats* _stats;
+};
@@ -1,11 +1,17 @@
 #include "ArrayOperations.h"
 #include <cmath>
 #include <algorithm>
+#include <cstring>
+#if defined(__ARM_NEON)
 #include <arm_neon.h>
+#elif defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
 
 void ArrayOperations::ConvertToUint8(const float* inputBuffer, uint8_t* outputBuffer, size_t featureSize)
 {
     size_t i = 0;
+#if defined(__ARM_NEON)
     float32x4_t factor = vdupq_n_f32(255.0f);   // Load 255.0 into all 4 elements
     float32x4_t zero = vdupq_n_f32(0.0f);
     float32x4_t maxVal = vdupq_n_f32(255.0f);
@@ -21,6 +27,7 @@ void ArrayOperations::ConvertToUint8(const float* inputBuffer, uint8_t* outputBu
 
         vst1_lane_u32((uint32_t*)&outputBuffer[i], vreinterpret_u32_u8(packedVals8), 0);  // Store 4 uint8_t
     }
+#endif
 
     // Process remaining elements
     for (; i < featureSize; ++i) {
@@ -34,6 +41,7 @@ void ArrayOperations::ConvertToUint8(const float* inputBuffer, uint8_t* outputBu
 
     size_t i = 0;
 
+#if defined(__ARM_NEON)
     // Vectorized loop: process 16 elements at a time
     for (; i + vectorSize <= count; i += vectorSize) {
         // Load 16 uint8_t values into a NEON register
@@ -61,6 +69,7 @@ void ArrayOperations::ConvertToUint8(const float* inputBuffer, uint8_t* outputBu
         vst1q_f32(outputBuffer + i + 8, floatValsHighLow);
         vst1q_f32(outputBuffer + i + 12, floatValsHighHigh);
     }
+#endif
 
     // Process remaining elements (less than 16)
     for (; i < count; ++i) {
@@ -104,6 +113,7 @@ bool ArrayOperations::ContainsGreaterThan(const uint8* buffer, size_t size, uint
     const size_t vectorSize = 16;  // 128 bits / 8 bits per uint8_t = 16 elements
     size_t i = 0;
 
+#if defined(__ARM_NEON)
     // Set threshold vector for comparison
     uint8x16_t thresholdVec = vdupq_n_u8(threshold);
 
@@ -120,6 +130,7 @@ bool ArrayOperations::ContainsGreaterThan(const uint8* buffer, size_t size, uint
             return true;
         }
     }
+#endif
 
     // Process remaining elements (less than 16)
     for (; i < size; ++i) {
@@ -137,6 +148,7 @@ void ArrayOperations::NegUint8(uint8* buffer, size_t size)
     const size_t vectorSize = 16;  // 128 bits / 8 bits per uint8_t = 16 elements
     size_t i = 0;
 
+#if defined(__ARM_NEON)
     // Create a vector with all elements set to 255
     uint8x16_t maxVec = vdupq_n_u8(255);
 
@@ -151,6 +163,7 @@ void ArrayOperations::NegUint8(uint8* buffer, size_t size)
         // Store the result back to the buffer
         vst1q_u8(buffer + i, resultVec);
     }
+#endif
 
     // Process remaining elements (less than 16)
     for (; i < size; ++i) {
@@ -159,4 +172,119 @@ void ArrayOperations::NegUint8(uint8* buffer, size_t size)
 
 }
 
+uint8 ArrayOperations::Max(const uint8* buffer, size_t size)
+{
+    size_t i = 0;
+    uint8 result = 0;
+#if defined(__ARM_NEON)
+    if (size >= 16) {
+        uint8x16_t acc = vld1q_u8(buffer);
+        for (i = 16; i + 16 <= size; i += 16)
+            acc = vmaxq_u8(acc, vld1q_u8(buffer + i));
+        result = vmaxvq_u8(acc);
+    }
+#elif defined(__AVX2__) || defined(__SSE4_1__)
+    __m128i acc = _mm_setzero_si128();
+#if defined(__AVX2__)
+    if (size >= 32) {
+        __m256i acc256 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buffer));
+        for (i = 32; i + 32 <= size; i += 32)
+            acc256 = _mm256_max_epu8(acc256, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buffer + i)));
+        acc = _mm_max_epu8(_mm256_castsi256_si128(acc256), _mm256_extracti128_si256(acc256, 1));
+    }
+#endif
+    for (; i + 16 <= size; i += 16)
+        acc = _mm_max_epu8(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + i)));
+    // horizontal max: fold the halves, then min of the complement picks the max of 8 words.
+    acc = _mm_max_epu8(acc, _mm_srli_si128(acc, 8));
+    acc = _mm_max_epu8(acc, _mm_srli_epi16(acc, 8));
+    acc = _mm_minpos_epu16(_mm_xor_si128(_mm_and_si128(acc, _mm_set1_epi16(0xFF)), _mm_set1_epi16(0xFF)));
+    result = static_cast<uint8>(0xFF ^ _mm_extract_epi16(acc, 0));
+#endif
 
+    // Process remaining elements
+    for (; i < size; ++i)
+        result = std::max(result, buffer[i]);
+    return result;
+}
+
+size_t ArrayOperations::ArgMax(const uint8* buffer, size_t size)
+{
+    if (size == 0)
+        return 0;
+    auto found = static_cast<const uint8*>(memchr(buffer, Max(buffer, size), size));
+    return found - buffer;
+}
+
+void ArrayOperations::Gemm(const float* a, const float* b, float* c, size_t m, size_t k, size_t n)
+{
+    Gemm(a, b, c, m, k, n, n, n);
+}
+
+void ArrayOperations::Gemm(const float* a, const float* b, float* c, size_t m, size_t k, size_t n, size_t ldb, size_t ldc)
+{
+    // b is walked in column blocks small enough to stay in L1 while every row of a is applied to them.
+    const size_t block = 128;
+    for (size_t j0 = 0; j0 < n; j0 += block) {
+        const size_t j1 = std::min(n, j0 + block);
+        for (size_t row = 0; row < m; ++row) {
+            const float* ar = a + row * k;
+            float* cr = c + row * ldc;
+            size_t j = j0;
+#if defined(__ARM_NEON)
+            for (; j + 16 <= j1; j += 16) {
+                float32x4_t c0 = vdupq_n_f32(0.0f), c1 = c0, c2 = c0, c3 = c0;
+                for (size_t p = 0; p < k; ++p) {
+                    const float* br = b + p * ldb + j;
+                    float32x4_t av = vdupq_n_f32(ar[p]);
+                    c0 = vfmaq_f32(c0, vld1q_f32(br), av);
+                    c1 = vfmaq_f32(c1, vld1q_f32(br + 4), av);
+                    c2 = vfmaq_f32(c2, vld1q_f32(br + 8), av);
+                    c3 = vfmaq_f32(c3, vld1q_f32(br + 12), av);
+                }
+                vst1q_f32(cr + j, c0);
+                vst1q_f32(cr + j + 4, c1);
+                vst1q_f32(cr + j + 8, c2);
+                vst1q_f32(cr + j + 12, c3);
+            }
+#elif defined(__AVX2__)
+            for (; j + 16 <= j1; j += 16) {
+                __m256 c0 = _mm256_setzero_ps(), c1 = c0;
+                for (size_t p = 0; p < k; ++p) {
+                    const float* br = b + p * ldb + j;
+                    __m256 av = _mm256_set1_ps(ar[p]);
+#if defined(__FMA__)
+                    c0 = _mm256_fmadd_ps(_mm256_loadu_ps(br), av, c0);
+                    c1 = _mm256_fmadd_ps(_mm256_loadu_ps(br + 8), av, c1);
+#else
+                    c0 = _mm256_add_ps(c0, _mm256_mul_ps(_mm256_loadu_ps(br), av));
+                    c1 = _mm256_add_ps(c1, _mm256_mul_ps(_mm256_loadu_ps(br + 8), av));
+#endif
+                }
+                _mm256_storeu_ps(cr + j, c0);
+                _mm256_storeu_ps(cr + j + 8, c1);
+            }
+#elif defined(__SSE4_1__)
+            for (; j + 8 <= j1; j += 8) {
+                __m128 c0 = _mm_setzero_ps(), c1 = c0;
+                for (size_t p = 0; p < k; ++p) {
+                    const float* br = b + p * ldb + j;
+                    __m128 av = _mm_set1_ps(ar[p]);
+                    c0 = _mm_add_ps(c0, _mm_mul_ps(_mm_loadu_ps(br), av));
+                    c1 = _mm_add_ps(c1, _mm_mul_ps(_mm_loadu_ps(br + 4), av));
+                }
+                _mm_storeu_ps(cr + j, c0);
+                _mm_storeu_ps(cr + j + 4, c1);
+            }
+#endif
+            // Process remaining columns, row by row so the compiler can vectorize it
+            std::fill(cr + j, cr + j1, 0.0f);
+            for (size_t p = 0; p < k; ++p) {
+                const float* br = b + p * ldb;
+                const float av = ar[p];
+                for (size_t q = j; q < j1; ++q)
+                    cr[q] += av * br[q];
+            }
+        }
+    }
+}
@@ -1,4 +1,3 @@
-#include <arm_neon.h>
 #include <cstddef>
 
 #include "Frame.h"
@@ -11,5 +10,13 @@ public:
 	static bool ContainsGreaterThan(const float* buffer, size_t size, float threshold);
 	static bool ContainsGreaterThan(const uint8* buffer, size_t size, uint8 threshold);
 	static void NegUint8(uint8* buffer, size_t size);
+	// Largest element, vectorized with NEON, AVX2 or SSE4.1.
+	static uint8 Max(const uint8* buffer, size_t size);
+	// Index of the first largest element.
+	static size_t ArgMax(const uint8* buffer, size_t size);
+	// c (m x n) = a (m x k) * b (k x n), row-major and contiguous. Meant for a few short rows of a against a wide b.
+	static void Gemm(const float* a, const float* b, float* c, size_t m, size_t k, size_t n);
+	// Same, with the row strides of b and c given explicitly, e.g. to multiply by a window of b.
+	static void Gemm(const float* a, const float* b, float* c, size_t m, size_t k, size_t n, size_t ldb, size_t ldc);
 };
 
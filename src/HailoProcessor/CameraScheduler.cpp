@@ -0,0 +1,277 @@
+#include "CameraScheduler.h"
+
+#include <algorithm>
+
+using Clock = std::chrono::steady_clock;
+
+bool CameraScheduler::Camera::Ready() const
+{
+	return !Frames.empty() && Frames.front()->Dispatched < Frames.front()->Writes.size();
+}
+
+CameraScheduler::CameraScheduler(uint32_t maxInFlight) : _maxInFlight(std::max<uint32_t>(maxInFlight, 1))
+{
+}
+
+CameraScheduler::Camera& CameraScheduler::Find(uint32_t cameraId)
+{
+	auto& camera = _cameras[cameraId];
+	if (!camera) {
+		camera = std::make_unique<Camera>();
+		camera->Id = cameraId;
+	}
+	return *camera;
+}
+
+void CameraScheduler::Configure(uint32_t cameraId, const CameraConfig& config)
+{
+	std::lock_guard<std::mutex> lock(_mx);
+	Camera& camera = Find(cameraId);
+	const bool active = camera.Active;
+	if (active)
+		Deactivate(camera);
+	camera.Config = config;
+	camera.Config.Weight = std::max<uint32_t>(config.Weight, 1);
+	camera.Config.QueueDepth = std::max<uint32_t>(config.QueueDepth, 1);
+	camera.Interval = config.MaxFps > 0.0f
+		? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / config.MaxFps))
+		: Clock::duration::zero();
+	camera.Deficit = 0;
+	if (active)
+		Activate(camera);
+}
+
+CameraConfig CameraScheduler::Config(uint32_t cameraId)
+{
+	std::lock_guard<std::mutex> lock(_mx);
+	return Find(cameraId).Config;
+}
+
+bool CameraScheduler::Throttled(uint32_t cameraId)
+{
+	std::lock_guard<std::mutex> lock(_mx);
+	Camera& camera = Find(cameraId);
+	const auto now = Clock::now();
+	if (now < camera.NextAdmission) {
+		camera.Stats.throttled++;
+		return true;
+	}
+	// a frame arriving a little late keeps the schedule; after a pause the schedule restarts instead of allowing a burst.
+	camera.NextAdmission = std::max(camera.NextAdmission + camera.Interval, now + camera.Interval / 2);
+	return false;
+}
+
+CameraScheduler::Ticket CameraScheduler::Admit(uint32_t cameraId, uint32_t count)
+{
+	std::vector<ScheduledWrite> evicted;
+	Ticket frame;
+	{
+		std::lock_guard<std::mutex> lock(_mx);
+		if (_canceled) {
+			frame = std::make_shared<ScheduledFrame>();
+			frame->Count = count;
+			frame->Dropped = true;
+			return frame;
+		}
+		Camera& camera = Find(cameraId);
+		const auto now = Clock::now();
+
+		// frames that already started on the device finish, so only the waiting ones count against the depth.
+		size_t waiting = 0;
+		for (auto& f : camera.Frames)
+			waiting += f->Dispatched == 0 ? 1 : 0;
+		if (waiting >= camera.Config.QueueDepth) {
+			auto oldest = std::find_if(camera.Frames.begin(), camera.Frames.end(), [](const Ticket& f) { return f->Dispatched == 0; });
+			(*oldest)->Dropped = true;
+			evicted.swap((*oldest)->Writes);
+			_pending -= (*oldest)->Count;
+			camera.Frames.erase(oldest);
+			camera.Stats.evicted++;
+		}
+
+		frame = std::make_shared<ScheduledFrame>();
+		frame->Count = count;
+		frame->Admitted = now;
+		frame->Writes.reserve(count);
+		camera.Frames.push_back(frame);
+		camera.Stats.admitted++;
+		_pending += count;
+		if (!camera.Active)
+			Activate(camera);
+	}
+	for (auto& write : evicted)
+		_onDropped(write);
+	return frame;
+}
+
+bool CameraScheduler::Enqueue(const Ticket& frame, const ScheduledWrite& write)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mx);
+		if (frame->Dropped)
+			return false;
+		frame->Writes.push_back(write);
+	}
+	_changed.notify_one();
+	return true;
+}
+
+void CameraScheduler::Activate(Camera& camera)
+{
+	camera.Active = true;
+	_lanes[static_cast<int>(camera.Config.Priority)].push_back(&camera);
+}
+
+void CameraScheduler::Deactivate(Camera& camera)
+{
+	auto& lane = _lanes[static_cast<int>(camera.Config.Priority)];
+	lane.erase(std::find(lane.begin(), lane.end(), &camera));
+	camera.Active = false;
+	camera.Deficit = 0;
+}
+
+// Deficit round robin with unit cost: the camera at the head of its lane gets Weight writes per turn,
+// then goes to the back. A camera whose next frame is still being preprocessed lets the others go first.
+bool CameraScheduler::Pick(ScheduledWrite& write)
+{
+	for (auto& lane : _lanes) {
+		for (size_t n = lane.size(); n > 0; n--) {
+			Camera* camera = lane.front();
+			if (!camera->Ready()) {
+				lane.pop_front();
+				lane.push_back(camera);
+				continue;
+			}
+			if (camera->Deficit == 0)
+				camera->Deficit = camera->Config.Weight;
+			camera->Deficit--;
+
+			auto& frame = camera->Frames.front();
+			if (frame->Dispatched == 0) {
+				camera->Stats.dispatched++;
+				camera->Stats.totalQueueTime += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - frame->Admitted).count();
+			}
+			write = frame->Writes[frame->Dispatched++];
+			_pending--;
+			if (frame->Dispatched == frame->Count)
+				camera->Frames.pop_front();
+
+			if (camera->Frames.empty())
+				Deactivate(*camera);
+			else if (camera->Deficit == 0) {
+				lane.pop_front();
+				lane.push_back(camera);
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+bool CameraScheduler::Next(ScheduledWrite& write, std::chrono::milliseconds timeout)
+{
+	const auto deadline = Clock::now() + timeout;
+	std::unique_lock<std::mutex> lock(_mx);
+	while (!_canceled) {
+		if (_inFlight < _maxInFlight && Pick(write)) {
+			_inFlight++;
+			return true;
+		}
+		if (_changed.wait_until(lock, deadline) == std::cv_status::timeout && Clock::now() >= deadline)
+			break;
+	}
+	return false;
+}
+
+void CameraScheduler::Release()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mx);
+		if (_inFlight > 0)
+			_inFlight--;
+	}
+	_changed.notify_one();
+}
+
+void CameraScheduler::FrameCompleted(uint32_t cameraId, std::chrono::nanoseconds latency)
+{
+	std::lock_guard<std::mutex> lock(_mx);
+	auto& stats = Find(cameraId).Stats;
+	stats.processed++;
+	stats.totalProcessingTime += latency.count();
+	stats.maxProcessingTime = std::max<int64_t>(stats.maxProcessingTime, latency.count());
+}
+
+void CameraScheduler::FrameDropped(uint32_t cameraId)
+{
+	std::lock_guard<std::mutex> lock(_mx);
+	Find(cameraId).Stats.dropped++;
+}
+
+void CameraScheduler::Cancel()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mx);
+		_canceled = true;
+	}
+	_changed.notify_all();
+}
+
+void CameraScheduler::Drain()
+{
+	std::vector<ScheduledWrite> drained;
+	{
+		std::lock_guard<std::mutex> lock(_mx);
+		for (auto& [id, camera] : _cameras) {
+			for (auto& frame : camera->Frames) {
+				frame->Dropped = true;
+				// the dispatched ones are on the device, their buffers were returned after the write.
+				drained.insert(drained.end(), frame->Writes.begin() + frame->Dispatched, frame->Writes.end());
+				frame->Writes.clear();
+			}
+			camera->Frames.clear();
+			if (camera->Active)
+				Deactivate(*camera);
+		}
+		_pending = 0;
+	}
+	for (auto& write : drained)
+		_onDropped(write);
+}
+
+size_t CameraScheduler::CameraCount()
+{
+	std::lock_guard<std::mutex> lock(_mx);
+	return _cameras.size();
+}
+
+size_t CameraScheduler::Pending()
+{
+	std::lock_guard<std::mutex> lock(_mx);
+	return _pending;
+}
+
+size_t CameraScheduler::Stats(CameraStatsDto* dst, size_t capacity)
+{
+	std::lock_guard<std::mutex> lock(_mx);
+	size_t i = 0;
+	for (auto& [id, camera] : _cameras) {
+		if (i >= capacity)
+			break;
+		CameraStatsDto& stats = dst[i++];
+		stats = camera->Stats;
+		stats.cameraId = id;
+		stats.priority = static_cast<int>(camera->Config.Priority);
+		stats.weight = camera->Config.Weight;
+		stats.maxFps = camera->Config.MaxFps;
+		stats.queued = 0;
+		for (auto& f : camera->Frames)
+			stats.queued += f->Dispatched == 0 ? 1 : 0;
+	}
+	return _cameras.size();
+}
+
+boost::signals2::connection CameraScheduler::connectDropped(std::function<void(const ScheduledWrite&)> slot)
+{
+	return _onDropped.connect(slot);
+}
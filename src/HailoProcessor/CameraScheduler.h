@@ -0,0 +1,119 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <boost/signals2.hpp>
+
+#include "HailoProcessorStatsDto.h"
+
+struct FrameContext;
+
+enum class CameraPriority {
+	// Served before any other class; may starve lower classes when it saturates the device.
+	High,
+	Normal,
+	Low
+};
+
+struct CameraConfig {
+	// Frames per second admitted from the camera, 0 for no cap. Frames over the cap are never preprocessed.
+	float MaxFps = 0.0f;
+	CameraPriority Priority = CameraPriority::Normal;
+	// Device writes per round relative to the other cameras of the same class.
+	uint32_t Weight = 1;
+	// Frames waiting per camera; when full, the camera's oldest frame that has not reached the device is dropped.
+	uint32_t QueueDepth = 2;
+};
+
+// One preprocessed input (a frame or a tile of one) waiting for the device.
+struct ScheduledWrite {
+	FrameContext* Frame = nullptr;
+	void* Buffer = nullptr;
+};
+
+// A frame admitted to a camera queue; its writes are queued one by one as they are preprocessed.
+struct ScheduledFrame {
+	uint32_t Count;
+	uint32_t Dispatched = 0;
+	bool Dropped = false;
+	std::chrono::steady_clock::time_point Admitted;
+	std::vector<ScheduledWrite> Writes;
+};
+
+// Sits in front of the device: one queue per CameraId, so a fast camera only ever drops its own frames.
+// The next write comes from the highest priority class with a ready camera; within a class cameras take turns
+// by deficit round robin, each turn worth Weight writes. At most maxInFlight writes are on the device at once.
+class CameraScheduler {
+public:
+	using Ticket = std::shared_ptr<ScheduledFrame>;
+	using CameraStatsDto = HailoProcessorStatsDto::CameraStatsDto;
+
+	explicit CameraScheduler(uint32_t maxInFlight = 2);
+
+	void Configure(uint32_t cameraId, const CameraConfig& config);
+	CameraConfig Config(uint32_t cameraId);
+
+	// True when a frame offered now is over the camera's fps cap; otherwise the frame takes the camera's next slot.
+	bool Throttled(uint32_t cameraId);
+	// Admits a frame of count writes.
+	Ticket Admit(uint32_t cameraId, uint32_t count);
+	// Queues the next write of an admitted frame; false when the frame was dropped meanwhile, the write is then the caller's.
+	bool Enqueue(const Ticket& frame, const ScheduledWrite& write);
+	// Waits for the next write and a free device slot. False on timeout or Cancel.
+	bool Next(ScheduledWrite& write, std::chrono::milliseconds timeout);
+	// A dispatched write left the device, its slot is free again.
+	void Release();
+
+	// End-to-end outcome of a frame, recorded in the camera's counters.
+	void FrameCompleted(uint32_t cameraId, std::chrono::nanoseconds latency);
+	void FrameDropped(uint32_t cameraId);
+
+	void Cancel();
+	// Drops every queued write through connectDropped, as an eviction would. For shutting down, after Cancel and once
+	// nothing calls Next anymore; frames admitted after Cancel are never queued, their writes are refused by Enqueue.
+	void Drain();
+	size_t CameraCount();
+	// Writes waiting in the camera queues, including those of frames still being preprocessed.
+	size_t Pending();
+	// Fills up to capacity entries, returns the number of cameras.
+	size_t Stats(CameraStatsDto* dst, size_t capacity);
+
+	// Writes dropped from a queue, reported outside the scheduler's lock.
+	boost::signals2::connection connectDropped(std::function<void(const ScheduledWrite&)> slot);
+private:
+	struct Camera {
+		uint32_t Id;
+		CameraConfig Config;
+		std::deque<Ticket> Frames;
+		bool Active = false;
+		uint32_t Deficit = 0;
+		std::chrono::steady_clock::duration Interval{0};
+		std::chrono::steady_clock::time_point NextAdmission;
+		CameraStatsDto Stats{};
+
+		bool Ready() const;
+	};
+	static constexpr int PriorityCount = 3;
+
+	Camera& Find(uint32_t cameraId);
+	void Activate(Camera& camera);
+	void Deactivate(Camera& camera);
+	bool Pick(ScheduledWrite& write);
+
+	const uint32_t _maxInFlight;
+	uint32_t _inFlight = 0;
+	size_t _pending = 0;
+	bool _canceled = false;
+	std::mutex _mx;
+	std::condition_variable _changed;
+	std::unordered_map<uint32_t, std::unique_ptr<Camera>> _cameras;
+	// Cameras with queued frames, one round robin list per priority class.
+	std::deque<Camera*> _lanes[PriorityCount];
+	boost::signals2::signal<void(const ScheduledWrite&)> _onDropped;
+};
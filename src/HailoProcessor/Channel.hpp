@@ -1,16 +1,35 @@
-#include <boost/lockfree/queue.hpp>
+#pragma once
+
 #include <iostream>
 #include <thread>
 #include <boost/signals2.hpp>
+#include <algorithm>
 #include <atomic>
-#include <semaphore>
+#include <chrono>
+#include <climits>
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <ctime>
+#endif
 
 enum class DiscardPolicy {
     Oldest,
     Newest
 };
 
+// Who may call TryWrite / Read concurrently. Spsc is cheaper, but a single producer cannot discard the oldest item.
+enum class ChannelMode {
+    Spsc,
+    Mpmc
+};
+
 class OperationCanceledException : public std::runtime_error {
 public:
     // Constructor with message
@@ -37,80 +56,234 @@ public:
     OperationCanceledException& operator=(OperationCanceledException&&) noexcept = default;
 };
 
+namespace channel_detail {
+
+constexpr size_t CacheLine = 64;
+
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield");
+#endif
+}
+
+inline size_t RoundUpToPowerOfTwo(size_t value) {
+    size_t size = 1;
+    while (size < value)
+        size <<= 1;
+    return size;
+}
+
+// Sleeps while word == expected, at most timeout. Spurious wake-ups are fine, callers re-check.
+inline void FutexWait(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::nanoseconds timeout) {
+#if defined(__linux__)
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+    timespec ts;
+    ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000000);
+    ts.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, &ts, nullptr, 0);
+#else
+    if (word.load(std::memory_order_acquire) == expected)
+        std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(timeout, std::chrono::microseconds(100)));
+#endif
+}
+
+inline void FutexWake(std::atomic<uint32_t>& word, int count) {
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+#endif
+}
+
+// Bounded multi-producer multi-consumer ring (Vyukov): every cell carries a sequence number,
+// so producers and consumers only contend on their own index.
+// At least two cells: with one, a free cell and a full one carry the same sequence, so a producer could overwrite
+// a value still being read. _capacity stays the limit.
+template<typename T>
+class MpmcRing {
+public:
+    explicit MpmcRing(size_t capacity)
+        : _capacity(capacity), _mask(RoundUpToPowerOfTwo(std::max<size_t>(capacity, 2)) - 1), _cells(new Cell[_mask + 1]) {
+        for (size_t i = 0; i <= _mask; i++)
+            _cells[i].Sequence.store(i, std::memory_order_relaxed);
+    }
+
+    bool TryPush(const T& value) {
+        size_t pos = _tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = _cells[pos & _mask];
+            intptr_t dif = static_cast<intptr_t>(cell.Sequence.load(std::memory_order_acquire)) - static_cast<intptr_t>(pos);
+            if (dif == 0) {
+                // the ring is a power of two, the channel holds at most _capacity. A stale pos only fails the CAS below.
+                if (static_cast<intptr_t>(pos - _head.load(std::memory_order_acquire)) >= static_cast<intptr_t>(_capacity))
+                    return false;
+                if (_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.Value = value;
+                    cell.Sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (dif < 0)
+                return false;
+            else
+                pos = _tail.load(std::memory_order_relaxed);
+        }
+    }
+
+    bool TryPop(T& value) {
+        size_t pos = _head.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = _cells[pos & _mask];
+            intptr_t dif = static_cast<intptr_t>(cell.Sequence.load(std::memory_order_acquire)) - static_cast<intptr_t>(pos + 1);
+            if (dif == 0) {
+                if (_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = cell.Value;
+                    cell.Sequence.store(pos + _mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (dif < 0)
+                return false;
+            else
+                pos = _head.load(std::memory_order_relaxed);
+        }
+    }
+
+    size_t Size() const {
+        size_t head = _head.load(std::memory_order_relaxed);
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> Sequence;
+        T Value;
+    };
+    const size_t _capacity;
+    const size_t _mask;
+    std::unique_ptr<Cell[]> _cells;
+    alignas(CacheLine) std::atomic<size_t> _tail{0};
+    alignas(CacheLine) std::atomic<size_t> _head{0};
+};
+
+// Bounded single-producer single-consumer ring. Each side caches the other's index
+// and only reloads it when the cached value says full / empty.
 template<typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity)
+        : _capacity(capacity), _mask(RoundUpToPowerOfTwo(capacity) - 1), _values(new T[_mask + 1]) {}
+
+    bool TryPush(const T& value) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _cachedHead >= _capacity) {
+            _cachedHead = _head.load(std::memory_order_acquire);
+            if (tail - _cachedHead >= _capacity)
+                return false;
+        }
+        _values[tail & _mask] = value;
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPop(T& value) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _cachedTail) {
+            _cachedTail = _tail.load(std::memory_order_acquire);
+            if (head == _cachedTail)
+                return false;
+        }
+        value = _values[head & _mask];
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t Size() const {
+        size_t head = _head.load(std::memory_order_relaxed);
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+private:
+    const size_t _capacity;
+    const size_t _mask;
+    std::unique_ptr<T[]> _values;
+    alignas(CacheLine) std::atomic<size_t> _tail{0};
+    size_t _cachedHead = 0;
+    alignas(CacheLine) std::atomic<size_t> _head{0};
+    size_t _cachedTail = 0;
+};
+
+}
+
+// Bounded channel on a power-of-two ring; readers spin briefly, then sleep on a futex until a write or Cancel.
+// Oldest discards the oldest queued item to make room, Newest rejects the item being written;
+// either way every discarded item is reported through connectDropped exactly once.
+template<typename T, ChannelMode Mode = ChannelMode::Mpmc>
 class Channel {
 public:
     using DiscardSignal = boost::signals2::signal<void(const T&)>;
 
     Channel(size_t capacity, DiscardPolicy policy)
-         : _capacity(capacity), _policy(policy), _queue(capacity), _sem(0), _count(0) {}
+         : _capacity(capacity), _policy(policy), _ring(capacity) {
+        if (capacity == 0)
+            throw std::invalid_argument("Channel capacity must be positive.");
+        if (Mode == ChannelMode::Spsc && policy == DiscardPolicy::Oldest)
+            throw std::invalid_argument("A single producer cannot discard the oldest item, use ChannelMode::Mpmc.");
+    }
 
     int Pending() const {
-        return _count.load(std::memory_order_relaxed);
+        return static_cast<int>(_ring.Size());
+    }
+
+    size_t Capacity() const {
+        return _capacity;
     }
 
     // Non-blocking write, returns true if the write was successful
     bool TryWrite(const T& value) {
-        if (_queue.bounded_push(value)) {
-            AddCount();
-            _sem.release();  // Signal a waiting consumer
-            return true;  // Successfully pushed
-        }
+        bool written = Push(value);
+        if (written)
+            Notify(1);
+        return written;
+    }
 
-        // Handle overflow based on policy
-        if (_policy == DiscardPolicy::Oldest) {
-            T discarded;
-            if (_queue.pop(discarded)) {
-                SubCount();
-                if (_queue.bounded_push(value)) {
-                    AddCount();
-                    _sem.release();
-                    _onDiscard(discarded);
-                    return true;
-                }
-            }
-        }
-        else if (_policy == DiscardPolicy::Newest) {
-            _onDiscard(value);
-        }
-        return false;
+    // Writes count values with a single wake-up, returns how many were accepted.
+    size_t TryWriteBatch(const T* values, size_t count) {
+        size_t written = 0;
+        for (size_t i = 0; i < count; i++)
+            written += Push(values[i]) ? 1 : 0;
+        if (written > 0)
+            Notify(static_cast<int>(written));
+        return written;
     }
 
     // Blocking read, waits until an item is available
     T Read() {
-
-        AddReads();
-        if(IsCanceled())
-            throw OperationCanceledException();
-        _sem.acquire();  // Wait until an item is available
-        if(IsCanceled())
-            throw OperationCanceledException();
         T value;
-        while (!_queue.pop(value)) ;
-        SubCount();
-        SubReads();
+        while (!TryRead(value, std::chrono::hours(1))) ;
         return value;
     }
 
     template<typename _Rep, typename _Period>
     bool TryRead(T &value, const std::chrono::duration<_Rep, _Period>& __rtime) {
+        if (IsCanceled())
+            throw OperationCanceledException();
+        if (_ring.TryPop(value))
+            return true;
+        return Wait(value, std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(__rtime));
+    }
 
-        AddReads();
-        if(IsCanceled()) throw OperationCanceledException();
-        if(_sem.try_acquire_for(__rtime)) {
-            if(IsCanceled())
-                throw OperationCanceledException();
-
-            if(_queue.pop(value)) {
-                SubCount();
-                SubReads();
-                return true;
-            }
-            // If we couldn't pop but acquired the semaphore, release it back
-            _sem.release();
-        }
-        SubReads();
-        return false;
+    // Waits like TryRead for the first item, then takes whatever else is queued, up to maxCount. Returns the number read.
+    template<typename _Rep, typename _Period>
+    size_t ReadBatch(T* values, size_t maxCount, const std::chrono::duration<_Rep, _Period>& __rtime) {
+        if (maxCount == 0 || !TryRead(values[0], __rtime))
+            return 0;
+        size_t count = 1;
+        while (count < maxCount && _ring.TryPop(values[count]))
+            count++;
+        return count;
     }
 
     // Method to connect to the discard signal
@@ -119,29 +292,85 @@ public:
     }
     bool Cancel() {
         if (!_cancelled.exchange(true, std::memory_order_release)) {
-            // the number of pending reads is in pending.
-            auto m = _pendingReads.load(std::memory_order_relaxed);
-            for(int i =0 ; i < m; i++)
-                _sem.release();
+            _signal.fetch_add(1, std::memory_order_seq_cst);
+            channel_detail::FutexWake(_signal, INT_MAX);
             return true;
         }
         return false;
     }
     inline bool IsCanceled() { return _cancelled.load(std::memory_order_acquire ); }
 private:
-    size_t _capacity;
+    // Before sleeping a reader spins, then yields; a busy pipeline usually hands the next item over within that window.
+    // Spinning is pointless on a single core, where the writer cannot run meanwhile.
+    static constexpr int YieldCount = 8;
+    static int SpinCount() {
+        static const int count = std::thread::hardware_concurrency() > 1 ? 64 : 0;
+        return count;
+    }
+    using Ring = std::conditional_t<Mode == ChannelMode::Spsc, channel_detail::SpscRing<T>, channel_detail::MpmcRing<T>>;
+
+    const size_t _capacity;
     DiscardSignal _onDiscard;
-    DiscardPolicy _policy;
-    boost::lockfree::queue<T> _queue;  // Lock-free concurrent bounded queue
-    std::counting_semaphore<> _sem;
-    std::atomic<int> _count;
-    std::atomic<int> _pendingReads;
-    std::atomic<bool> _cancelled;
-     // Signal for when an item is discarded
-    inline void AddCount() { _count.fetch_add(1, std::memory_order_relaxed); }
-    inline void SubCount() { _count.fetch_sub(1, std::memory_order_relaxed); }
-
-    inline void AddReads() { _pendingReads.fetch_add(1, std::memory_order_relaxed); }
-    inline void SubReads() { _pendingReads.fetch_sub(1, std::memory_order_relaxed); }
-
-};
\ No newline at end of file
+    const DiscardPolicy _policy;
+    Ring _ring;
+    std::atomic<bool> _cancelled{false};
+    // bumped on every write; readers sleep on it.
+    alignas(channel_detail::CacheLine) std::atomic<uint32_t> _signal{0};
+    // readers about to sleep or asleep; writers only enter the kernel when there are any.
+    alignas(channel_detail::CacheLine) std::atomic<int> _waiters{0};
+
+    bool Push(const T& value) {
+        if (_ring.TryPush(value))
+            return true;
+        if (_policy == DiscardPolicy::Newest) {
+            _onDiscard(value);
+            return false;
+        }
+        // Oldest: whatever this thread pops is discarded; if readers emptied the ring meanwhile, the push just succeeds.
+        T discarded;
+        while (!_ring.TryPush(value)) {
+            if (_ring.TryPop(discarded))
+                _onDiscard(discarded);
+        }
+        return true;
+    }
+
+    void Notify(int count) {
+        _signal.fetch_add(1, std::memory_order_seq_cst);
+        if (_waiters.load(std::memory_order_seq_cst) > 0)
+            channel_detail::FutexWake(_signal, count);
+    }
+
+    bool Wait(T& value, std::chrono::steady_clock::time_point deadline) {
+        for (int i = 0, spins = SpinCount(); i < spins; i++) {
+            channel_detail::CpuRelax();
+            if (_ring.TryPop(value))
+                return true;
+        }
+        for (int i = 0; i < YieldCount; i++) {
+            std::this_thread::yield();
+            if (_ring.TryPop(value))
+                return true;
+        }
+        for (;;) {
+            uint32_t signal = _signal.load(std::memory_order_acquire);
+            _waiters.fetch_add(1, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool popped = _ring.TryPop(value);
+            if (!popped && !IsCanceled()) {
+                auto remaining = deadline - std::chrono::steady_clock::now();
+                if (remaining > std::chrono::steady_clock::duration::zero())
+                    channel_detail::FutexWait(_signal, signal, std::chrono::duration_cast<std::chrono::nanoseconds>(remaining));
+            }
+            _waiters.fetch_sub(1, std::memory_order_seq_cst);
+            if (popped)
+                return true;
+            if (IsCanceled())
+                throw OperationCanceledException();
+            if (_ring.TryPop(value))
+                return true;
+            if (std::chrono::steady_clock::now() >= deadline)
+                return false;
+        }
+    }
+};
@@ -0,0 +1,210 @@
+#include "DecodePlan.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <map>
+#include "ArrayOperations.h"
+#include "HailoException.h"
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+// Distribution focal loss: every side of the box is the expectation of a softmax over 'bins' bins.
+// The four sides are reduced together, one lane each.
+static inline void ExpectedDistances(const uint8_t *box, const float *exp, int bins, float stride, float distance[4])
+{
+	const uint8_t *l = box, *t = box + bins, *r = box + 2 * bins, *b = box + 3 * bins;
+#if defined(__ARM_NEON)
+	float32x4_t sum = vdupq_n_f32(0.0f), weighted = vdupq_n_f32(0.0f);
+	for (int k = 0; k < bins; k++) {
+		float lanes[4] = { exp[l[k]], exp[t[k]], exp[r[k]], exp[b[k]] };
+		float32x4_t e = vld1q_f32(lanes);
+		sum = vaddq_f32(sum, e);
+		weighted = vmlaq_n_f32(weighted, e, static_cast<float>(k));
+	}
+	vst1q_f32(distance, vmulq_n_f32(vdivq_f32(weighted, sum), stride));
+#elif defined(__AVX2__) || defined(__SSE4_1__)
+	__m128 sum = _mm_setzero_ps(), weighted = _mm_setzero_ps();
+	for (int k = 0; k < bins; k++) {
+		__m128 e = _mm_setr_ps(exp[l[k]], exp[t[k]], exp[r[k]], exp[b[k]]);
+		sum = _mm_add_ps(sum, e);
+		weighted = _mm_add_ps(weighted, _mm_mul_ps(e, _mm_set1_ps(static_cast<float>(k))));
+	}
+	_mm_storeu_ps(distance, _mm_mul_ps(_mm_div_ps(weighted, sum), _mm_set1_ps(stride)));
+#else
+	float sum[4] = {}, weighted[4] = {};
+	for (int k = 0; k < bins; k++) {
+		float e[4] = { exp[l[k]], exp[t[k]], exp[r[k]], exp[b[k]] };
+		for (int side = 0; side < 4; side++) {
+			sum[side] += e[side];
+			weighted[side] += e[side] * k;
+		}
+	}
+	for (int side = 0; side < 4; side++)
+		distance[side] = weighted[side] / sum[side] * stride;
+#endif
+}
+
+DecodePlan::DecodePlan(const InferenceBackend &backend, int classes, int regressionLength)
+	: _classes(classes), _bins(regressionLength + 1)
+{
+	auto &input = backend.InputInfo().shape;
+	_inputWidth = static_cast<int>(input.width);
+	_inputHeight = static_cast<int>(input.height);
+
+	// grid width -> outputs with that grid, finest stride first.
+	std::map<uint32_t, std::vector<size_t>, std::greater<uint32_t>> grids;
+	for (size_t i = 0; i < backend.OutputCount(); i++)
+		grids[backend.OutputInfo(i).shape.width].push_back(i);
+
+	bool hasProto = false;
+	for (auto &[width, outputs] : grids) {
+		if (outputs.size() == 1 && !hasProto) {
+			auto &info = backend.OutputInfo(outputs[0]);
+			_proto = outputs[0];
+			_protoWidth = static_cast<int>(info.shape.width);
+			_protoHeight = static_cast<int>(info.shape.height);
+			_protoScale = info.quant_info.qp_scale;
+			_protoZp = info.quant_info.qp_zp;
+			hasProto = true;
+			continue;
+		}
+		if (outputs.size() != 3)
+			throw HailoException("Unexpected model outputs, YOLOv8-seg heads are expected.");
+
+		DecodeLevel level{};
+		int found = 0;
+		for (auto i : outputs) {
+			auto &info = backend.OutputInfo(i);
+			int features = static_cast<int>(info.shape.features);
+			if (features == 4 * _bins) {
+				level.Boxes = i;
+				level.BoxScale = info.quant_info.qp_scale;
+				level.BoxZp = info.quant_info.qp_zp;
+				for (int q = 0; q < 256; q++)
+					level.BoxExp[q] = std::exp((q - level.BoxZp) * level.BoxScale);
+				found |= 1;
+			}
+			else if (features == classes) {
+				level.Scores = i;
+				level.ScoreScale = info.quant_info.qp_scale;
+				level.ScoreZp = info.quant_info.qp_zp;
+				found |= 2;
+			}
+			else {
+				level.Masks = i;
+				level.MaskScale = info.quant_info.qp_scale;
+				level.MaskZp = info.quant_info.qp_zp;
+				_coefficients = features;
+				found |= 4;
+			}
+		}
+		if (found != 7)
+			throw HailoException("Unexpected model outputs, YOLOv8-seg heads are expected.");
+
+		auto &shape = backend.OutputInfo(level.Scores).shape;
+		level.Width = static_cast<int>(shape.width);
+		level.Height = static_cast<int>(shape.height);
+		level.Stride = _inputWidth / level.Width;
+		level.Centers.resize(static_cast<size_t>(level.Width) * level.Height * 2);
+		for (int y = 0, c = 0; y < level.Height; y++) {
+			for (int x = 0; x < level.Width; x++, c += 2) {
+				level.Centers[c] = (x + 0.5f) * level.Stride;
+				level.Centers[c + 1] = (y + 0.5f) * level.Stride;
+			}
+		}
+		_levels.push_back(std::move(level));
+	}
+	if (!hasProto || _levels.empty())
+		throw HailoException("Unexpected model outputs, YOLOv8-seg heads are expected.");
+	_cutoffs = std::vector<std::atomic<uint64_t>>(_levels.size());
+	for (auto &cutoff : _cutoffs)
+		cutoff.store(NoCutoff, std::memory_order_relaxed);
+}
+
+int DecodePlan::QuantizedThreshold(float threshold, float scale, float zp)
+{
+	// the smallest byte that dequantizes to at least threshold, 256 when none does.
+	if (!(scale > 0.0f))
+		return threshold <= 0.0f ? 0 : 256;
+	const float q = std::clamp(std::ceil(threshold / scale + zp), 0.0f, 256.0f);
+	int result = static_cast<int>(q);
+	// the division rounds, so the ceiling may be one off; the comparison is the one Decode's dequantization makes.
+	if (result <= 255 && (result - zp) * scale < threshold)
+		result++;
+	else if (result > 0 && (result - 1 - zp) * scale >= threshold)
+		result--;
+	return result;
+}
+
+int DecodePlan::Cutoff(int level, float threshold) const
+{
+	// the threshold's bits and its quantized value in one word, so threads decoding at once never see a torn pair.
+	const uint32_t bits = std::bit_cast<uint32_t>(threshold);
+	auto &cutoff = _cutoffs[level];
+	const uint64_t cached = cutoff.load(std::memory_order_relaxed);
+	if (cached != NoCutoff && static_cast<uint32_t>(cached >> 32) == bits)
+		return static_cast<int>(static_cast<uint32_t>(cached));
+	const int quantized = QuantizedThreshold(threshold, _levels[level].ScoreScale, _levels[level].ScoreZp);
+	cutoff.store(static_cast<uint64_t>(bits) << 32 | static_cast<uint32_t>(quantized), std::memory_order_relaxed);
+	return quantized;
+}
+
+void DecodePlan::Decode(const std::vector<const uint8_t *> &outputs, float threshold, std::vector<Proposal> &proposals) const
+{
+	const float invWidth = 1.0f / _inputWidth;
+	const float invHeight = 1.0f / _inputHeight;
+	float distance[4];
+
+	for (int l = 0; l < static_cast<int>(_levels.size()); l++) {
+		auto &level = _levels[l];
+		const uint8_t *scores = outputs[level.Scores];
+		const uint8_t *boxes = outputs[level.Boxes];
+		const int cells = level.Width * level.Height;
+
+		// the threshold in the quantized domain, so almost every cell is rejected on raw bytes.
+		int quantized = Cutoff(l, threshold);
+		if (quantized > 255)
+			continue;
+
+		for (int j = 0; j < cells; j++) {
+			const uint8_t *s = scores + static_cast<size_t>(j) * _classes;
+			uint8_t best = ArrayOperations::Max(s, _classes);
+			if (best < quantized)
+				continue;
+			// dequantization is monotonic, the first quantized max is the first float max.
+			int classId = static_cast<int>(ArrayOperations::ArgMax(s, _classes));
+			float confidence = (best - level.ScoreZp) * level.ScoreScale;
+
+			ExpectedDistances(boxes + static_cast<size_t>(j) * 4 * _bins, level.BoxExp.data(), _bins, static_cast<float>(level.Stride), distance);
+
+			float cx = level.Centers[2 * j];
+			float cy = level.Centers[2 * j + 1];
+			float x1 = cx - distance[0], y1 = cy - distance[1];
+			float x2 = cx + distance[2], y2 = cy + distance[3];
+			proposals.push_back(Proposal{ x1 * invWidth, y1 * invHeight, (x2 - x1) * invWidth, (y2 - y1) * invHeight,
+				confidence, classId, l, j });
+		}
+	}
+}
+
+void DecodePlan::Coefficients(const std::vector<const uint8_t *> &outputs, const Proposal &proposal, float *dst) const
+{
+	auto &level = _levels[proposal.Level];
+	const uint8_t *src = outputs[level.Masks] + static_cast<size_t>(proposal.Cell) * _coefficients;
+	for (int k = 0; k < _coefficients; k++)
+		dst[k] = (src[k] - level.MaskZp) * level.MaskScale;
+}
+
+void DecodePlan::Prototype(const std::vector<const uint8_t *> &outputs, float *dst) const
+{
+	const uint8_t *src = outputs[_proto];
+	const size_t pixels = static_cast<size_t>(_protoWidth) * _protoHeight;
+	for (size_t i = 0; i < pixels; i++, src += _coefficients) {
+		for (int k = 0; k < _coefficients; k++)
+			dst[k * pixels + i] = (src[k] - _protoZp) * _protoScale;
+	}
+}
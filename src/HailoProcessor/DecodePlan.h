@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "InferenceBackend.h"
+
+// A cell of the output grid whose best class passed the score threshold.
+struct Proposal {
+	// box normalized to the model input.
+	float XMin, YMin, Width, Height;
+	float Confidence;
+	int ClassId;
+	// where the mask coefficients of this cell are.
+	int Level;
+	int Cell;
+};
+
+// One detection head: the box, score and mask coefficient outputs of one stride.
+struct DecodeLevel {
+	size_t Boxes, Scores, Masks;
+	int Width, Height, Stride;
+	// (x, y) of every cell center in model input pixels.
+	std::vector<float> Centers;
+	float BoxScale, BoxZp;
+	// exp of every dequantized box value, the softmax over the regression bins is a table lookup.
+	std::array<float, 256> BoxExp;
+	float ScoreScale, ScoreZp;
+	float MaskScale, MaskZp;
+};
+
+// Layout of the YOLOv8-seg outputs, worked out once from the stream infos when the model is loaded.
+// Outputs are matched by shape rather than by order: per grid size one tensor has 4 * (regressionLength + 1)
+// features (boxes), one has 'classes' features (scores) and one the mask coefficients;
+// the remaining output is the mask prototype.
+class DecodePlan {
+public:
+	DecodePlan() = default;
+	DecodePlan(const InferenceBackend& backend, int classes, int regressionLength);
+
+	// Appends a proposal for every cell whose best class score reaches threshold.
+	// outputs holds the frame buffer of every output, indexed as in the backend.
+	void Decode(const std::vector<const uint8_t*>& outputs, float threshold, std::vector<Proposal>& proposals) const;
+	// Smallest quantized value whose dequantized value reaches threshold, 256 when there is none.
+	static int QuantizedThreshold(float threshold, float scale, float zp);
+	// Dequantizes the MaskCoefficients() mask coefficients of a proposal.
+	void Coefficients(const std::vector<const uint8_t*>& outputs, const Proposal& proposal, float* dst) const;
+	// Dequantizes the prototype into a coefficients x (height * width) matrix, channels first,
+	// so all masks of a frame are one matrix product.
+	void Prototype(const std::vector<const uint8_t*>& outputs, float* dst) const;
+
+	const std::vector<DecodeLevel>& Levels() const { return _levels; }
+	int Classes() const { return _classes; }
+	int MaskCoefficients() const { return _coefficients; }
+	int ProtoWidth() const { return _protoWidth; }
+	int ProtoHeight() const { return _protoHeight; }
+	int InputWidth() const { return _inputWidth; }
+	int InputHeight() const { return _inputHeight; }
+
+private:
+	// QuantizedThreshold of the level's scores, recomputed only when the threshold changes.
+	int Cutoff(int level, float threshold) const;
+
+	static constexpr uint64_t NoCutoff = UINT64_MAX;
+
+	std::vector<DecodeLevel> _levels;
+	// per level, the last threshold's bits << 32 | its QuantizedThreshold.
+	mutable std::vector<std::atomic<uint64_t>> _cutoffs;
+	int _classes = 0;
+	int _bins = 0;
+	int _coefficients = 0;
+	int _inputWidth = 0, _inputHeight = 0;
+	size_t _proto = 0;
+	int _protoWidth = 0, _protoHeight = 0;
+	float _protoScale = 1.0f, _protoZp = 0.0f;
+};
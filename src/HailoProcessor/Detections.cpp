@@ -0,0 +1,53 @@
+#include "Detections.h"
+
+#include <cstdint>
+#include "common/labels/coco_eighty.hpp"
+
+LabelTable::LabelTable(std::vector<std::string> labels) : _labels(std::move(labels))
+{
+}
+
+const LabelTable& LabelTable::Coco()
+{
+	static const LabelTable table = [] {
+		// coco_eighty starts with "unlabeled" at 0.
+		std::vector<std::string> labels;
+		for (auto& [id, label] : common::coco_eighty)
+			if (id > 0)
+				labels.push_back(label);
+		return LabelTable(std::move(labels));
+	}();
+	return table;
+}
+
+const std::string& LabelTable::operator[](int classId) const
+{
+	if (classId < 0 || classId >= static_cast<int>(_labels.size()))
+		return _empty;
+	return _labels[classId];
+}
+
+size_t LabelTable::Size() const
+{
+	return _labels.size();
+}
+
+void Detections::Clear(size_t features)
+{
+	XMin.clear(); YMin.clear(); Width.clear(); Height.clear();
+	Confidence.clear();
+	ClassId.clear();
+	Coefficients.clear();
+	Masks.clear();
+	Offsets.clear();
+	Features = features;
+}
+
+float* Detections::Add(float xMin, float yMin, float width, float height, float confidence, int classId)
+{
+	XMin.push_back(xMin); YMin.push_back(yMin); Width.push_back(width); Height.push_back(height);
+	Confidence.push_back(confidence);
+	ClassId.push_back(classId);
+	Coefficients.resize(Coefficients.size() + Features);
+	return Coefficients.data() + Coefficients.size() - Features;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+
+// Class names by class id, interned once. Detections carry only the id; segments point into the table.
+class LabelTable {
+public:
+	explicit LabelTable(std::vector<std::string> labels);
+	// The 80 COCO classes, in the order of the yolov8 score channels.
+	static const LabelTable& Coco();
+	// Empty for ids outside the table.
+	const std::string& operator[](int classId) const;
+	size_t Size() const;
+private:
+	std::vector<std::string> _labels;
+	std::string _empty;
+};
+
+// Detections of one frame as parallel arrays, highest score first.
+// Produced by the decoder without per-detection objects; the arrays keep their capacity between frames.
+struct Detections {
+	// normalized to the model input.
+	std::vector<float> XMin, YMin, Width, Height;
+	std::vector<float> Confidence;
+	std::vector<int> ClassId;
+	// Features mask coefficients per detection, one row each, so they multiply the prototype as one matrix.
+	std::vector<float> Coefficients;
+	size_t Features = 0;
+	// Filled by mask decoding: the mask of every detection and its origin in the mask resolution.
+	std::vector<cv::Mat> Masks;
+	std::vector<cv::Point> Offsets;
+
+	size_t Size() const { return Confidence.size(); }
+	void Clear(size_t features);
+	// Appends a detection and returns its coefficient row.
+	float* Add(float xMin, float yMin, float width, float height, float confidence, int classId);
+	const float* CoefficientsOf(size_t i) const { return Coefficients.data() + i * Features; }
+	cv::Rect2f Box(size_t i) const { return cv::Rect2f(XMin[i], YMin[i], Width[i], Height[i]); }
+};
@@ -1,12 +1,16 @@
 #include "Export.h"
 #include "HailoProcessorStatsDto.h"
 #include <fstream>
+#include <algorithm>
+#include <cstring>
+#include "HailoBackend.h"
+#include "ReplayBackend.h"
 
 EXPORT_API float segment_get_confidence(Segment* segment) {
 	return (segment) ? segment->Confidence : 0.0f;
 }
 EXPORT_API const char* segment_get_label(Segment* segment) {
-	return (segment) ? segment->Label.c_str() : nullptr;
+	return (segment) ? segment->Label : nullptr;
 }
 EXPORT_API int segment_get_classid(Segment* segment) {
 	return (segment) ? segment->ClassId : -1;
@@ -34,6 +38,36 @@ EXPORT_API int segment_compute_polygon(Segment* segment,float threshod, int* buf
 	}
 	return segment->ComputePolygon(threshod, buffer, maxSize);
 }
+// Where the segment_get_data pixels lie within segment_get_resolution; the whole resolution unless masks are box-local.
+EXPORT_API cv::Rect segment_get_mask_rect(Segment *segment) {
+	if(segment)
+		return segment->MaskRect();
+	return {0,0,0,0};
+}
+
+EXPORT_API cv::Rect2f segment_get_frame_bbox(Segment *segment) {
+	if(segment) {
+		return segment->FrameBbox();
+	}
+	return {0,0,0,0};
+}
+
+EXPORT_API int segment_compute_frame_polygon(Segment* segment,float threshod, int* buffer, int maxSize) {
+	if (!segment || !buffer || maxSize <= 0) {
+		return 0;
+	}
+	return segment->ComputeFramePolygon(threshod, buffer, maxSize);
+}
+EXPORT_API int segment_get_mask_format(Segment *segment) {
+	return (segment) ? static_cast<int>(segment->Format) : -1;
+}
+EXPORT_API const uint8_t* segment_get_mask_buffer(Segment *segment, int *bytes) {
+	size_t size = 0;
+	const uint8_t *buffer = (segment) ? segment->MaskBuffer(size) : nullptr;
+	if (bytes)
+		*bytes = static_cast<int>(size);
+	return buffer;
+}
 EXPORT_API Segment* segmentation_result_get(SegmentationResult* ptr, int index) {
 	if (!ptr || index < 0 || index >= ptr->Count()) {
 		return nullptr;
@@ -56,9 +90,22 @@ int segmentation_result_uncertainCounter(SegmentationResult *ptr) {
 
 EXPORT_API void segmentation_result_dispose(SegmentationResult* ptr)
 {
-	if (ptr) {
-		delete ptr;
-	}
+	SegmentationResult::Return(ptr);
+}
+
+EXPORT_API uint64_t segmentation_result_handle(SegmentationResult* ptr)
+{
+	return (ptr) ? SegmentationResult::Pool().Handle(ptr) : 0;
+}
+
+EXPORT_API SegmentationResult* segmentation_result_resolve(uint64_t handle)
+{
+	return SegmentationResult::Pool().Resolve(handle);
+}
+
+EXPORT_API int segmentation_result_release(uint64_t handle)
+{
+	return SegmentationResult::Return(handle) ? 1 : 0;
 }
 
 EXPORT_API FrameIdentifier segmentation_result_id(SegmentationResult *ptr) {
@@ -93,15 +140,84 @@ EXPORT_API HailoAsyncProcessor* hailo_processor_load_hef(const char* filename)
 }
 
 
+// Runs the pipeline without a device, serving the tensors recorded by hailo_processor_load_hef_capture.
+EXPORT_API HailoAsyncProcessor* hailo_processor_load_replay(const char* captureFile, int latencyUs, int jitterUs, unsigned int seed)
+{
+	try
+	{
+		auto backend = ReplayBackend::Load(captureFile, std::chrono::microseconds(latencyUs), std::chrono::microseconds(jitterUs), seed);
+		return HailoAsyncProcessor::Load(std::move(backend)).release();
+	}
+	catch (const HailoException& ex)
+	{
+		if (LAST_ERROR == nullptr) LAST_ERROR = new HailoError();
+		LAST_ERROR->SetLastError(ex);
+		return nullptr;
+	}
+}
+
+// Same as hailo_processor_load_hef, additionally recording up to maxFrames output frames (0 - no limit) to captureFile.
+EXPORT_API HailoAsyncProcessor* hailo_processor_load_hef_capture(const char* filename, const char* captureFile, int maxFrames)
+{
+	try
+	{
+		auto backend = std::make_unique<CaptureBackend>(HailoBackend::Load(filename), captureFile, maxFrames);
+		return HailoAsyncProcessor::Load(std::move(backend)).release();
+	}
+	catch (const HailoException& ex)
+	{
+		if (LAST_ERROR == nullptr) LAST_ERROR = new HailoError();
+		LAST_ERROR->SetLastError(ex);
+		return nullptr;
+	}
+}
+
 EXPORT_API void hailo_processor_start_async(HailoAsyncProcessor *ptr, CallbackWithContext callback, void *context) {
 	ptr->StartAsync(callback, context);
 }
 
 EXPORT_API void hailo_processor_update_stats(HailoAsyncProcessor *ptr, HailoProcessorStatsDto *dto) {
 	dto->UpdateFrom(ptr->Stats());
+	dto->cameraCount = static_cast<uint32_t>(ptr->Scheduler().CameraCount());
+	ptr->Admission().Snapshot(dto->admission);
 	//ptr->Stats().Print2();
 }
 
+EXPORT_API int hailo_processor_update_stats_ex(HailoAsyncProcessor *ptr, HailoProcessorStatsExDto *dto, int flags) {
+	const uint32_t version = HailoProcessorStatsExDto::VersionOf(dto->size);
+	if (version == 0)
+		return 0;
+	// filled whole, copied up to the caller's size: an older caller gets a prefix.
+	HailoProcessorStatsExDto full{};
+	full.UpdateFrom(ptr->Stats(), (flags & STATS_RESET_WINDOW) != 0);
+	ptr->Snapshot(full.queues);
+	full.version = version;
+	full.size = std::min<uint32_t>(dto->size, sizeof(HailoProcessorStatsExDto));
+	std::memcpy(dto, &full, full.size);
+	return static_cast<int>(version);
+}
+
+EXPORT_API void hailo_processor_trace(HailoAsyncProcessor *ptr, int enable) {
+	ptr->Tracing().Enable(enable != 0);
+}
+
+EXPORT_API int hailo_processor_trace_export(HailoAsyncProcessor *ptr, const char *fileName, int seconds) {
+	std::ofstream file(fileName, std::ios::out | std::ios::trunc);
+	if (!file)
+		return -1;
+	auto count = ptr->Tracing().Export(file, std::chrono::seconds(seconds > 0 ? seconds : 0));
+	file.close();
+	return file ? static_cast<int>(count) : -1;
+}
+
+EXPORT_API int hailo_processor_get_worker_stats(HailoAsyncProcessor *ptr, HailoProcessorStatsExDto::WorkerStatsDto *dst, int capacity) {
+	return static_cast<int>(ptr->Stats().Workers(dst, capacity > 0 ? capacity : 0));
+}
+
+EXPORT_API int hailo_processor_get_camera_stats(HailoAsyncProcessor *ptr, HailoProcessorStatsDto::CameraStatsDto *dst, int capacity) {
+	return static_cast<int>(ptr->Scheduler().Stats(dst, capacity > 0 ? capacity : 0));
+}
+
 
 EXPORT_API void hailo_processor_write_frame(HailoAsyncProcessor *ptr, uint8 *frame, unsigned int cameraId, unsigned long frameId, int frameW, int frameH, int roiX, int roiY,
                                             int roiW, int roiH, float threshold) {
@@ -134,6 +250,64 @@ EXPORT_API void hailo_processor_write_frame(HailoAsyncProcessor *ptr, uint8 *fra
 	}
 }
 
+template<PixelFormat F>
+void WritePlanes(HailoAsyncProcessor *ptr, const uint8 *planes[3], const int strides[3], const FrameIdentifier &id,
+	int frameW, int frameH, const Rect &roi, float threshold) {
+	FrameView<F> view;
+	view.Width = frameW;
+	view.Height = frameH;
+	for (int i = 0; i < 3; i++) {
+		view.Planes[i] = planes[i];
+		view.Strides[i] = strides[i];
+	}
+	ptr->Write(view, roi, id, threshold);
+}
+
+EXPORT_API void hailo_processor_write_planes(HailoAsyncProcessor *ptr, int pixelFormat,
+                                             const uint8 *plane0, int stride0, const uint8 *plane1, int stride1, const uint8 *plane2, int stride2,
+                                             unsigned int cameraId, unsigned long frameId, int frameW, int frameH, int roiX, int roiY,
+                                             int roiW, int roiH, float threshold) {
+	try
+	{
+		FrameIdentifier id(cameraId, frameId);
+		Rect roi(roiX, roiY, roiW, roiH);
+		const uint8* planes[3] = { plane0, plane1, plane2 };
+		const int strides[3] = { stride0, stride1, stride2 };
+		switch (static_cast<PixelFormat>(pixelFormat)) {
+			case PixelFormat::I420: WritePlanes<PixelFormat::I420>(ptr, planes, strides, id, frameW, frameH, roi, threshold); break;
+			case PixelFormat::NV12: WritePlanes<PixelFormat::NV12>(ptr, planes, strides, id, frameW, frameH, roi, threshold); break;
+			case PixelFormat::YUYV: WritePlanes<PixelFormat::YUYV>(ptr, planes, strides, id, frameW, frameH, roi, threshold); break;
+			case PixelFormat::I422: WritePlanes<PixelFormat::I422>(ptr, planes, strides, id, frameW, frameH, roi, threshold); break;
+			default: throw HailoException(HAILO_INVALID_ARGUMENT);
+		}
+	}
+	catch (const HailoException& ex)
+	{
+		if (LAST_ERROR == nullptr) LAST_ERROR = new HailoError();
+		LAST_ERROR->SetLastError(ex);
+	}
+}
+
+EXPORT_API void hailo_processor_write_frame_tiled(HailoAsyncProcessor *ptr, uint8 *frame, unsigned int cameraId, unsigned long frameId, int frameW, int frameH, int roiX, int roiY,
+                                            int roiW, int roiH, int cols, int rows, float overlap, float threshold) {
+	try
+	{
+		FrameIdentifier id(cameraId, frameId);
+		YuvFrame f(frameW, frameH, frame);
+		Rect roi(roiX, roiY, roiW, roiH);
+		TileGrid grid;
+		grid.Columns = cols;
+		grid.Rows = rows;
+		grid.Overlap = overlap;
+		ptr->Write(f, roi, grid, id, threshold);
+	}
+	catch (const HailoException& ex)
+	{
+		if (LAST_ERROR == nullptr) LAST_ERROR = new HailoError();
+		LAST_ERROR->SetLastError(ex);
+	}
+}
+
 EXPORT_API void hailo_processor_stop(HailoAsyncProcessor* ptr)
 {
 	if(ptr != nullptr) {
@@ -152,3 +326,80 @@ EXPORT_API void hailo_processor_set_confidence(HailoAsyncProcessor* ptr, float v
 	ptr->ConfidenceThreshold(value);
 }
 
+EXPORT_API int hailo_processor_get_resize_mode(HailoAsyncProcessor* ptr)
+{
+	return static_cast<int>(ptr->Resizing());
+}
+
+EXPORT_API void hailo_processor_set_resize_mode(HailoAsyncProcessor* ptr, int value)
+{
+	ptr->Resizing(value == 1 ? ResizeMode::Letterbox : ResizeMode::Stretch);
+}
+
+EXPORT_API int hailo_processor_get_mask_mode(HailoAsyncProcessor* ptr)
+{
+	return static_cast<int>(ptr->Masking());
+}
+
+EXPORT_API void hailo_processor_set_mask_mode(HailoAsyncProcessor* ptr, int value)
+{
+	ptr->Masking(value == 1 ? MaskMode::Box : MaskMode::Full);
+}
+
+EXPORT_API int hailo_processor_get_mask_format(HailoAsyncProcessor* ptr)
+{
+	return static_cast<int>(ptr->MaskFormatting());
+}
+
+EXPORT_API void hailo_processor_set_mask_format(HailoAsyncProcessor* ptr, int value)
+{
+	ptr->MaskFormatting(value >= 1 && value <= 3 ? static_cast<MaskFormat>(value) : MaskFormat::Float);
+}
+
+EXPORT_API float hailo_processor_get_mask_threshold(HailoAsyncProcessor* ptr)
+{
+	return ptr->MaskThreshold();
+}
+
+EXPORT_API void hailo_processor_set_mask_threshold(HailoAsyncProcessor* ptr, float value)
+{
+	ptr->MaskThreshold(value);
+}
+
+EXPORT_API void hailo_processor_set_pad_color(HailoAsyncProcessor* ptr, uint8 r, uint8 g, uint8 b)
+{
+	ptr->PadColor(RgbColor{ r, g, b });
+}
+
+EXPORT_API void hailo_processor_set_camera(HailoAsyncProcessor* ptr, uint32_t cameraId, int priority, uint32_t weight, float maxFps, uint32_t queueDepth)
+{
+	CameraConfig config;
+	config.Priority = static_cast<CameraPriority>(std::clamp(priority, 0, 2));
+	config.Weight = weight;
+	config.MaxFps = maxFps;
+	config.QueueDepth = queueDepth;
+	ptr->Camera(cameraId, config);
+}
+
+EXPORT_API void hailo_processor_set_admission(HailoAsyncProcessor* ptr, int mode, int maxLatencyUs, float targetFps, int allowDownscale)
+{
+	AdmissionConfig config;
+	config.Mode = static_cast<AdmissionMode>(std::clamp(mode, 0, 2));
+	config.MaxLatency = std::chrono::microseconds(maxLatencyUs);
+	config.TargetFps = targetFps;
+	config.AllowDownscale = allowDownscale != 0;
+	ptr->Admission().Configure(config);
+}
+
+EXPORT_API void memory_pool_configure(int hugePages, int lockMemory)
+{
+	MemoryPoolOptions options;
+	options.HugePages = hugePages != 0;
+	options.Lock = lockMemory != 0;
+	PageAlignedMemoryPool::Shared().Configure(options);
+}
+
+EXPORT_API int perf_counters_enable(int enable)
+{
+	return PerfCounters::Enable(enable != 0);
+}
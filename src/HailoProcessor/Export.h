@@ -22,6 +22,12 @@ EXPORT_API int    segmentation_result_count(SegmentationResult* ptr);
 EXPORT_API float  segmentation_result_threshold(SegmentationResult* ptr);
 EXPORT_API int    segmentation_result_uncertainCounter(SegmentationResult* ptr);
 EXPORT_API void   segmentation_result_dispose(SegmentationResult* ptr);
+// Generation-checked handle of a pooled result, 0 for one served from the heap.
+// A released handle no longer resolves, so a repeated dispose is harmless.
+EXPORT_API uint64_t segmentation_result_handle(SegmentationResult* ptr);
+EXPORT_API SegmentationResult* segmentation_result_resolve(uint64_t handle);
+// 1 when the result was given back, 0 for a stale handle.
+EXPORT_API int    segmentation_result_release(uint64_t handle);
 EXPORT_API FrameIdentifier segmentation_result_id(SegmentationResult* ptr);
 EXPORT_API cv::Rect segmentation_result_roi(SegmentationResult* ptr);
 
@@ -31,23 +37,83 @@ EXPORT_API const char* segment_get_label(Segment *segment);
 EXPORT_API float* segment_get_data(Segment *segment);
 EXPORT_API cv::Rect2f segment_get_bbox(Segment *segment);
 EXPORT_API cv::Size segment_get_resolution(Segment *segment);
+// part of the resolution the mask data covers; all of it unless MaskMode::Box is used.
+EXPORT_API cv::Rect segment_get_mask_rect(Segment *segment);
 EXPORT_API int segment_compute_polygon(Segment *segment, float threshod, int *buffer, int maxSize);
+// bbox and polygon in pixels of the frame that was written, regardless of the resize mode.
+EXPORT_API cv::Rect2f segment_get_frame_bbox(Segment *segment);
+EXPORT_API int segment_compute_frame_polygon(Segment *segment, float threshod, int *buffer, int maxSize);
+// 0 - float, 1 - probability u8, 2 - bits, 3 - rle; the buffer is the mask data in that format.
+EXPORT_API int segment_get_mask_format(Segment *segment);
+EXPORT_API const uint8_t* segment_get_mask_buffer(Segment *segment, int *bytes);
 
 EXPORT_API const char* get_last_hailo_error();
 
 #ifdef HAILO
 // can return nullptr, then check get_last_hailo_error
 EXPORT_API HailoAsyncProcessor*   hailo_processor_load_hef(const char* filename);
+EXPORT_API HailoAsyncProcessor*   hailo_processor_load_replay(const char* captureFile, int latencyUs, int jitterUs, unsigned int seed);
+EXPORT_API HailoAsyncProcessor*   hailo_processor_load_hef_capture(const char* filename, const char* captureFile, int maxFrames);
 
 EXPORT_API void hailo_processor_start_async(HailoAsyncProcessor *ptr, CallbackWithContext callback, void* context);
 EXPORT_API void hailo_processor_update_stats(HailoAsyncProcessor *ptr, HailoProcessorStatsDto *dto);
+// dto->size must be set by the caller; fills what fits and returns the version filled, 0 when dto is too small.
+// flags: STATS_RESET_WINDOW starts new latency windows once read, so that only one reader should pass it.
+#define STATS_RESET_WINDOW 1
+EXPORT_API int hailo_processor_update_stats_ex(HailoAsyncProcessor *ptr, HailoProcessorStatsExDto *dto, int flags);
+// Records per-frame stage spans while enabled (0 - off, the default).
+EXPORT_API void hailo_processor_trace(HailoAsyncProcessor *ptr, int enable);
+// Writes the spans that ended in the last seconds (0 - all kept) to fileName as Chrome trace-event JSON, for Perfetto.
+// Returns the number of spans, -1 when the file cannot be written.
+EXPORT_API int hailo_processor_trace_export(HailoAsyncProcessor *ptr, const char *fileName, int seconds);
+// Fills up to capacity entries, returns the number of pipeline threads (dto->workerCount).
+EXPORT_API int hailo_processor_get_worker_stats(HailoAsyncProcessor *ptr, HailoProcessorStatsExDto::WorkerStatsDto *dst, int capacity);
+// Fills up to capacity entries, returns the number of cameras seen so far (dto->cameraCount).
+EXPORT_API int hailo_processor_get_camera_stats(HailoAsyncProcessor *ptr, HailoProcessorStatsDto::CameraStatsDto *dst, int capacity);
 EXPORT_API void hailo_processor_write_frame(HailoAsyncProcessor* ptr,
                                                                            uint8* frame,
                                                                            uint32_t cameraId, uint64_t frameId,
                                                                            int frameW, int frameH, int roiX, int roiY,
                                                                            int roiW, int roiH, float threshold);
 
+// Frame given as planes with strides (bytes), read in place.
+// pixelFormat: 0 - I420, 1 - NV12, 2 - YUYV, 3 - I422; unused planes may be null.
+EXPORT_API void hailo_processor_write_planes(HailoAsyncProcessor* ptr, int pixelFormat,
+                                                                           const uint8* plane0, int stride0,
+                                                                           const uint8* plane1, int stride1,
+                                                                           const uint8* plane2, int stride2,
+                                                                           uint32_t cameraId, uint64_t frameId,
+                                                                           int frameW, int frameH, int roiX, int roiY,
+                                                                           int roiW, int roiH, float threshold);
+
+// Splits the roi into cols x rows tiles overlapping by 'overlap' (fraction of a tile); one merged result per frame.
+EXPORT_API void hailo_processor_write_frame_tiled(HailoAsyncProcessor* ptr,
+                                                                           uint8* frame,
+                                                                           uint32_t cameraId, uint64_t frameId,
+                                                                           int frameW, int frameH, int roiX, int roiY,
+                                                                           int roiW, int roiH, int cols, int rows,
+                                                                           float overlap, float threshold);
+
 EXPORT_API void hailo_processor_stop(HailoAsyncProcessor* ptr);
 EXPORT_API float             hailo_processor_get_confidence(HailoAsyncProcessor* ptr);
 EXPORT_API void              hailo_processor_set_confidence(HailoAsyncProcessor* ptr, float value);
+// 0 - stretch, 1 - letterbox
+EXPORT_API int               hailo_processor_get_resize_mode(HailoAsyncProcessor* ptr);
+EXPORT_API void              hailo_processor_set_resize_mode(HailoAsyncProcessor* ptr, int value);
+EXPORT_API int               hailo_processor_get_mask_mode(HailoAsyncProcessor* ptr);
+EXPORT_API void              hailo_processor_set_mask_mode(HailoAsyncProcessor* ptr, int value);
+EXPORT_API int               hailo_processor_get_mask_format(HailoAsyncProcessor* ptr);
+EXPORT_API void              hailo_processor_set_mask_format(HailoAsyncProcessor* ptr, int value);
+EXPORT_API float             hailo_processor_get_mask_threshold(HailoAsyncProcessor* ptr);
+EXPORT_API void              hailo_processor_set_mask_threshold(HailoAsyncProcessor* ptr, float value);
+EXPORT_API void              hailo_processor_set_pad_color(HailoAsyncProcessor* ptr, uint8 r, uint8 g, uint8 b);
+// priority: 0 - high, 1 - normal, 2 - low; maxFps 0 - no cap.
+EXPORT_API void              hailo_processor_set_camera(HailoAsyncProcessor* ptr, uint32_t cameraId, int priority, uint32_t weight, float maxFps, uint32_t queueDepth);
+// mode: 0 - off, 1 - latency (maxLatencyUs), 2 - throughput (targetFps, 0 - what the pipeline sustains).
+EXPORT_API void              hailo_processor_set_admission(HailoAsyncProcessor* ptr, int mode, int maxLatencyUs, float targetFps, int allowDownscale);
+// Process-wide, applies to the buffers mapped afterwards, so call it before loading a processor.
+EXPORT_API void              memory_pool_configure(int hugePages, int lockMemory);
+// Process-wide per-thread hardware counters, attributed to the stages (0 - off, the default).
+// Returns 1 when counting, -errno when the kernel refused, see perf_event_paranoid.
+EXPORT_API int               perf_counters_enable(int enable);
 #endif
@@ -1,12 +1,97 @@
 #include "Frame.h"
 
+#include <cstring>
+
 #include "ArrayPool.h"
+#include "YuvConverter.h"
+#include "Preprocessor.h"
+
+
+// frames in flight over every stage, tile queues included; more are served from the heap.
+#define FRAME_CONTEXT_POOL_SIZE 256
+// results held by the callback consumer at once.
+#define SEGMENTATION_RESULT_POOL_SIZE 128
+// a pooled result keeping more mask bytes than this gives them back when returned; heap bytes, so capacity() is what it holds.
+#define SEGMENTATION_RESULT_RETAINED_BYTES (4 << 20)
 
+FrameContext::FrameContext() : Result(nullptr), Iteration(0), Threshold(0) {
+}
 
 FrameContext::FrameContext(const FrameIdentifier &id, const Rect rect, float threshold) : Result(nullptr), Iteration(0), Roi(rect), Id(id), Threshold(threshold) {
 
 }
 
+ObjectPool<FrameContext>& FrameContext::Pool() {
+	static ObjectPool<FrameContext> pool(FRAME_CONTEXT_POOL_SIZE);
+	return pool;
+}
+
+FrameContext* FrameContext::Rent(const FrameIdentifier &id, const Rect rect, float threshold) {
+	FrameContext* context = Pool().Rent();
+	context->Iteration = 0;
+	context->Transform = InputTransform();
+	context->Result = nullptr;
+	context->Id = id;
+	context->Roi = rect;
+	context->Threshold = threshold;
+	context->Slot = -1;
+	return context;
+}
+
+void FrameContext::Return(FrameContext *context) {
+	if (context == nullptr)
+		return;
+	if (!Pool().Acquire(context))
+		return;
+	context->Group.reset();
+	context->Result = nullptr;
+	Pool().Release(context);
+}
+
+Point2f InputTransform::ToFrame(const Point2f& p) const
+{
+	return Point2f(OffsetX + p.x * ScaleX, OffsetY + p.y * ScaleY);
+}
+
+Rect2f InputTransform::ToFrame(const Rect2f& r) const
+{
+	return Rect2f(OffsetX + r.x * ScaleX, OffsetY + r.y * ScaleY, r.width * ScaleX, r.height * ScaleY);
+}
+
+Rect2f InputTransform::ToContent(const Rect2f& normalized, const cv::Size& input) const
+{
+	return Rect2f((normalized.x * input.width - Content.x) / Content.width,
+		(normalized.y * input.height - Content.y) / Content.height,
+		normalized.width * input.width / Content.width,
+		normalized.height * input.height / Content.height);
+}
+
+InputTransform InputTransform::Stretch(const Rect& roi, const cv::Size& input)
+{
+	InputTransform t;
+	t.Content = Rect(0, 0, input.width, input.height);
+	t.ScaleX = static_cast<float>(roi.width) / input.width;
+	t.ScaleY = static_cast<float>(roi.height) / input.height;
+	t.OffsetX = static_cast<float>(roi.x);
+	t.OffsetY = static_cast<float>(roi.y);
+	return t;
+}
+
+InputTransform InputTransform::Letterbox(const Rect& roi, const cv::Size& input)
+{
+	double scale = std::min(static_cast<double>(input.width) / roi.width, static_cast<double>(input.height) / roi.height);
+	int w = std::clamp(static_cast<int>(std::lround(roi.width * scale)), 1, input.width);
+	int h = std::clamp(static_cast<int>(std::lround(roi.height * scale)), 1, input.height);
+
+	InputTransform t;
+	t.Content = Rect((input.width - w) / 2, (input.height - h) / 2, w, h);
+	t.ScaleX = static_cast<float>(roi.width) / w;
+	t.ScaleY = static_cast<float>(roi.height) / h;
+	t.OffsetX = static_cast<float>(roi.x);
+	t.OffsetY = static_cast<float>(roi.y);
+	return t;
+}
+
 RgbColor RgbColor::FromArgb(uint8_t r, uint8_t g, uint8_t b)
 {
 	return RgbColor{ r, g, b };
@@ -54,7 +139,7 @@ YuvFrame::YuvFrame(int w, int h) : _y_plane_size(w*h),
 	_height(h),
 	_external(false)
 {
-	this->_d = new uint8[_size];
+	this->_d = static_cast<uint8*>(PageAlignedMemoryPool::Shared().Rent(_size));
 }
 
 YuvFrame::YuvFrame(int w, int h, uint8* data)
@@ -71,7 +156,7 @@ YuvFrame::YuvFrame(int w, int h, uint8* data)
 YuvFrame::~YuvFrame()
 {
 	if (!_external)
-		delete _d;
+		PageAlignedMemoryPool::Shared().Return(_d, _size);
 }
 
 void YuvFrame::Dump() const
@@ -122,79 +207,65 @@ Mat YuvFrame::ToMat() const
 }
 Mat YuvFrame::ToMatRgb(const Rect& roi) const
 {
-	Mat dst(roi.width, roi.height, CV_8UC3, cv::Scalar(0, 0, 0));
-
-	for (int ix = 0; ix < roi.width; ix++)
-		for (int iy = 0; iy < roi.height; iy++) {
-			cv::Vec3b& pixel = dst.at<cv::Vec3b>(iy, ix);
-
-			RgbColor px = this->GetPixel(roi.x + ix, roi.y + iy);
-
-			pixel[0] = px.r;
-			pixel[1] = px.g;
-			pixel[2] = px.b;
-		}
+	Mat dst(roi.height, roi.width, CV_8UC3);
+	CopyToRgb(roi, dst);
 	return dst;
 }
 
-cv::Mat YuvFrame::ToMatRgb(const cv::Rect& roi, const cv::Size& dstSize) const
+cv::Mat YuvFrame::ToMatRgb(const cv::Rect& roi, const cv::Size& dstSize, int interpolation) const
 {
-	auto tmp = this->ToMatRgb(roi);
-	if (tmp.size() != dstSize) {
-		cv::resize(tmp, tmp, dstSize);
-	}
-	return tmp;
+	Mat dst(dstSize, CV_8UC3);
+	CopyToRgb(roi, dstSize, dst.data, interpolation);
+	return dst;
+}
+void YuvFrame::CopyTo(const Rect& roi, Mat dst, ChannelOrder order) const
+{
+	const uint8* yPlane = _d;
+	const uint8* uPlane = _d + _y_plane_size;
+	const uint8* vPlane = uPlane + _u_plane_size;
+	YuvConverter::ConvertI420(yPlane, _width, uPlane, vPlane, _width / 2,
+		roi.x, roi.y, roi.width, roi.height,
+		dst.data, static_cast<int>(dst.step), order);
+}
+void YuvFrame::ResizeTo(const Rect& roi, const cv::Size& dstSize, uint8* dst, size_t dstStep, ChannelOrder order, int interpolation) const
+{
+	Preprocessor::Resize(View(), roi.x, roi.y, roi.width, roi.height,
+		dst, dstSize.width, dstSize.height, static_cast<int>(dstStep), order, ToResizeFilter(interpolation));
+}
+FrameView<PixelFormat::I420> YuvFrame::View() const
+{
+	return FrameView<PixelFormat::I420>::Packed(_d, _width, _height);
 }
 void YuvFrame::CopyToRgb(const Rect& roi, Mat dst) const
 {
-	for (int ix = 0; ix < roi.width; ix++)
-		for (int iy = 0; iy < roi.height; iy++) {
-			cv::Vec3b& pixel = dst.at<cv::Vec3b>(iy, ix);
-
-			RgbColor px = this->GetPixel(roi.x + ix, roi.y + iy);
-
-			pixel[0] = px.r;
-			pixel[1] = px.g;
-			pixel[2] = px.b;
-		}
+	CopyTo(roi, dst, ChannelOrder::Rgb);
 }
 void YuvFrame::CopyToBgr(const Rect& roi, Mat dst) const
 {
-	for (int ix = 0; ix < roi.width; ix++)
-		for (int iy = 0; iy < roi.height; iy++) {
-			cv::Vec3b& pixel = dst.at<cv::Vec3b>(iy, ix);
-
-			RgbColor px = this->GetPixel(roi.x + ix, roi.y + iy);
-
-			pixel[0] = px.b;
-			pixel[1] = px.g;
-			pixel[2] = px.r;
-		}
+	CopyTo(roi, dst, ChannelOrder::Bgr);
 }
 
 Mat YuvFrame::ToMatBgr(const Rect& roi) const
 {
-	Mat dst(roi.width, roi.height, CV_8UC3, cv::Scalar(0, 0, 0));
+	Mat dst(roi.height, roi.width, CV_8UC3);
 
 	CopyToBgr(roi, dst);
 	return dst;
 }
 void YuvFrame::CopyToRgb(const cv::Rect& roi, uint8* dst) const
 {
-	Mat tmp(roi.width, roi.height, CV_8UC3, dst);
+	Mat tmp(roi.height, roi.width, CV_8UC3, dst);
 	CopyToRgb(roi, tmp);
 }
 
-void YuvFrame::CopyToRgb(const cv::Rect& roi, const cv::Size& dstSize, uint8* dst) const
+void YuvFrame::CopyToRgb(const cv::Rect& roi, const cv::Size& dstSize, uint8* dst, int interpolation) const
 {
 	if (roi.size() != dstSize) {
-		auto src = this->ToMatRgb(roi);
-		Mat dstMat(dstSize.width, dstSize.height, CV_8UC3, dst);
-		cv::resize(src, dstMat, dstSize);
+		ResizeTo(roi, dstSize, dst, dstSize.width * 3, ChannelOrder::Rgb, interpolation);
 	}
 	else
 	{
-		Mat dstMat(dstSize.width, dstSize.height, CV_8UC3, dst);
+		Mat dstMat(dstSize, CV_8UC3, dst);
 		this->CopyToRgb(roi, dstMat);
 	}
 }
@@ -215,7 +286,7 @@ uint8* YuvFrame::AllocateFrameRgb(int w, int h)
 
 void YuvFrame::CopyToBgr(const cv::Rect& roi, uint8* dst) const
 {
-	Mat tmp(roi.width, roi.height, CV_8UC3, dst);
+	Mat tmp(roi.height, roi.width, CV_8UC3, dst);
 	CopyToBgr(roi, tmp);
 }
 
@@ -224,27 +295,28 @@ cv::Size YuvFrame::Size() const
 	return cv::Size(_width, _height);
 }
 
-void YuvFrame::CopyToBgr(const cv::Rect& roi, const cv::Size& dstSize, uint8* dst) const
+void YuvFrame::CopyToBgr(const cv::Rect& roi, const cv::Size& dstSize, uint8* dst, int interpolation) const
 {
 	if (roi.size() != dstSize) {
-		auto src = this->ToMatBgr(roi);
-		Mat dstMat(dstSize.width, dstSize.height, CV_8UC3, dst);
-		cv::resize(src, dstMat, dstSize, 0, 0, INTER_LINEAR);
+		ResizeTo(roi, dstSize, dst, dstSize.width * 3, ChannelOrder::Bgr, interpolation);
 	}
 	else
 	{
-		Mat dstMat(dstSize.width, dstSize.height, CV_8UC3, dst);
+		Mat dstMat(dstSize, CV_8UC3, dst);
 		this->CopyToBgr(roi, dstMat);
 	}
 }
 
-cv::Mat YuvFrame::ToMatBgr(const cv::Rect& roi, const cv::Size& dstSize) const
+cv::Mat YuvFrame::ToMatBgr(const cv::Rect& roi, const cv::Size& dstSize, int interpolation) const
 {
-	auto tmp = this->ToMatBgr(roi);
-	if (tmp.size() != dstSize) {
-		cv::resize(tmp, tmp, dstSize);
-	}
-	return tmp;
+	Mat dst(dstSize, CV_8UC3);
+	CopyToBgr(roi, dstSize, dst.data, interpolation);
+	return dst;
+}
+
+InputTransform YuvFrame::LetterboxToBgr(const cv::Rect& roi, const cv::Size& dstSize, uint8* dst, const RgbColor& pad, int interpolation) const
+{
+	return InputTransform::LetterboxTo(View(), roi, dstSize, dst, pad, ChannelOrder::Bgr, interpolation);
 }
 
 
@@ -273,32 +345,141 @@ int YuvFrame::Height() const {
 void Segment::SaveFile(const string& fileName) const
 {
 	cv::Mat normalized;
-	Mask.convertTo(normalized, CV_8UC1, 255.0);
+	if (Format == MaskFormat::Float)
+		Mask.convertTo(normalized, CV_8UC1, 255.0);
+	else if (Format == MaskFormat::Probability)
+		normalized = Mask;
+	else
+		normalized = Binary(0.0f);
 	cv::imwrite(fileName, normalized);
 }
 
 float Segment::At(int x, int y) const {
-	return this->Mask.at<float>(y,x);
+	x -= Offset.x;
+	y -= Offset.y;
+	const Size size = MaskRect().size();
+	if (x < 0 || y < 0 || x >= size.width || y >= size.height)
+		return 0.0f;
+	switch (Format) {
+	case MaskFormat::Probability:
+		return Mask.at<uint8_t>(y, x) / 255.0f;
+	case MaskFormat::Bits: {
+		const size_t i = static_cast<size_t>(y) * size.width + x;
+		return (Encoded.data[i >> 3] >> (7 - (i & 7))) & 1 ? 1.0f : 0.0f;
+	}
+	case MaskFormat::Rle: {
+		const size_t i = static_cast<size_t>(y) * size.width + x;
+		const uint32_t *runs = reinterpret_cast<const uint32_t*>(Encoded.data);
+		size_t end = 0;
+		for (size_t r = 0; r < Encoded.total() / sizeof(uint32_t); r++) {
+			end += runs[r];
+			if (i < end)
+				return (r & 1) ? 1.0f : 0.0f;
+		}
+		return 0.0f;
+	}
+	default:
+		return this->Mask.at<float>(y,x);
+	}
 }
 
+// Float masks only; the other formats have no float pixels, see MaskBuffer.
 float * Segment::Data() const {
-	float* floatData = reinterpret_cast<float*>(this->Mask.data);
-	return floatData;
+	if (Format != MaskFormat::Float || Mask.empty())
+		return nullptr;
+	return const_cast<float*>(Mask.ptr<float>());
 }
 
-std::unique_ptr<std::vector<cv::Point>> Segment::ComputePolygon(float threshold) {
+Rect Segment::MaskRect() const {
+	if (Format == MaskFormat::Bits || Format == MaskFormat::Rle)
+		return Rect(Offset, EncodedSize);
+	return Rect(Offset, Mask.size());
+}
 
-	// Convert the mask to binary
-	cv::Mat binary_mask;
-	cv::threshold(Mask, binary_mask, threshold, 1.0, cv::THRESH_BINARY);
+const uint8_t* Segment::MaskBuffer(size_t& bytes) const {
+	if (Format == MaskFormat::Bits || Format == MaskFormat::Rle) {
+		bytes = Encoded.total();
+		return Encoded.data;
+	}
+	bytes = Mask.total() * Mask.elemSize();
+	return Mask.data;
+}
+
+Mat Segment::Binary(float threshold) const {
+	Mat binary;
+	switch (Format) {
+	case MaskFormat::Float:
+		if (!Mask.empty())
+			cv::compare(Mask, threshold, binary, cv::CMP_GT);
+		return binary;
+	case MaskFormat::Probability:
+		if (!Mask.empty())
+			cv::compare(Mask, threshold * 255.0f, binary, cv::CMP_GT);
+		return binary;
+	default:
+		break;
+	}
+	if (EncodedSize.empty() || Encoded.empty())
+		return binary;
+	binary = Mat::zeros(EncodedSize, CV_8UC1);
+	uint8_t *dst = binary.data;
+	const size_t pixels = binary.total();
+	if (Format == MaskFormat::Bits) {
+		for (size_t i = 0; i < pixels; i++)
+			dst[i] = (Encoded.data[i >> 3] >> (7 - (i & 7))) & 1 ? 255 : 0;
+		return binary;
+	}
+	const uint32_t *runs = reinterpret_cast<const uint32_t*>(Encoded.data);
+	size_t at = 0;
+	for (size_t r = 0; r < Encoded.total() / sizeof(uint32_t) && at < pixels; r++) {
+		const size_t end = std::min(pixels, at + runs[r]);
+		if (r & 1)
+			std::fill(dst + at, dst + end, 255);
+		at = end;
+	}
+	return binary;
+}
+
+void Segment::Encode(const Mat& binary, MaskFormat format, vector<uint8_t> &encoded) {
+	if (format == MaskFormat::Bits) {
+		const size_t pixels = binary.total();
+		encoded.assign((pixels + 7) / 8, 0);
+		size_t i = 0;
+		for (int y = 0; y < binary.rows; y++) {
+			const uint8_t *row = binary.ptr<uint8_t>(y);
+			for (int x = 0; x < binary.cols; x++, i++)
+				encoded[i >> 3] |= static_cast<uint8_t>((row[x] != 0) << (7 - (i & 7)));
+		}
+		return;
+	}
+	thread_local vector<uint32_t> runs;
+	runs.clear();
+	uint32_t run = 0;
+	bool foreground = false;
+	for (int y = 0; y < binary.rows; y++) {
+		const uint8_t *row = binary.ptr<uint8_t>(y);
+		for (int x = 0; x < binary.cols; x++) {
+			if ((row[x] != 0) != foreground) {
+				runs.push_back(run);
+				run = 0;
+				foreground = !foreground;
+			}
+			run++;
+		}
+	}
+	runs.push_back(run);
+	encoded.resize(runs.size() * sizeof(uint32_t));
+	std::memcpy(encoded.data(), runs.data(), encoded.size());
+}
 
-	// Convert to 8-bit for contour finding
-	cv::Mat binary_mask_8u;
-	binary_mask.convertTo(binary_mask_8u, CV_8UC1, 255.0);
+std::unique_ptr<std::vector<cv::Point>> Segment::ComputePolygon(float threshold) {
+	cv::Mat binary_mask_8u = Binary(threshold);
+	if (binary_mask_8u.empty())
+		return std::make_unique<std::vector<cv::Point>>();
 
 	// Find contours
 	std::vector<std::vector<cv::Point>> contours;
-	cv::findContours(binary_mask_8u, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+	cv::findContours(binary_mask_8u, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE, Offset);
 
 	if (contours.empty())
 		return std::make_unique<std::vector<cv::Point>>();  // Return empty vector
@@ -320,18 +501,30 @@ std::unique_ptr<std::vector<cv::Point>> Segment::ComputePolygon(float threshold)
 	return result;
 }
 
-int Segment::ComputePolygon(float threshold, int *dstBuffer, int maxSize) {
-	// Convert the mask to binary
-	cv::Mat binary_mask;
-	cv::threshold(Mask, binary_mask, threshold, 1.0, cv::THRESH_BINARY);
+Rect2f Segment::FrameBbox() const {
+	Rect2f pixels(Bbox.x * Resolution.width, Bbox.y * Resolution.height,
+		Bbox.width * Resolution.width, Bbox.height * Resolution.height);
+	return Transform.ToFrame(pixels);
+}
+
+int Segment::ComputeFramePolygon(float threshold, int *dstBuffer, int maxSize) {
+	int count = ComputePolygon(threshold, dstBuffer, maxSize);
+	for (int i = 0; i < count; i += 2) {
+		auto p = Transform.ToFrame(Point2f(dstBuffer[i] + 0.5f, dstBuffer[i + 1] + 0.5f));
+		dstBuffer[i] = static_cast<int>(p.x);
+		dstBuffer[i + 1] = static_cast<int>(p.y);
+	}
+	return count;
+}
 
-	// Convert to 8-bit for contour finding
-	cv::Mat binary_mask_8u;
-	binary_mask.convertTo(binary_mask_8u, CV_8UC1, 255.0);
+int Segment::ComputePolygon(float threshold, int *dstBuffer, int maxSize) {
+	cv::Mat binary_mask_8u = Binary(threshold);
+	if (binary_mask_8u.empty())
+		return 0;
 
 	// Find contours
 	std::vector<std::vector<cv::Point>> contours;
-	cv::findContours(binary_mask_8u, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+	cv::findContours(binary_mask_8u, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE, Offset);
 
 	if (contours.empty()) {
 		return 0;  // No contours found
@@ -367,9 +560,74 @@ Segment::~Segment() {
 	Mask.release();
 }
 
+SegmentationResult::SegmentationResult() : _uncertainCounter(0), _threshold(0) {
+}
+
 SegmentationResult::SegmentationResult(const FrameIdentifier &id,const Rect &roi, float threshold) : _id(id), _roi(roi), _uncertainCounter(0), _threshold(threshold) {
 }
 
+ObjectPool<SegmentationResult>& SegmentationResult::Pool() {
+	static ObjectPool<SegmentationResult> pool(SEGMENTATION_RESULT_POOL_SIZE);
+	return pool;
+}
+
+SegmentationResult* SegmentationResult::Rent(const FrameIdentifier &id, const Rect &roi, float threshold) {
+	SegmentationResult* result = Pool().Rent();
+	result->Reset(id, roi, threshold);
+	return result;
+}
+
+void SegmentationResult::Return(SegmentationResult *result) {
+	if (result == nullptr || !Pool().Acquire(result))
+		return;
+	result->Recycle();
+	Pool().Release(result);
+}
+
+bool SegmentationResult::Return(uint64_t handle) {
+	// acquired first, so a repeated or racing dispose of the handle never recycles a result rented again meanwhile.
+	SegmentationResult* result = Pool().Acquire(handle);
+	if (result == nullptr)
+		return false;
+	result->Recycle();
+	Pool().Release(result);
+	return true;
+}
+
+void SegmentationResult::Recycle() {
+	// the segments point into the buffers.
+	_items.clear();
+	size_t retained = 0;
+	for (auto &b : _buffers)
+		retained += b.capacity();
+	if (retained > SEGMENTATION_RESULT_RETAINED_BYTES)
+		vector<vector<uint8_t>>().swap(_buffers);
+}
+
+void SegmentationResult::Reset(const FrameIdentifier &id, const Rect &roi, float threshold) {
+	_items.clear();
+	_id = id;
+	_roi = roi;
+	_threshold = threshold;
+	_uncertainCounter = 0;
+}
+
+vector<uint8_t>& SegmentationResult::Buffer(size_t index) {
+	if (_buffers.size() <= index)
+		_buffers.resize(index + 1);
+	return _buffers[index];
+}
+
+Mat SegmentationResult::Store(const Mat &mask) {
+	if (mask.empty())
+		return Mat();
+	auto &buffer = Buffer(_items.size());
+	buffer.resize(mask.total() * mask.elemSize());
+	Mat stored(mask.size(), mask.type(), buffer.data());
+	mask.copyTo(stored);
+	return stored;
+}
+
 float* SegmentationResult::GetMask(int index) const {
 	return this->_items[index].Data();
 }
@@ -405,9 +663,25 @@ Segment& SegmentationResult::Get(int index)
 	return this->_items[index];
 }
 
-void SegmentationResult::Add(const Mat &mask, int classid, const Size &size, const Rect2f &bbox, float confidence, const string &label)
+void SegmentationResult::Add(const Mat &mask, int classid, const Size &size, const Rect2f &bbox, float confidence, const char* label, const InputTransform &transform, const Point &offset, MaskFormat format)
+{
+	if (format == MaskFormat::Bits || format == MaskFormat::Rle) {
+		auto &encoded = Buffer(_items.size());
+		Segment::Encode(mask, format, encoded);
+		Mat bytes = encoded.empty() ? Mat() : Mat(1, static_cast<int>(encoded.size()), CV_8UC1, encoded.data());
+		this->_items.emplace_back(Mat(), classid, size, bbox, confidence, label, transform, offset, format, mask.size(), bytes);
+	}
+	else
+		this->_items.emplace_back(Store(mask), classid, size, bbox, confidence, label, transform, offset, format);
+}
+
+void SegmentationResult::Add(const Segment &segment)
 {
-	this->_items.emplace_back(mask, classid, size, bbox, confidence, label);
+	// a deep copy, the segment's result may be returned to the pool before this one.
+	const bool encoded = segment.Format == MaskFormat::Bits || segment.Format == MaskFormat::Rle;
+	Mat pixels = Store(encoded ? segment.Encoded : segment.Mask);
+	this->_items.emplace_back(encoded ? Mat() : pixels, segment.ClassId, segment.Resolution, segment.Bbox, segment.Confidence, segment.Label,
+		segment.Transform, segment.Offset, segment.Format, segment.EncodedSize, encoded ? pixels : Mat());
 }
 
 void SegmentationResult::IncrementUncertainCounter() {
@@ -7,8 +7,14 @@
 #include "FrameIdentifier.h"
 #include <cstdint>
 #include "StopWatch.h"
+#include "YuvConverter.h"
+#include "FrameView.h"
+#include "Preprocessor.h"
+#include "ObjectPool.h"
 
 class SegmentationResult;
+class TileGroup;
+struct RgbColor;
 
 using namespace std;
 using namespace cv;
@@ -16,13 +22,56 @@ using namespace cv;
 
 
 
+// Maps pixels of the model input back to the frame.
+// Content is the part of the input the ROI was scaled into (the whole input unless letterboxed);
+// ToFrame takes coordinates relative to Content's origin.
+struct InputTransform {
+	Rect Content;
+	float ScaleX = 1.0f;
+	float ScaleY = 1.0f;
+	float OffsetX = 0.0f;
+	float OffsetY = 0.0f;
+
+	Point2f ToFrame(const Point2f& p) const;
+	Rect2f ToFrame(const Rect2f& r) const;
+	// Normalized coordinates of the whole model input -> normalized coordinates of Content.
+	Rect2f ToContent(const Rect2f& normalized, const cv::Size& input) const;
+
+	static InputTransform Stretch(const Rect& roi, const cv::Size& input);
+	static InputTransform Letterbox(const Rect& roi, const cv::Size& input);
+
+	// Preprocesses roi of src into a dstSize buffer and returns the mapping back to src.
+	template<PixelFormat F>
+	static InputTransform StretchTo(const FrameView<F>& src, const Rect& roi, const cv::Size& dstSize, uint8* dst,
+		ChannelOrder order, int interpolation);
+	template<PixelFormat F>
+	static InputTransform LetterboxTo(const FrameView<F>& src, const Rect& roi, const cv::Size& dstSize, uint8* dst,
+		const RgbColor& pad, ChannelOrder order, int interpolation);
+};
+
+inline ResizeFilter ToResizeFilter(int interpolation) {
+	return interpolation == INTER_AREA ? ResizeFilter::Area : ResizeFilter::Bilinear;
+}
+
 struct FrameContext {
+	FrameContext();
 	FrameContext(const FrameIdentifier &id, const Rect rect, float threshold);
+	// A pooled context, reinitialized for the frame. Give it back with Return, never delete it.
+	static FrameContext* Rent(const FrameIdentifier &id, const Rect rect, float threshold);
+	// Releases the tile group, not the Result.
+	static void Return(FrameContext *context);
+	static ObjectPool<FrameContext>& Pool();
+
 	uint64_t Iteration;
+	InputTransform Transform;
 	SegmentationResult *Result;
-	const FrameIdentifier Id;
-	const Rect Roi;
-	const float Threshold;
+	FrameIdentifier Id;
+	Rect Roi;
+	float Threshold;
+	// Set when the frame is one tile of a larger one.
+	shared_ptr<TileGroup> Group;
+	// TensorRing slot with the output tensors, -1 until every output of the frame was read.
+	int Slot = -1;
 
 	StopWatch InterferenceAndReadWatch;
 	StopWatch WriteWatch;
@@ -62,16 +111,22 @@ public:
 
 	cv::Mat ToMat() const;
 	cv::Mat ToMatBgr(const cv::Rect& roi) const;
-	cv::Mat ToMatBgr(const cv::Rect& roi, const cv::Size& dstSize) const;
+	// Resizing variants crop, resize and convert in a single pass (see Preprocessor).
+	cv::Mat ToMatBgr(const cv::Rect& roi, const cv::Size& dstSize, int interpolation = INTER_LINEAR) const;
 
 	void CopyToBgr(const cv::Rect& roi, uint8* dst) const;
-	void CopyToBgr(const cv::Rect& roi, const cv::Size& dstSize, uint8* dst) const;
+	void CopyToBgr(const cv::Rect& roi, const cv::Size& dstSize, uint8* dst, int interpolation = INTER_LINEAR) const;
 
 	cv::Mat ToMatRgb(const cv::Rect& roi) const;
-	cv::Mat ToMatRgb(const cv::Rect& roi, const cv::Size& dstSize) const;
+	cv::Mat ToMatRgb(const cv::Rect& roi, const cv::Size& dstSize, int interpolation = INTER_LINEAR) const;
 
 	void CopyToRgb(const cv::Rect& roi, uint8* dst) const;
-	void CopyToRgb(const cv::Rect& roi, const cv::Size& dstSize, uint8* dst) const;
+	void CopyToRgb(const cv::Rect& roi, const cv::Size& dstSize, uint8* dst, int interpolation = INTER_LINEAR) const;
+
+	// Scales the ROI uniformly into the center of dstSize and fills the bars with pad, all in dst.
+	InputTransform LetterboxToBgr(const cv::Rect& roi, const cv::Size& dstSize, uint8* dst, const RgbColor& pad, int interpolation = INTER_LINEAR) const;
+
+	FrameView<PixelFormat::I420> View() const;
 
 	static uint8* AllocateFrameYuv(int w, int h);
 	static uint8* AllocateFrameRgb(int w, int h);
@@ -80,6 +135,8 @@ public:
 	int Width() const;
 	int Height() const;
 private:
+	void CopyTo(const Rect& roi, Mat dst, ChannelOrder order) const;
+	void ResizeTo(const Rect& roi, const cv::Size& dstSize, uint8* dst, size_t dstStep, ChannelOrder order, int interpolation) const;
 	void CopyToBgr(const Rect& roi, Mat dst) const;
 	void CopyToRgb(const Rect& roi, Mat dst) const;
 	const int _y_plane_size;
@@ -92,26 +149,100 @@ private:
 };
 
 
+template<PixelFormat F>
+InputTransform InputTransform::StretchTo(const FrameView<F>& src, const Rect& roi, const cv::Size& dstSize, uint8* dst,
+	ChannelOrder order, int interpolation)
+{
+	Preprocessor::Resize(src, roi.x, roi.y, roi.width, roi.height,
+		dst, dstSize.width, dstSize.height, dstSize.width * 3, order, ToResizeFilter(interpolation));
+	return Stretch(roi, dstSize);
+}
+
+template<PixelFormat F>
+InputTransform InputTransform::LetterboxTo(const FrameView<F>& src, const Rect& roi, const cv::Size& dstSize, uint8* dst,
+	const RgbColor& pad, ChannelOrder order, int interpolation)
+{
+	auto t = Letterbox(roi, dstSize);
+	const Rect& c = t.Content;
+	const uint8 pixel[3] = {
+		order == ChannelOrder::Bgr ? pad.b : pad.r,
+		pad.g,
+		order == ChannelOrder::Bgr ? pad.r : pad.b
+	};
+	Preprocessor::Letterbox(src, roi.x, roi.y, roi.width, roi.height,
+		dst, dstSize.width, dstSize.height, dstSize.width * 3,
+		c.x, c.y, c.width, c.height, pixel, order, ToResizeFilter(interpolation));
+	return t;
+}
+
+
+enum class MaskMode {
+	// Every mask covers the whole model input (the letterbox content when letterboxed).
+	Full,
+	// Masks are decoded and stored only over the detection box, see Segment::MaskRect.
+	Box
+};
+
+enum class MaskFormat {
+	// Probabilities as CV_32FC1 (default).
+	Float,
+	// Probabilities scaled to 0..255, CV_8UC1.
+	Probability,
+	// Thresholded, one bit per pixel: row-major over MaskRect, most significant bit first, rows not padded.
+	Bits,
+	// Thresholded, uint32 run lengths over the same pixel order, alternating background and foreground, background first.
+	Rle
+};
 struct Segment {
 	Mat Mask;
 	const int ClassId;
 	const Size Resolution;
 	const Rect2f Bbox;
 	const float Confidence;
-	const string Label;
+	// points into the LabelTable, which outlives every result.
+	const char* Label;
+	// Mask pixels -> frame pixels.
+	const InputTransform Transform;
+	// Origin of Mask within Resolution, (0, 0) unless the mask is box-local.
+	const Point Offset = Point(0, 0);
+	const MaskFormat Format = MaskFormat::Float;
+	// Bits and Rle keep no Mask, only the encoded pixels and their size.
+	const Size EncodedSize = Size(0, 0);
+	// one row of bytes.
+	const Mat Encoded;
 	void SaveFile(const string &fileName) const;
 	float At(int x, int y) const;
 	float* Data() const;
+	Rect2f FrameBbox() const;
+	// The part of Resolution covered by Mask.
+	Rect MaskRect() const;
+	// The mask data as stored: Mask pixels, or Encoded for Bits and Rle.
+	const uint8_t* MaskBuffer(size_t &bytes) const;
+	// Foreground pixels as 255, the rest 0. Bits and Rle were thresholded when decoded, so threshold is ignored for them.
+	Mat Binary(float threshold) const;
+	// Packs the non-zero pixels of an 8-bit mask as Bits or Rle into dst, which is resized to the encoded bytes.
+	static void Encode(const Mat &binary, MaskFormat format, vector<uint8_t> &dst);
 	unique_ptr<vector<cv::Point>> ComputePolygon(float thredshold);
 	int ComputePolygon(float thredshold, int* dstBuffer, int maxSize);
+	// Same as ComputePolygon, but the points are in frame pixels.
+	int ComputeFramePolygon(float thredshold, int* dstBuffer, int maxSize);
 	~Segment();
 private:
 
 };
 
+// Masks are copied into buffers owned by the result, which are kept when a pooled result is reused,
+// so a result serving frames of similar content stops allocating after the first few.
 class SegmentationResult {
 public:
+	SegmentationResult();
 	SegmentationResult(const FrameIdentifier &id, const Rect &roi, float threshold);
+	// A pooled result, reinitialized for the frame. Give it back with Return, never delete it.
+	static SegmentationResult* Rent(const FrameIdentifier &id, const Rect &roi, float threshold);
+	static void Return(SegmentationResult *result);
+	// False when the handle (ObjectPool::Handle) is stale.
+	static bool Return(uint64_t handle);
+	static ObjectPool<SegmentationResult>& Pool();
 	float* GetMask(int index)const;
 	Size GetResolution(int index) const;
 	int GetClassId(int index)const;
@@ -120,12 +251,21 @@ public:
 	float Threshold() const;
 	Rect Roi() const;
 	Segment& Get(int index) ;
-	void Add(const Mat &mask, int classid, const Size &size, const Rect2f &bbox, float confidence, const string &label);
+	void Add(const Mat &mask, int classid, const Size &size, const Rect2f &bbox, float confidence, const char* label, const InputTransform &transform, const Point &offset = Point(0, 0), MaskFormat format = MaskFormat::Float);
+	void Add(const Segment &segment);
 	void IncrementUncertainCounter();
 
 	FrameIdentifier Id() const;
 private:
+	void Reset(const FrameIdentifier &id, const Rect &roi, float threshold);
+	// Drops the segments and trims the buffers before the result goes back to the pool.
+	void Recycle();
+	// Copies mask into the buffer of the next segment.
+	Mat Store(const Mat &mask);
+	vector<uint8_t>& Buffer(size_t index);
 	vector<Segment> _items;
+	// pixels of _items[i], kept across frames. On the heap: most are a few KiB, a page-sized class each would waste the rest.
+	vector<vector<uint8_t>> _buffers;
 	Rect _roi;
 	FrameIdentifier _id;
 	float _threshold;
@@ -6,8 +6,8 @@
 #include <utility> // for std::pair
 #pragma pack(push, 1)
 struct alignas(1) FrameIdentifier {
-    const uint64_t FrameId;
-    const uint32_t CameraId;
+    uint64_t FrameId;
+    uint32_t CameraId;
 
     // Default constructor
     FrameIdentifier();
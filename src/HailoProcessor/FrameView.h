@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+enum class PixelFormat {
+	// Planar Y, U, V; chroma subsampled 2x2.
+	I420,
+	// Planar Y, interleaved UV; chroma subsampled 2x2.
+	NV12,
+	// Packed Y0 U Y1 V; chroma subsampled 2x1.
+	YUYV,
+	// Planar Y, U, V; chroma subsampled 2x1.
+	I422
+};
+
+// Non-owning view of a frame in the given pixel format, with per-plane pointers and strides (in bytes),
+// so padded V4L2/DMA buffers can be processed in place.
+// Unused planes are nullptr: NV12 uses Planes[0..1], YUYV only Planes[0].
+template<PixelFormat F>
+struct FrameView {
+	int Width = 0;
+	int Height = 0;
+	const uint8_t* Planes[3] = { nullptr, nullptr, nullptr };
+	int Strides[3] = { 0, 0, 0 };
+
+	static constexpr PixelFormat Format = F;
+
+	// View over a tightly packed buffer.
+	static FrameView Packed(const uint8_t* data, int width, int height);
+};
+
+template<PixelFormat F>
+FrameView<F> FrameView<F>::Packed(const uint8_t* data, int width, int height)
+{
+	FrameView<F> v;
+	v.Width = width;
+	v.Height = height;
+	const size_t lumaSize = static_cast<size_t>(width) * height;
+	if constexpr (F == PixelFormat::I420) {
+		v.Planes[0] = data;
+		v.Planes[1] = data + lumaSize;
+		v.Planes[2] = data + lumaSize + lumaSize / 4;
+		v.Strides[0] = width;
+		v.Strides[1] = v.Strides[2] = width / 2;
+	}
+	else if constexpr (F == PixelFormat::NV12) {
+		v.Planes[0] = data;
+		v.Planes[1] = data + lumaSize;
+		v.Strides[0] = v.Strides[1] = width;
+	}
+	else if constexpr (F == PixelFormat::YUYV) {
+		v.Planes[0] = data;
+		v.Strides[0] = width * 2;
+	}
+	else {
+		v.Planes[0] = data;
+		v.Planes[1] = data + lumaSize;
+		v.Planes[2] = data + lumaSize + lumaSize / 2;
+		v.Strides[0] = width;
+		v.Strides[1] = v.Strides[2] = width / 2;
+	}
+	return v;
+}
@@ -0,0 +1,104 @@
+#include "HailoBackend.h"
+
+#include <iostream>
+#include "HailoException.h"
+
+using namespace hailort;
+
+constexpr bool QUANTIZED = true;
+constexpr hailo_format_type_t FORMAT_TYPE = HAILO_FORMAT_TYPE_AUTO;
+
+std::shared_ptr<ConfiguredNetworkGroup> HailoBackend::ConfigureNetworkGroup(VDevice &vdevice, const std::string &hefFile)
+{
+	auto hef_exp = Hef::create(hefFile);
+	if (!hef_exp) {
+		throw HailoException(hef_exp.status());
+	}
+	auto hef = hef_exp.release();
+
+	auto configure_params = hef.create_configure_params(HAILO_STREAM_INTERFACE_PCIE);
+	if (!configure_params) {
+		throw HailoException(configure_params.status());
+	}
+
+	auto network_groups = vdevice.configure(hef, configure_params.value());
+	if (!network_groups) {
+		throw HailoException(network_groups.status());
+	}
+
+	if (1 != network_groups->size()) {
+		std::cerr << "Invalid amount of network groups" << std::endl;
+		throw HailoException(HAILO_INTERNAL_FAILURE);
+	}
+
+	return std::move(network_groups->at(0));
+}
+
+std::unique_ptr<HailoBackend> HailoBackend::Load(const std::string &hefFile)
+{
+	auto vdevice_exp = VDevice::create();
+	if (!vdevice_exp)
+		throw HailoException(vdevice_exp.status());
+
+	std::unique_ptr<VDevice> vdevice = vdevice_exp.release();
+	auto networkGroup = ConfigureNetworkGroup(*vdevice, hefFile);
+	return std::unique_ptr<HailoBackend>(new HailoBackend(std::move(vdevice), networkGroup));
+}
+
+HailoBackend::HailoBackend(std::unique_ptr<VDevice> dev, std::shared_ptr<ConfiguredNetworkGroup> networkGroup)
+	: _dev(std::move(dev)), _networkGroup(networkGroup)
+{
+	auto vstreams_exp = VStreamsBuilder::create_vstreams(*_networkGroup, QUANTIZED, FORMAT_TYPE);
+	if (!vstreams_exp) throw HailoException(vstreams_exp.status());
+
+	auto vstreams = vstreams_exp.release();
+	_inputs = std::move(vstreams.first);
+	_outputs = std::move(vstreams.second);
+
+	_inputInfo = _inputs[0].get_info();
+	for (auto &output : _outputs)
+		_outputInfos.push_back(output.get_info());
+}
+
+const hailo_vstream_info_t& HailoBackend::InputInfo() const
+{
+	return _inputInfo;
+}
+
+size_t HailoBackend::InputFrameSize() const
+{
+	return _inputs[0].get_frame_size();
+}
+
+size_t HailoBackend::OutputCount() const
+{
+	return _outputs.size();
+}
+
+const hailo_vstream_info_t& HailoBackend::OutputInfo(size_t output) const
+{
+	return _outputInfos[output];
+}
+
+size_t HailoBackend::OutputFrameSize(size_t output) const
+{
+	return _outputs[output].get_frame_size();
+}
+
+hailo_status HailoBackend::Write(const uint8_t *data, size_t size)
+{
+	return _inputs[0].write(MemoryView(const_cast<uint8_t*>(data), size));
+}
+
+hailo_status HailoBackend::Read(size_t output, uint8_t *data, size_t size)
+{
+	return _outputs[output].read(MemoryView(data, size));
+}
+
+void HailoBackend::Abort()
+{
+	for (auto &input : _inputs)
+		input.abort();
+	for (auto &output : _outputs)
+		output.abort();
+}
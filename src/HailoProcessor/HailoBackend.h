@@ -0,0 +1,35 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <hailo/vdevice.hpp>
+#include <hailo/vstream.hpp>
+
+#include "InferenceBackend.h"
+
+// The Hailo NPU, through HailoRT virtual streams.
+class HailoBackend : public InferenceBackend {
+public:
+	static std::unique_ptr<HailoBackend> Load(const std::string& hefFile);
+
+	const hailo_vstream_info_t& InputInfo() const override;
+	size_t InputFrameSize() const override;
+	size_t OutputCount() const override;
+	const hailo_vstream_info_t& OutputInfo(size_t output) const override;
+	size_t OutputFrameSize(size_t output) const override;
+	hailo_status Write(const uint8_t* data, size_t size) override;
+	hailo_status Read(size_t output, uint8_t* data, size_t size) override;
+	void Abort() override;
+
+private:
+	HailoBackend(std::unique_ptr<hailort::VDevice> dev, std::shared_ptr<hailort::ConfiguredNetworkGroup> networkGroup);
+	static std::shared_ptr<hailort::ConfiguredNetworkGroup> ConfigureNetworkGroup(hailort::VDevice& vdevice, const std::string& hefFile);
+
+	std::unique_ptr<hailort::VDevice> _dev;
+	std::shared_ptr<hailort::ConfiguredNetworkGroup> _networkGroup;
+	std::vector<hailort::InputVStream> _inputs;
+	std::vector<hailort::OutputVStream> _outputs;
+	hailo_vstream_info_t _inputInfo;
+	std::vector<hailo_vstream_info_t> _outputInfos;
+};
@@ -9,16 +9,24 @@
 #include "common/hailo_common.hpp"
 #include "ArrayOperations.h"
 #include "common.h"
-#include "yolov8seg_postprocess.hpp"
 #include "common/math.hpp"
 #include "common/tensors.hpp"
-#include "common/labels/coco_eighty.hpp"
 #include "defs.h"
+#include "HailoBackend.h"
+#include "Nms.h"
+#include "Detections.h"
+#include "Arena.h"
 using namespace xt::placeholders;
 
 #define SCORE_THRESHOLD 0.6
 #define IOU_THRESHOLD 0.7
 #define NUM_CLASSES 80
+#define REGRESSION_LENGTH 15
+#define MAX_DETECTIONS 300
+// writes on the device at once
+#define DEVICE_SLOTS 2
+// initial arena of a post-processing worker, it grows to the largest frame.
+#define POST_PROCESSING_ARENA_SIZE (8 << 20)
 
 
 
@@ -50,11 +58,17 @@ HailoException& HailoError::LastException() const
 void HailoAsyncProcessor::Stop() {
 	this->_isRunning = false;
 	// Triggers
-	_input_vstream->abort();
+	if (_backend)
+		_backend->Abort();
+	if (_tensors)
+		_tensors->Abort();
+	_scheduler.Cancel();
 	//_readOpNotifier.EnqueueWork();
 	 _callbackChannel.TryWrite(nullptr);
 	for(auto & _thread : _threads)
 	 	_thread.join();
+	// inputs preprocessed but never dispatched: give back their buffers and contexts.
+	_scheduler.Drain();
 	std::cout << "All threads stopped." << std::endl;
 }
 
@@ -62,91 +76,95 @@ HailoProcessorStats & HailoAsyncProcessor::Stats() {
 	return  this->_stats;
 }
 
-
-std::shared_ptr<ConfiguredNetworkGroup> HailoAsyncProcessor::ConfigureNetworkGroup(
-	VDevice &vdevice, const std::string &yolov_hef)
-{
-	auto hef_exp = Hef::create(yolov_hef);
-	if (!hef_exp) {
-		throw HailoException(hef_exp.status());
-	}
-	auto hef = hef_exp.release();
-
-	auto configure_params = hef.create_configure_params(HAILO_STREAM_INTERFACE_PCIE);
-	if (!configure_params) {
-		throw HailoException(configure_params.status());
-	}
-
-	auto network_groups = vdevice.configure(hef, configure_params.value());
-	if (!network_groups) {
-		throw HailoException(network_groups.status());
-	}
-
-	if (1 != network_groups->size()) {
-		std::cerr << "Invalid amount of network groups" << std::endl;
-		throw HailoException(HAILO_INTERNAL_FAILURE);
-	}
-
-	return std::move(network_groups->at(0));
+CameraScheduler & HailoAsyncProcessor::Scheduler() {
+	return this->_scheduler;
 }
-constexpr bool QUANTIZED = true;
-constexpr hailo_format_type_t FORMAT_TYPE = HAILO_FORMAT_TYPE_AUTO;
-
-unique_ptr<HailoAsyncProcessor> HailoAsyncProcessor::Load(const string &fileName) {
-	auto vdevice_exp = VDevice::create();
 
-	if (!vdevice_exp)
-		throw HailoException(vdevice_exp.status());
+AdmissionController & HailoAsyncProcessor::Admission() {
+	return this->_admission;
+}
 
-	std::unique_ptr<VDevice> vdevice = vdevice_exp.release();
 
-	std::shared_ptr<ConfiguredNetworkGroup> networkGroup = HailoAsyncProcessor::ConfigureNetworkGroup(
-		*vdevice, fileName);
+unique_ptr<HailoAsyncProcessor> HailoAsyncProcessor::Load(const string &fileName) {
+	return Load(HailoBackend::Load(fileName));
+}
 
-	auto ptr = new HailoAsyncProcessor(vdevice,networkGroup);
+unique_ptr<HailoAsyncProcessor> HailoAsyncProcessor::Load(unique_ptr<InferenceBackend> backend) {
+	auto ptr = new HailoAsyncProcessor(std::move(backend));
 	return std::unique_ptr<HailoAsyncProcessor>(ptr);
 }
 
+Tracer & HailoAsyncProcessor::Tracing() {
+	return this->_tracer;
+}
 
-std::shared_ptr<FeatureData<uint8>> HailoAsyncProcessor::CreateFeature(const hailo_vstream_info_t &vstream_info, size_t frameSize) {
-	return std::make_shared<FeatureData<uint8>>(static_cast<uint32_t>(frameSize), vstream_info.quant_info.qp_zp,
-		vstream_info.quant_info.qp_scale, vstream_info.shape.width, vstream_info);
+void HailoAsyncProcessor::Trace(TraceStage stage, const FrameContext *context, std::chrono::nanoseconds duration) {
+	if (_tracer.Enabled())
+		_tracer.Record(stage, duration, context->Id.CameraId, context->Id.FrameId, context->Iteration);
+}
 
+void HailoAsyncProcessor::Snapshot(HailoProcessorStatsExDto::QueuesDto &dto) {
+	const PipelineLoad load = CurrentLoad();
+	dto.scheduled = {static_cast<uint32_t>(load.Scheduled), 0};
+	dto.write = {static_cast<uint32_t>(load.Device), static_cast<uint32_t>(_writeChannel.Capacity())};
+	dto.postProcessing = {static_cast<uint32_t>(load.PostProcessing), static_cast<uint32_t>(_postProcessingChannel.Capacity())};
+	dto.callback = {static_cast<uint32_t>(load.Callback), static_cast<uint32_t>(_callbackChannel.Capacity())};
 }
-void HailoAsyncProcessor::OnWrite(const cv::Mat &org_frame, FrameContext *frameId) {
-	if(_stats.readInterferenceProcessing.Behind() >= 2) {
-		OnFrameDrop_OnWrite(frameId);
-		return;
-	}
 
-	frameId->Total.Start();
-	frameId->WriteWatch.Start();
-	auto input_shape = _input_vstream->get_info().shape;
-	int height = input_shape.height;
-	int width = input_shape.width;
-
-	auto dstSize = cv::Size(width, height);
-	size_t frame_size = _input_vstream->get_frame_size();
-
-	if(org_frame.size() != dstSize) {
-		// we need to resize.
-		Mat dst(dstSize, 3, CV_8UC1);
-		cv::resize(org_frame, dst, dstSize);
-		OnWrite(dst,frame_size,frameId);
-	} else {
-		OnWrite(org_frame, frame_size, frameId); // Writing height * width, 3 channels of uint8
+PipelineLoad HailoAsyncProcessor::CurrentLoad() {
+	PipelineLoad load;
+	load.Scheduled = _scheduler.Pending();
+	load.Device = _writeChannel.Pending();
+	load.PostProcessing = _postProcessingChannel.Pending();
+	load.Callback = _callbackChannel.Pending();
+	return load;
+}
+void HailoAsyncProcessor::Submit(const CameraScheduler::Ticket &ticket, FrameContext *frameId, void *buffer) {
+	ScheduledWrite write{frameId, buffer};
+	if(!_scheduler.Enqueue(ticket, write))
+		OnFrameDrop_OnSchedule(write);
+}
+// The only thread writing to the device, in the order the scheduler picks across cameras.
+void HailoAsyncProcessor::OnDispatch() {
+	ScheduledWrite write;
+	WorkerStats &worker = _stats.AddWorker(WorkerStage::Dispatch);
+	while (this->_isRunning) {
+		if (!_scheduler.Next(write, 1s))
+			continue;
+		auto busy = worker.Work();
+		PerfScope perf(_stats.writeProcessing.Perf());
+		OnWrite(static_cast<const uint8*>(write.Buffer), _inputFrameSize, write.Frame);
+		ReturnInputBuffer(write.Buffer);
 	}
 }
-void HailoAsyncProcessor::OnWrite(const cv::Mat &org_frame,size_t frame_size, FrameContext *frameId) {
+template<PixelFormat F>
+void* HailoAsyncProcessor::Preprocess(const FrameView<F> &frame, FrameContext *frameId) {
+	// Crop, resize and convert straight into the buffer handed to the device.
+	PerfScope perf(_stats.writeProcessing.Perf());
+	void* buffer = PageAlignedMemoryPool::Shared().Rent(_inputFrameSize);
+	auto dst = static_cast<uint8*>(buffer);
+	if (_resizeMode == ResizeMode::Letterbox)
+		frameId->Transform = InputTransform::LetterboxTo(frame, frameId->Roi, _inputSize, dst, PadColor(), ChannelOrder::Bgr, _interpolation);
+	else
+		frameId->Transform = InputTransform::StretchTo(frame, frameId->Roi, _inputSize, dst, ChannelOrder::Bgr, _interpolation);
+	return buffer;
+}
+void HailoAsyncProcessor::ReturnInputBuffer(void *buffer) {
+	PageAlignedMemoryPool::Shared().Return(buffer, _inputFrameSize);
+}
+void HailoAsyncProcessor::OnWrite(const uint8 *data, size_t frame_size, FrameContext *frameId) {
 	std::lock_guard<std::mutex> lock(this->_writeMx);
 	frameId->Iteration = this->_iteration++;
 	if(!this->_writeChannel.TryWrite(frameId)) {
 		this->OnFrameDrop(frameId);
+		_scheduler.Release();
 		return;
 	}
-	_input_vstream->write(MemoryView(org_frame.data, frame_size));
+	_backend->Write(data, frame_size);
 
-	this->_stats.writeProcessing.FrameProcessed(frameId->WriteWatch.Stop(),frameId->Iteration);
+	auto wt = frameId->WriteWatch.Stop();
+	this->_stats.writeProcessing.FrameProcessed(wt,frameId->Iteration);
+	Trace(TraceStage::Write, frameId, wt);
 	frameId->InterferenceAndReadWatch.Restart();
 }
 
@@ -156,334 +174,189 @@ void HailoAsyncProcessor::Write(const YuvFrame &frame,const FrameIdentifier &fra
 }
 
 void HailoAsyncProcessor::Write(const YuvFrame &frame, const cv::Rect &roi, const FrameIdentifier &frameId, float threshold) {
-	auto mat = frame.ToMatBgr(roi);
-	//PrintMatStat(mat);
-	FrameContext* info = new FrameContext(frameId, roi, threshold);
-	OnWrite(mat, info);
+	Write(frame.View(), roi, frameId, threshold);
 }
 
-void HailoAsyncProcessor::OnRead(int nr) {
-	unsigned long frame = 0;
-	auto max = _features.size();
-	auto feature = this->_features[nr];
-	auto &output_vstream = _vstreams.second[nr];
-	for (;this->_isRunning; frame++)
-	{
-		auto &buffer = feature->m_buffers.get_write_buffer();
-		//std::this_thread::sleep_for(200ms);
-		hailo_status status = HAILO_SUCCESS;
-		do {
-			status = output_vstream.read(MemoryView(buffer.data(), buffer.size()));
-		} while (status == HAILO_TIMEOUT && this->_isRunning);
-
-		if (!this->_isRunning) {
-			break;
-		}
-
-		feature->m_buffers.release_write_buffer();
-
-		if (status != HAILO_SUCCESS) {
-			std::string txt = hailo_get_status_message(status);
-			std::cout << "Status failed in read loop: " << txt << std::endl;
-		} else {
-#ifdef DEBUG
-			//std::cout << "Read completed. Output node: " << nr << " Frame: " << frame++ << std::endl;
-#endif
-			auto prv = this->_readOutputCounter.fetch_add(1);
-
-			if(prv == max-1) {
-				_readOutputCounter.fetch_sub(max);
-				//std::cout << "Read: " << frame << std::endl;
-				FrameContext* v;
-
-				if(_writeChannel.TryRead(v, 1s)) {
-					auto rt = v->InterferenceAndReadWatch.Stop();
-					_stats.readInterferenceProcessing.FrameProcessed(rt,v->Iteration);
-
-					if(!_postProcessingChannel.TryWrite(v)) {
-						_stats.postProcessing.FrameDropped(v->Iteration);
-					}
-				}
-				else throw std::runtime_error("Cannot read write channel.");
-			}
-		}
-	};
-	output_vstream.abort();
-	//std::cout << "Exiting read loop: " << nr << std::endl;
+void HailoAsyncProcessor::Write(const YuvFrame &frame, const cv::Rect &roi, const TileGrid &grid, const FrameIdentifier &frameId, float threshold) {
+	Write(frame.View(), roi, grid, frameId, threshold);
 }
-HailoTensorPtr PopProto(std::vector<HailoTensorPtr> &tensors){
-	auto it = tensors.begin();
-	while (it != tensors.end()) {
-		auto tensor = *it;
-		if (tensor->features() == 32 && tensor->height() == 160 && tensor->width() == 160){
-			auto proto = tensor;
-			tensors.erase(it);
-			return proto;
-		}
-		else{
-			++it;
-		}
+
+template<PixelFormat F>
+void HailoAsyncProcessor::Write(const FrameView<F> &frame, const cv::Rect &roi, const FrameIdentifier &frameId, float threshold) {
+	if (_scheduler.Throttled(frameId.CameraId))
+		return;
+	if (_admission.Decide(CurrentLoad(), 1) == AdmissionDecision::Drop) {
+		OnFrameDrop_OnAdmission(frameId.CameraId);
+		return;
 	}
-	return nullptr;
+	Schedule(frame, roi, frameId, threshold);
 }
-Quadruple GetBoxesScoreMask(std::vector<HailoTensorPtr> &tensors, int num_classes, int regression_length){
-
-    auto raw_proto = PopProto(tensors);
 
-    std::vector<HailoTensorPtr> outputs_boxes(tensors.size() / 3);
-    std::vector<HailoTensorPtr> outputs_masks(tensors.size() / 3);
-
-    // Prepare the scores xarray at the size we will fill in in-place
-    int total_scores = 0;
-    for (int i = 0; i < tensors.size(); i = i + 3) {
-        total_scores += tensors[i+1]->width() * tensors[i+1]->height();
-    }
-
-    std::vector<size_t> scores_shape = { (long unsigned int)total_scores, (long unsigned int)num_classes };
-
-    xt::xarray<float> scores(scores_shape);
-
-    std::vector<size_t> proto_shape = { {(long unsigned int)raw_proto->height(),
-                                                (long unsigned int)raw_proto->width(),
-                                                (long unsigned int)raw_proto->features()} };
-    xt::xarray<float> proto(proto_shape);
-
-    int view_index_scores = 0;
-
-    for (uint i = 0; i < tensors.size(); i = i + 3)
-    {
-        // Bounding boxes extraction will be done later on only on the boxes that surpass the score threshold
-        outputs_boxes[i / 3] = tensors[i];
-
-        // Extract and dequantize the scores outputs
-        auto dequantized_output_s = common::dequantize(common::get_xtensor(tensors[i+1]), tensors[i+1]->vstream_info().quant_info.qp_scale, tensors[i+1]->vstream_info().quant_info.qp_zp);
-        int num_proposals_scores = dequantized_output_s.shape(0)*dequantized_output_s.shape(1);
-
-        // From the layer extract the scores
-        auto output_scores = xt::view(dequantized_output_s, xt::all(), xt::all(), xt::all());
-        xt::view(scores, xt::range(view_index_scores, view_index_scores + num_proposals_scores), xt::all()) = xt::reshape_view(output_scores, {num_proposals_scores, num_classes});
-        view_index_scores += num_proposals_scores;
-
-        // Keypoints extraction will be done later according to the boxes that surpass the threshold
-        outputs_masks[i / 3] = tensors[i+2];
-    }
-
-    proto = common::dequantize(common::get_xtensor(raw_proto), raw_proto->vstream_info().quant_info.qp_scale, raw_proto->vstream_info().quant_info.qp_zp);
-
-    return Quadruple{outputs_boxes, scores, outputs_masks, proto};
+template<PixelFormat F>
+void HailoAsyncProcessor::Schedule(const FrameView<F> &frame, const cv::Rect &roi, const FrameIdentifier &frameId, float threshold) {
+	auto ticket = _scheduler.Admit(frameId.CameraId, 1);
+	FrameContext* info = FrameContext::Rent(frameId, roi, threshold);
+	info->Total.Start();
+	info->WriteWatch.Start();
+	Submit(ticket, info, Preprocess(frame, info));
 }
-std::vector<xt::xarray<double>> GetCenters(std::vector<int>& strides, std::vector<int>& network_dims,
-										std::size_t boxes_num, int strided_width, int strided_height){
-
-	std::vector<xt::xarray<double>> centers(boxes_num);
 
-	for (uint i=0; i < boxes_num; i++) {
-		strided_width = network_dims[0] / strides[i];
-		strided_height = network_dims[1] / strides[i];
-
-		// Create a meshgrid of the proper strides
-		xt::xarray<int> grid_x = xt::arange(0, strided_width);
-		xt::xarray<int> grid_y = xt::arange(0, strided_height);
-
-		auto mesh = xt::meshgrid(grid_x, grid_y);
-		grid_x = std::get<1>(mesh);
-		grid_y = std::get<0>(mesh);
-
-		// Use the meshgrid to build up box center prototypes
-		auto ct_row = (xt::flatten(grid_y) + 0.5) * strides[i];
-		auto ct_col = (xt::flatten(grid_x) + 0.5) * strides[i];
-
-		centers[i] = xt::stack(xt::xtuple(ct_col, ct_row, ct_col, ct_row), 1);
+template<PixelFormat F>
+void HailoAsyncProcessor::Write(const FrameView<F> &frame, const cv::Rect &roi, const TileGrid &grid, const FrameIdentifier &frameId, float threshold) {
+	auto tiles = grid.Tiles(roi);
+	if (tiles.empty() || _scheduler.Throttled(frameId.CameraId))
+		return;
+	// the frame is admitted, dropped or downscaled as a whole, never a subset of its tiles.
+	switch (_admission.Decide(CurrentLoad(), static_cast<uint32_t>(tiles.size()))) {
+		case AdmissionDecision::Drop:
+			OnFrameDrop_OnAdmission(frameId.CameraId);
+			return;
+		case AdmissionDecision::Downscale:
+			Schedule(frame, roi, frameId, threshold);
+			return;
+		default:
+			break;
 	}
-
-	return centers;
-}
-float DequantizeValue(uint8_t val, float32_t qp_scale, float32_t qp_zp){
-	return (float(val) - qp_zp) * qp_scale;
-}
-void DequantizeMaskValues(xt::xarray<float>& dequantized_outputs, int index,
-						xt::xarray<uint8_t>& quantized_outputs,
-						size_t dim1, float32_t qp_scale, float32_t qp_zp){
-	for (size_t i = 0; i < dim1; i++){
-		dequantized_outputs(i) = DequantizeValue(quantized_outputs(index, i), qp_scale, qp_zp);
+	auto ticket = _scheduler.Admit(frameId.CameraId, static_cast<uint32_t>(tiles.size()));
+	auto group = std::make_shared<TileGroup>(frameId, roi, threshold, static_cast<int>(tiles.size()), grid.MergeThreshold);
+
+	// Tile n+1 is preprocessed while the dispatcher transfers tile n, so the device is fed back-to-back.
+	for (auto &tile : tiles) {
+		FrameContext* info = FrameContext::Rent(frameId, tile, threshold);
+		info->Group = group;
+		info->Total.Start();
+		info->WriteWatch.Start();
+		Submit(ticket, info, Preprocess(frame, info));
 	}
 }
-void DequantizeBoxValues(xt::xarray<float>& dequantized_outputs, int index,
-						xt::xarray<uint8_t>& quantized_outputs,
-						size_t dim1, size_t dim2, float32_t qp_scale, float32_t qp_zp){
-	for (size_t i = 0; i < dim1; i++){
-		for (size_t j = 0; j < dim2; j++){
-			dequantized_outputs(i, j) = DequantizeValue(quantized_outputs(index, i, j), qp_scale, qp_zp);
-		}
+
+void HailoAsyncProcessor::OnTileCompleted(FrameContext *tile, SegmentationResult *result) {
+	auto context = tile->Group->Complete(result, tile->Iteration);
+	if (context != nullptr && context->Result == nullptr) {
+		// every tile was dropped.
+		OnFrameDrop(context);
+		return;
 	}
+	if (context != nullptr && !this->_callbackChannel.TryWrite(context))
+		this->_stats.callbackProcessing.FrameDropped(context->Iteration);
 }
-std::vector<std::pair<HailoDetection, xt::xarray<float>>> decode_boxes_and_extract_masks(std::vector<HailoTensorPtr> raw_boxes_outputs,
-                                                                                std::vector<HailoTensorPtr> raw_masks_outputs,
-                                                                                xt::xarray<float> scores,
-                                                                                std::vector<int> network_dims,
-                                                                                std::vector<int> strides,
-                                                                                int regression_length) {
-    int strided_width, strided_height, class_index;
-    std::vector<std::pair<HailoDetection, xt::xarray<float>>> detections_and_masks;
-    int instance_index = 0;
-    float confidence = 0.0;
-    std::string label;
-
-    auto centers = GetCenters(std::ref(strides), std::ref(network_dims), raw_boxes_outputs.size(), strided_width, strided_height);
-
-    // Box distribution to distance
-    auto regression_distance =  xt::reshape_view(xt::arange(0, regression_length + 1), {1, 1, regression_length + 1});
-
-    for (uint i = 0; i < raw_boxes_outputs.size(); i++)
-    {
-        // Boxes setup
-        float32_t qp_scale = raw_boxes_outputs[i]->vstream_info().quant_info.qp_scale;
-        float32_t qp_zp = raw_boxes_outputs[i]->vstream_info().quant_info.qp_zp;
-
-        auto output_b = common::get_xtensor(raw_boxes_outputs[i]);
-        int num_proposals = output_b.shape(0) * output_b.shape(1);
-        auto output_boxes = xt::view(output_b, xt::all(), xt::all(), xt::all());
-        xt::xarray<uint8_t> quantized_boxes = xt::reshape_view(output_boxes, {num_proposals, 4, regression_length + 1});
-
-        auto shape = {quantized_boxes.shape(1), quantized_boxes.shape(2)};
-
-        // Masks setup
-        float32_t qp_scale_mask = raw_masks_outputs[i]->vstream_info().quant_info.qp_scale;
-        float32_t qp_zp_mask = raw_masks_outputs[i]->vstream_info().quant_info.qp_zp;
-
-        auto output_m = common::get_xtensor(raw_masks_outputs[i]);
-        int num_proposals_masks = output_m.shape(0) * output_m.shape(1);
-        auto output_masks = xt::view(output_m, xt::all(), xt::all(), xt::all());
-        xt::xarray<uint8_t> quantized_masks = xt::reshape_view(output_masks, {num_proposals_masks, 32});
-
-        auto mask_shape = {quantized_masks.shape(1)};
-
-        // Bbox decoding
-        for (uint j = 0; j < num_proposals; j++) {
-            class_index = xt::argmax(xt::row(scores, instance_index))(0);
-            confidence = scores(instance_index, class_index);
-            instance_index++;
-            if (confidence < SCORE_THRESHOLD)
-                continue;
-
-            xt::xarray<float> box(shape);
-
-            DequantizeBoxValues(box, j, quantized_boxes,
-                                    box.shape(0), box.shape(1),
-                                    qp_scale, qp_zp);
-            common::softmax_2D(box.data(), box.shape(0), box.shape(1));
 
-            xt::xarray<float> mask(mask_shape);
-
-            DequantizeMaskValues(mask, j, quantized_masks,
-                                    mask.shape(0), qp_scale_mask,
-                                    qp_zp_mask);
-
-            auto box_distance = box * regression_distance;
-            xt::xarray<float> reduced_distances = xt::sum(box_distance, {2});
-            auto strided_distances = reduced_distances * strides[i];
-
-            // Decode box
-            auto distance_view1 = xt::view(strided_distances, xt::all(), xt::range(_, 2)) * -1;
-            auto distance_view2 = xt::view(strided_distances, xt::all(), xt::range(2, _));
-            auto distance_view = xt::concatenate(xt::xtuple(distance_view1, distance_view2), 1);
-            auto decoded_box = centers[i] + distance_view;
-
-            HailoBBox bbox(decoded_box(j, 0) / network_dims[0],
-                           decoded_box(j, 1) / network_dims[1],
-                           (decoded_box(j, 2) - decoded_box(j, 0)) / network_dims[0],
-                           (decoded_box(j, 3) - decoded_box(j, 1)) / network_dims[1]);
+void HailoAsyncProcessor::OnRead(int nr) {
+	const size_t size = _backend->OutputFrameSize(nr);
+	uint64_t frame = 0;
+	// waiting for a slot or for the device is idle time.
+	WorkerStats &worker = _stats.AddWorker(WorkerStage::Read);
+	while (this->_isRunning)
+	{
+		auto buffer = _tensors->AcquireWrite(nr, frame);
+		if (buffer == nullptr)
+			break;
+		// the transfer runs in the runtime's user space, the wait for the device in the kernel.
+		PerfScope perf(_stats.readInterferenceProcessing.Perf());
 
-            label = common::coco_eighty[class_index + 1];
-            HailoDetection detected_instance(bbox, class_index, label, confidence);
+		hailo_status status = HAILO_SUCCESS;
+		do {
+			status = _backend->Read(nr, buffer, size);
+		} while (status == HAILO_TIMEOUT && this->_isRunning);
 
-            detections_and_masks.push_back(std::make_pair(detected_instance, mask));
+		if (!this->_isRunning) {
+			break;
+		}
+		auto busy = worker.Work();
 
-        }
-    }
+		if (status != HAILO_SUCCESS) {
+			// nothing was delivered, the same slot is read again.
+			std::string txt = hailo_get_status_message(status);
+			std::cout << "Status failed in read loop: " << txt << std::endl;
+			continue;
+		}
 
-    return detections_and_masks;
-}
-float IouCalc(const HailoBBox &box_1, const HailoBBox &box_2)
-{
-	// Calculate IOU between two detection boxes
-	const float width_of_overlap_area = std::min(box_1.xmax(), box_2.xmax()) - std::max(box_1.xmin(), box_2.xmin());
-	const float height_of_overlap_area = std::min(box_1.ymax(), box_2.ymax()) - std::max(box_1.ymin(), box_2.ymin());
-	const float positive_width_of_overlap_area = std::max(width_of_overlap_area, 0.0f);
-	const float positive_height_of_overlap_area = std::max(height_of_overlap_area, 0.0f);
-	const float area_of_overlap = positive_width_of_overlap_area * positive_height_of_overlap_area;
-	const float box_1_area = (box_1.ymax() - box_1.ymin()) * (box_1.xmax() - box_1.xmin());
-	const float box_2_area = (box_2.ymax() - box_2.ymin()) * (box_2.xmax() - box_2.xmin());
-	// The IOU is a ratio of how much the boxes overlap vs their size outside the overlap.
-	// Boxes that are similar will have a higher overlap threshold.
-	return area_of_overlap / (box_1_area + box_2_area - area_of_overlap);
-}
-std::vector<std::pair<HailoDetection, xt::xarray<float>>> Nms(std::vector<std::pair<HailoDetection, xt::xarray<float>>> &detections_and_masks,
-															const float iou_thr, bool should_nms_cross_classes = false) {
-
-	std::vector<std::pair<HailoDetection, xt::xarray<float>>> detections_and_masks_after_nms;
-
-	for (uint index = 0; index < detections_and_masks.size(); index++)
-	{
-		if (detections_and_masks[index].first.get_confidence() != 0.0f)
-		{
-			for (uint jindex = index + 1; jindex < detections_and_masks.size(); jindex++)
-			{
-				if ((should_nms_cross_classes || (detections_and_masks[index].first.get_class_id() == detections_and_masks[jindex].first.get_class_id())) &&
-					detections_and_masks[jindex].first.get_confidence() != 0.0f)
-				{
-					// For each detection, calculate the IOU against each following detection.
-					float iou = IouCalc(detections_and_masks[index].first.get_bbox(), detections_and_masks[jindex].first.get_bbox());
-					// If the IOU is above threshold, then we have two similar detections,
-					// and want to delete the one.
-					if (iou >= iou_thr)
-					{
-						// The detections are arranged in highest score order,
-						// so we want to erase the latter detection.
-						detections_and_masks[jindex].first.set_confidence(0.0f);
-					}
-				}
+		int slot = _tensors->CompleteWrite(nr, frame++);
+		if (slot < 0)
+			continue;
+
+		// this output was the last one of the frame.
+		FrameContext* v;
+		if(_writeChannel.TryRead(v, 1s)) {
+			_scheduler.Release();
+			auto rt = v->InterferenceAndReadWatch.Stop();
+			_stats.readInterferenceProcessing.FrameProcessed(rt,v->Iteration);
+			Trace(TraceStage::InferenceAndRead, v, rt);
+			v->Slot = slot;
+
+			if(!_postProcessingChannel.TryWrite(v)) {
+				OnFrameDrop_OnPostProcess(v);
 			}
 		}
-	}
-	for (uint index = 0; index < detections_and_masks.size(); index++)
-	{
-		if (detections_and_masks[index].first.get_confidence() != 0.0f)
-		{
-			detections_and_masks_after_nms.push_back(std::make_pair(detections_and_masks[index].first, detections_and_masks[index].second));
+		else {
+			_tensors->Release(slot);
+			throw std::runtime_error("Cannot read write channel.");
 		}
-	}
-	return detections_and_masks_after_nms;
+	};
+	//std::cout << "Exiting read loop: " << nr << std::endl;
 }
-xt::xarray<float> dot(xt::xarray<float> mask, xt::xarray<float> reshaped_proto,
-					size_t proto_height, size_t proto_width, size_t mask_num = 32){
-
-	auto shape = {proto_height, proto_width};
-	xt::xarray<float> mask_product(shape);
-
-	for (size_t i = 0; i < mask_product.shape(0); i++) {
-		for (size_t j = 0; j < mask_product.shape(1); j++) {
-			for (size_t k = 0; k < mask_num; k++) {
-				mask_product(i,j) += mask(k) * reshaped_proto(k, i, j);
-			}
-		}
+// Proposals that survive NMS, highest score first, with their mask coefficients.
+void DecodeBoxes(const DecodePlan &plan, const std::vector<const uint8_t*> &outputs, Detections &detections) {
+	thread_local std::vector<Proposal> proposals;
+	thread_local BoxSet boxes;
+	thread_local std::vector<int> keep;
+	proposals.clear();
+	plan.Decode(outputs, SCORE_THRESHOLD, proposals);
+
+	boxes.Clear();
+	boxes.Reserve(proposals.size());
+	for (auto &p : proposals)
+		boxes.Add(p.XMin, p.YMin, p.XMin + p.Width, p.YMin + p.Height, p.Confidence, p.ClassId);
+	NmsOptions options;
+	options.Threshold = IOU_THRESHOLD;
+	options.Mode = NmsMode::CrossClass;
+	options.MaxDetections = MAX_DETECTIONS;
+	Nms::Run(boxes, options, keep);
+
+	// only the survivors get their coefficients gathered.
+	detections.Clear(plan.MaskCoefficients());
+	for (int k : keep) {
+		auto &p = proposals[k];
+		plan.Coefficients(outputs, p, detections.Add(p.XMin, p.YMin, p.Width, p.Height, p.Confidence, p.ClassId));
 	}
-	return mask_product;
 }
 void Sigmoid(float *data, const int size) {
 	for (int i = 0; i < size; i++)
-		data[i] = 1.0f / (1.0f + std::exp(-1.0 * data[i]));
-}
-cv::Mat Xarray2Mat(xt::xarray<float> xarr) {
-	cv::Mat mat (xarr.shape()[0], xarr.shape()[1], CV_32FC1, xarr.data(), 0);
-	return mat;
+		data[i] = 1.0f / (1.0f + std::exp(-data[i]));
+}
+// How the decoders hand masks over.
+struct MaskOptions {
+	MaskMode Mode;
+	MaskFormat Format;
+	// sigmoid(x) > t <=> x > logit(t), so Bits and Rle are thresholded on the logits.
+	float Logit;
+
+	MaskOptions(MaskMode mode, MaskFormat format, float threshold) : Mode(mode), Format(format) {
+		const float t = std::clamp(threshold, 1e-6f, 1.0f - 1e-6f);
+		Logit = std::log(t / (1.0f - t));
+	}
+	bool Thresholded() const { return Format == MaskFormat::Bits || Format == MaskFormat::Rle; }
+};
+// Upsampled mask -> the pixels the format stores: probabilities, 0..255 probabilities, or 0 / 255 for the thresholded formats.
+cv::Mat FinishMask(const cv::Mat &mask, const MaskOptions &options, Arena &arena) {
+	cv::Mat result = arena.Mat();
+	switch (options.Format) {
+	case MaskFormat::Probability:
+		mask.convertTo(result, CV_8UC1, 255.0);
+		return result;
+	case MaskFormat::Bits:
+	case MaskFormat::Rle:
+		cv::compare(mask, options.Logit, result, cv::CMP_GT);
+		return result;
+	default:
+		return mask;
+	}
 }
-
-cv::Mat CropMask(cv::Mat mask, HailoBBox box) {
-	auto x_min = box.xmin();
-	auto y_min = box.ymin();
-	auto x_max = box.xmax();
-	auto y_max = box.ymax();
+cv::Mat CropMask(cv::Mat mask, const cv::Rect2f &box) {
+	auto x_min = box.x;
+	auto y_min = box.y;
+	auto x_max = box.x + box.width;
+	auto y_max = box.y + box.height;
 
 	int rows = mask.rows;
 	int cols = mask.cols;
@@ -508,165 +381,231 @@ cv::Mat CropMask(cv::Mat mask, HailoBBox box) {
 
 	return mask;
 }
-std::vector<DetectionAndMask> decode_masks(std::vector<std::pair<HailoDetection, xt::xarray<float>>> detections_and_masks_after_nms,
-																		xt::xarray<float> proto, int org_image_height, int org_image_width){
-
-	std::vector<DetectionAndMask> detections_and_cropped_masks(detections_and_masks_after_nms.size(),
-																DetectionAndMask({
-																	HailoDetection(HailoBBox(0.0,0.0,0.0,0.0), "", 0.0),
-																	cv::Mat(org_image_height, org_image_width, CV_32FC1)}
-																	));
-
-	int mask_height = static_cast<int>(proto.shape(0));
-	int mask_width = static_cast<int>(proto.shape(1));
-	int mask_features = static_cast<int>(proto.shape(2));
-
-	auto reshaped_proto = xt::reshape_view(xt::transpose(xt::reshape_view(proto, {-1, mask_features}), {1,0}), {-1, mask_height, mask_width});
+void decode_masks(Detections &detections, const DecodePlan &plan, const float *proto, int org_image_height, int org_image_width, const MaskOptions &options, Arena &arena){
 
-	for (int i = 0; i < detections_and_masks_after_nms.size(); i++) {
+	const int mask_height = plan.ProtoHeight();
+	const int mask_width = plan.ProtoWidth();
+	const size_t mask_features = plan.MaskCoefficients();
+	const size_t pixels = static_cast<size_t>(mask_height) * mask_width;
+	const size_t count = detections.Size();
 
-		auto curr_detection = detections_and_masks_after_nms[i].first;
-		auto curr_mask = detections_and_masks_after_nms[i].second;
+	// every mask of the frame in one product: (detections x coefficients) * (coefficients x pixels).
+	auto products = static_cast<float*>(arena.allocate(count * pixels * sizeof(float), 64));
+	ArrayOperations::Gemm(detections.Coefficients.data(), proto, products, count, mask_features, pixels);
 
-		auto mask_product = dot(curr_mask, reshaped_proto, reshaped_proto.shape(1), reshaped_proto.shape(2), curr_mask.shape(0));
+	for (size_t i = 0; i < count; i++) {
+		float *product = products + i * pixels;
 
-		Sigmoid(mask_product.data(), mask_product.size());
+		if (!options.Thresholded())
+			Sigmoid(product, static_cast<int>(pixels));
 
-		cv::Mat mask = Xarray2Mat(mask_product).clone();
-		cv::resize(mask, mask, cv::Size(org_image_width, org_image_height), 0, 0, cv::INTER_LINEAR);
+		cv::Mat mask = arena.Mat();
+		cv::resize(cv::Mat(mask_height, mask_width, CV_32FC1, product), mask, cv::Size(org_image_width, org_image_height), 0, 0, cv::INTER_LINEAR);
 
-		mask = CropMask(mask, curr_detection.get_bbox());
-
-		detections_and_cropped_masks[i] = DetectionAndMask({curr_detection, mask});
+		detections.Masks.push_back(CropMask(FinishMask(mask, options, arena), detections.Box(i)));
+		detections.Offsets.emplace_back(0, 0);
 	}
-
-	return detections_and_cropped_masks;
 }
 
-std::vector<DetectionAndMask> yolov8segPostprocess(std::vector<HailoTensorPtr> &tensors,
-																				std::vector<int> network_dims,
-																				std::vector<int> strides,
-																				int regression_length,
-																				int num_classes,
-																				int org_image_height,
-																				int org_image_width) {
-	std::vector<DetectionAndMask> detections_and_cropped_masks;
-	if (tensors.size() == 0)
-	{
-		return detections_and_cropped_masks;
+// The pixels CropMask keeps: [ceil(min), ceil(max)) in both directions.
+cv::Rect MaskArea(const cv::Rect2f &box, int rows, int cols) {
+	int top = std::max(0, static_cast<int>(std::ceil(box.y * rows)));
+	int bottom = std::min(rows, static_cast<int>(std::ceil((box.y + box.height) * rows)));
+	int left = std::max(0, static_cast<int>(std::ceil(box.x * cols)));
+	int right = std::min(cols, static_cast<int>(std::ceil((box.x + box.width) * cols)));
+	return cv::Rect(left, top, std::max(0, right - left), std::max(0, bottom - top));
+}
+// Bilinear taps of dst pixels [start, start + count) resampled from srcSize, with the pixel centers of cv::resize.
+void LinearTaps(int start, int count, int srcSize, int dstSize, int *index, float *weight) {
+	const float scale = static_cast<float>(srcSize) / dstSize;
+	for (int i = 0; i < count; i++) {
+		float s = std::clamp((start + i + 0.5f) * scale - 0.5f, 0.0f, static_cast<float>(srcSize - 1));
+		index[i] = static_cast<int>(s);
+		weight[i] = s - index[i];
 	}
+}
+void decode_box_masks(Detections &detections, const DecodePlan &plan, const float *proto, int org_image_height, int org_image_width, const MaskOptions &options, Arena &arena){
 
-	Quadruple boxes_scores_masks_mask_matrix = GetBoxesScoreMask(tensors, num_classes, regression_length);
-
-	std::vector<HailoTensorPtr> raw_boxes = boxes_scores_masks_mask_matrix.boxes;
-	xt::xarray<float> scores = boxes_scores_masks_mask_matrix.scores;
-	std::vector<HailoTensorPtr> raw_masks = boxes_scores_masks_mask_matrix.masks;
-	xt::xarray<float> proto = boxes_scores_masks_mask_matrix.proto_data;
-
-	// Decode the boxes and get masks
-	auto detections_and_masks = decode_boxes_and_extract_masks(raw_boxes, raw_masks, scores, network_dims, strides, regression_length);
-
-	// Filter with NMS
-	auto detections_and_masks_after_nms = Nms(detections_and_masks, IOU_THRESHOLD, true);
+	const int mask_height = plan.ProtoHeight();
+	const int mask_width = plan.ProtoWidth();
+	const size_t mask_features = plan.MaskCoefficients();
+	const size_t pixels = static_cast<size_t>(mask_height) * mask_width;
 
-	// Decode the masking
-	auto detections_and_decoded_masks = decode_masks(detections_and_masks_after_nms, proto, org_image_height, org_image_width);
+	// a box spans the image at most.
+	std::pmr::vector<int> xs(org_image_width, &arena), ys(org_image_height, &arena);
+	std::pmr::vector<float> wx(org_image_width, &arena), wy(org_image_height, &arena);
 
-	return detections_and_decoded_masks;
+	for (size_t i = 0; i < detections.Size(); i++) {
+		cv::Rect area = MaskArea(detections.Box(i), org_image_height, org_image_width);
+		detections.Offsets.push_back(area.tl());
+		if (area.empty()) {
+			detections.Masks.emplace_back();
+			continue;
+		}
+		LinearTaps(area.x, area.width, mask_width, org_image_width, xs.data(), wx.data());
+		LinearTaps(area.y, area.height, mask_height, org_image_height, ys.data(), wy.data());
+
+		// only the prototype cells the box samples from are multiplied.
+		const int x0 = xs[0], x1 = std::min(xs[area.width - 1] + 1, mask_width - 1);
+		const int y0 = ys[0], y1 = std::min(ys[area.height - 1] + 1, mask_height - 1);
+		const int fw = x1 - x0 + 1;
+		const size_t cells = static_cast<size_t>(fw) * (y1 - y0 + 1);
+		auto footprint = static_cast<float*>(arena.allocate(cells * sizeof(float), 64));
+		for (int y = y0; y <= y1; y++)
+			ArrayOperations::Gemm(detections.CoefficientsOf(i), proto + static_cast<size_t>(y) * mask_width + x0, footprint + static_cast<size_t>(y - y0) * fw,
+				1, mask_features, fw, pixels, fw);
+		if (!options.Thresholded())
+			Sigmoid(footprint, static_cast<int>(cells));
+
+		// upsampled inside the box only.
+		cv::Mat mask = arena.Mat(area.size(), CV_32FC1);
+		for (int r = 0; r < area.height; r++) {
+			const float *top = footprint + static_cast<size_t>(ys[r] - y0) * fw;
+			const float *bottom = footprint + static_cast<size_t>(std::min(ys[r] + 1, mask_height - 1) - y0) * fw;
+			const float fy = wy[r];
+			float *dst = mask.ptr<float>(r);
+			for (int c = 0; c < area.width; c++) {
+				const int a = xs[c] - x0;
+				const int b = std::min(xs[c] + 1, mask_width - 1) - x0;
+				const float t = top[a] + (top[b] - top[a]) * wx[c];
+				const float u = bottom[a] + (bottom[b] - bottom[a]) * wx[c];
+				dst[c] = t + (u - t) * fy;
+			}
+		}
+		detections.Masks.push_back(FinishMask(mask, options, arena));
+	}
 }
 
-std::vector<cv::Mat> Yolov8(HailoROIPtr roi, int org_image_height, int org_image_width)
-{
-	// anchor params
-	int regression_length = 15;
-	std::vector<int> strides = {8, 16, 32};
-	std::vector<int> network_dims = {640, 640};
-
-	std::vector<HailoTensorPtr> tensors = roi->get_tensors();
-	auto filtered_detections_and_masks = yolov8segPostprocess(tensors,
-															network_dims,
-															strides,
-															regression_length,
-															NUM_CLASSES,
-															org_image_height,
-															org_image_width);
-
-	std::vector<HailoDetection> detections;
-	std::vector<cv::Mat> masks;
-
-	for (auto& det_and_msk : filtered_detections_and_masks){
-		detections.push_back(det_and_msk.detection);
-		masks.push_back(det_and_msk.mask);
-	}
+void yolov8segPostprocess(const DecodePlan &plan,
+						const std::vector<const uint8_t*> &outputs,
+						int org_image_height,
+						int org_image_width,
+						const MaskOptions &options,
+						Detections &detections,
+						Arena &arena) {
+	// Decode the boxes, filtered with NMS, and get masks
+	DecodeBoxes(plan, outputs, detections);
+	if (detections.Size() == 0)
+		return;
 
-	hailo_common::add_detections(roi, detections);
+	const size_t protoSize = static_cast<size_t>(plan.ProtoHeight()) * plan.ProtoWidth() * plan.MaskCoefficients();
+	auto proto = static_cast<float*>(arena.allocate(protoSize * sizeof(float), 64));
+	plan.Prototype(outputs, proto);
 
-	return masks;
+	// Decode the masking
+	if (options.Mode == MaskMode::Box)
+		decode_box_masks(detections, plan, proto, org_image_height, org_image_width, options, arena);
+	else
+		decode_masks(detections, plan, proto, org_image_height, org_image_width, options, arena);
 }
 
-std::vector<cv::Mat> Filter(HailoROIPtr roi, int org_image_height, int org_image_width)
+void Filter(const DecodePlan &plan, const std::vector<const uint8_t*> &outputs, int org_image_height, int org_image_width, const MaskOptions &options, Detections &detections, Arena &arena)
 {
-	return Yolov8(roi, org_image_height, org_image_width);
+	yolov8segPostprocess(plan, outputs, org_image_height, org_image_width, options, detections, arena);
 }
 void HailoAsyncProcessor::PostProcess() {
 
 	FrameContext *context;
+	// reused by every frame of this thread.
+	Detections detections;
+	std::vector<const uint8_t*> outputs(_backend->OutputCount());
+	// the frame's temporaries, released when its detections were handed over.
+	Arena arena(POST_PROCESSING_ARENA_SIZE, &_stats.postProcessingArena);
+	const LabelTable &labels = LabelTable::Coco();
+	WorkerStats &worker = _stats.AddWorker(WorkerStage::PostProcessing);
 	while(this->_postProcessingChannel.TryRead(context, 10s))
 	{
+		auto busy = worker.Work();
+		PerfScope perf(_stats.postProcessing.Perf());
 		context->PostProcessingWatch.Start();
 		auto& iteration = context->Iteration;
 
-		//auto *s = new SegmentationResult(context->Id, context->Roi);
-		auto result = make_unique<SegmentationResult>(context->Id, context->Roi, context->Threshold);
-		//auto result = unique_ptr<SegmentationResult>(s);
-		std::sort(_features.begin(), _features.end(), &FeatureData<uint8>::sort_tensors_by_size);
-		HailoROIPtr roi = std::make_shared<HailoROI>(HailoROI(HailoBBox(0.0f, 0.0f, 1.0f, 1.0f)));
+		auto result = SegmentationResult::Rent(context->Id, context->Roi, context->Threshold);
+		for (size_t i = 0; i < outputs.size(); i++)
+			outputs[i] = _tensors->Buffer(context->Slot, i);
 
-		for (uint j = 0; j < _features.size(); j++) {
-			roi->add_tensor(std::make_shared<HailoTensor>(
-				reinterpret_cast<uint8 *>(_features[j]->m_buffers.get_read_buffer().data()), _features[j]->m_vstream_info));
-		}
+		// masks come back at the model input resolution.
+		const MaskOptions options(_maskMode, _maskFormat, _maskThreshold);
+		Filter(_plan, outputs, _inputSize.height, _inputSize.width, options, detections, arena);
 
-		// not sure why we filter here.
-		auto filtered_masks = Filter(roi,640,640);
-
-		for (auto &feature: _features) {
-			feature->m_buffers.release_read_buffer();
-		}
-
-		std::vector<HailoDetectionPtr> detections = hailo_common::get_hailo_detections(roi);
+		// the slot is free for the reader threads as soon as the tensors are decoded.
+		_tensors->Release(context->Slot);
+		context->Slot = -1;
 
 
-		for (size_t i = 0; i < filtered_masks.size(); ++i)
+		const InputTransform& transform = context->Transform;
+		const bool letterboxed = transform.Content.size() != _inputSize;
+		const cv::Size resolution = letterboxed ? transform.Content.size() : _inputSize;
+		for (size_t i = 0; i < detections.Size(); i++)
 		{
-			cv::Mat& mask = filtered_masks[i];
-			auto &detection = detections[i];
-			if(detection->get_confidence() >= context->Threshold) {
-				HailoBBox bbox = detection->get_bbox();
-				Rect2f roiBox(bbox.xmin(), bbox.ymin(), bbox.width(), bbox.height());
-				result->Add(mask, detection->get_class_id(), mask.size(),roiBox, detection->get_confidence(), detection->get_label());
+			cv::Mat& mask = detections.Masks[i];
+			cv::Point& offset = detections.Offsets[i];
+			const float confidence = detections.Confidence[i];
+			const int classId = detections.ClassId[i];
+			if(confidence >= context->Threshold) {
+				Rect2f roiBox = detections.Box(i);
+				if (letterboxed) {
+					// drop the padding, so mask pixels map linearly onto the ROI. Add copies the view.
+					cv::Rect area = cv::Rect(offset, mask.size()) & transform.Content;
+					mask = area.empty() ? cv::Mat() : mask(area - offset);
+					offset = area.empty() ? cv::Point() : area.tl() - transform.Content.tl();
+					roiBox = transform.ToContent(roiBox, _inputSize);
+				}
+				result->Add(mask, classId, resolution, roiBox, confidence, labels[classId].c_str(), transform, offset, options.Format);
 			}
 			else result->IncrementUncertainCounter();
 
 		}
+		// the result holds copies, the masks go with the arena.
+		detections.Masks.clear();
+		arena.Reset();
 		auto t = context->PostProcessingWatch.Stop();
 		this->_stats.postProcessing.FrameProcessed(t, context->Iteration);
-		context->Result = result.release();
+		Trace(TraceStage::PostProcessing, context, t);
+		if (context->Group) {
+			auto tt = context->Total.Stop();
+			this->_stats.tileProcessing.FrameProcessed(tt, context->Iteration);
+			Trace(TraceStage::Tile, context, tt);
+			OnTileCompleted(context, result);
+			FrameContext::Return(context);
+			continue;
+		}
+		context->Result = result;
 		if(!this->_callbackChannel.TryWrite(context))
 			this->_stats.callbackProcessing.FrameDropped(context->Iteration);
 	};
 }
 void HailoAsyncProcessor::OnFrameDrop(FrameContext * ptr) {
 	if(ptr != nullptr) {
-		if(ptr->Result != nullptr)
-			delete ptr->Result;
-		delete ptr;
+		if(!ptr->Group)
+			_scheduler.FrameDropped(ptr->Id.CameraId);
+		if(ptr->Slot >= 0)
+			_tensors->Release(ptr->Slot);
+		if(ptr->Group) {
+			// the frame still completes with whatever the other tiles found.
+			_stats.tileProcessing.FrameDropped(ptr->Iteration);
+			OnTileCompleted(ptr, nullptr);
+		}
+		SegmentationResult::Return(ptr->Result);
+		FrameContext::Return(ptr);
 	}
 }
 void HailoAsyncProcessor::OnFrameDrop_OnWrite(FrameContext * ptr) {
 	_stats.writeProcessing.FrameDropped(ptr->Iteration);
 	OnFrameDrop(ptr);
 }
+void HailoAsyncProcessor::OnFrameDrop_OnSchedule(const ScheduledWrite &write) {
+	// never written, so it has no iteration of its own.
+	write.Frame->Iteration = _stats.writeProcessing.LastIteration();
+	_stats.writeProcessing.FrameDropped(write.Frame->Iteration);
+	ReturnInputBuffer(write.Buffer);
+	OnFrameDrop(write.Frame);
+}
+void HailoAsyncProcessor::OnFrameDrop_OnAdmission(uint32_t cameraId) {
+	_stats.writeProcessing.FrameDropped(_stats.writeProcessing.LastIteration());
+	// never admitted to the scheduler, so no context reaches OnFrameDrop to count it for the camera.
+	_scheduler.FrameDropped(cameraId);
+}
 void HailoAsyncProcessor::OnFrameDrop_OnRead(FrameContext * ptr) {
 	_stats.readInterferenceProcessing.FrameDropped(ptr->Iteration);
 	OnFrameDrop(ptr);
@@ -681,14 +620,16 @@ void HailoAsyncProcessor::OnFrameDrop_OnCallback(FrameContext * ptr) {
 }
 
 using namespace boost::placeholders;
-HailoAsyncProcessor::HailoAsyncProcessor(std::unique_ptr<VDevice> &dev, std::shared_ptr<ConfiguredNetworkGroup> networkGroup) :
-_dev(std::move(dev)),
+HailoAsyncProcessor::HailoAsyncProcessor(unique_ptr<InferenceBackend> backend) :
+_backend(std::move(backend)),
 _callbackChannel(2, DiscardPolicy::Oldest),
 _callback(nullptr),
 _context(nullptr),
 _postProcessingChannel(4, DiscardPolicy::Oldest),
 _readChannel(2, DiscardPolicy::Oldest),
-_writeChannel(2, DiscardPolicy::Oldest),
+_writeChannel(DEVICE_SLOTS, DiscardPolicy::Oldest),
+_scheduler(DEVICE_SLOTS),
+_admission(_stats, DEVICE_SLOTS),
 _isRunning(false),
 _stats(1,1,1,1,4)
 {
@@ -696,45 +637,24 @@ _stats(1,1,1,1,4)
 	_writeChannel.connectDropped(boost::bind(&HailoAsyncProcessor::OnFrameDrop_OnWrite, this, _1));
 	_postProcessingChannel.connectDropped(boost::bind(&HailoAsyncProcessor::OnFrameDrop_OnPostProcess, this, _1));
 	_callbackChannel.connectDropped(boost::bind(&HailoAsyncProcessor::OnFrameDrop_OnCallback, this, _1));
+	_scheduler.connectDropped(boost::bind(&HailoAsyncProcessor::OnFrameDrop_OnSchedule, this, _1));
 
 
-	Expected<std::pair<std::vector<InputVStream>, std::vector<OutputVStream> > > vstreams_exp =
-			VStreamsBuilder::create_vstreams(*networkGroup, QUANTIZED, FORMAT_TYPE);
-	if (!vstreams_exp) throw HailoException(vstreams_exp.status());
-
-	this->_vstreams = vstreams_exp.release();
-	this->_input_vstream = &_vstreams.first[0];
-
-	std::vector<OutputVStream>& output_vstreams = _vstreams.second;
-
-	cout << "Input vstream at: " << _input_vstream << endl;
-
-	hailo_status status = HAILO_UNINITIALIZED;
+	auto input_shape = _backend->InputInfo().shape;
+	this->_inputSize = cv::Size(input_shape.width, input_shape.height);
+	this->_inputFrameSize = _backend->InputFrameSize();
 
-	std::string model_type = "";
-
-	auto output_vstreams_size = output_vstreams.size();
-
-	bool nms_on_hailo = false;
-	std::string output_name = (std::string)output_vstreams[0].get_info().name;
-	if (output_vstreams_size == 1 && (output_name.find("nms") != std::string::npos)) {
-		nms_on_hailo = true;
-		model_type = output_name.substr(0, output_name.find('/'));
-	}
-
-	_features.reserve(output_vstreams_size);
-
-	for (size_t i = 0; i < output_vstreams_size; i++)
-	{
-		auto feature = this->CreateFeature(output_vstreams[i].get_info(), output_vstreams[i].get_frame_size());
-		_features.emplace_back(feature);
-	}
+	this->_plan = DecodePlan(*_backend, NUM_CLASSES, REGRESSION_LENGTH);
 
 }
 void HailoAsyncProcessor::StartAsync(unsigned int postProcessThreadCount)
 {
-	std::vector<OutputVStream>& output_vstreams = _vstreams.second;
-	auto output_vstreams_size = output_vstreams.size();
+	auto output_vstreams_size = _backend->OutputCount();
+	// one slot per post-processing worker, plus two being filled by the readers.
+	std::vector<size_t> frameSizes;
+	for (size_t i = 0; i < output_vstreams_size; i++)
+		frameSizes.push_back(_backend->OutputFrameSize(i));
+	_tensors = std::make_unique<TensorRing>(postProcessThreadCount + 2, frameSizes);
 	this->_isRunning = true;
 	for (size_t i = 0; i < output_vstreams_size; i++) {
 		//std::async(std::launch::async, &HailoAsyncProcessor::OnRead, this, i);
@@ -742,6 +662,7 @@ void HailoAsyncProcessor::StartAsync(unsigned int postProcessThreadCount)
 		_threads.emplace_back(std::thread(&HailoAsyncProcessor::OnRead, this, i));
 	}
 	_stats.readInterferenceProcessing.SetThreadCount(output_vstreams_size);
+	_threads.emplace_back(std::thread(&HailoAsyncProcessor::OnDispatch, this));
 	// Create the postprocessing thread
 	//std::async(std::launch::async, &HailoAsyncProcessor::PostProcess, this);
 	for(int i = 0; i < postProcessThreadCount; i++)
@@ -756,20 +677,32 @@ void HailoAsyncProcessor::StartAsync(unsigned int postProcessThreadCount)
 	//std::thread(&HailoAsyncProcessor::OnCallback, this).detach();
 }
 void HailoAsyncProcessor::OnCallback() {
-
+	WorkerStats &worker = _stats.AddWorker(WorkerStage::Callback);
 	while (_isRunning) {
 		FrameContext* value;
 		//unique_ptr<SegmentationResult> value;
 		if (_callbackChannel.TryRead(value, 5s)) {
+			auto busy = worker.Work();
+			PerfScope perf(_stats.callbackProcessing.Perf());
 			StopWatch sw = StopWatch::StartNew();
 			if (_callback && value != nullptr) // nullptr is important because of Dispose.
 			{
 				_callback(value->Result, _context);
-				_stats.callbackProcessing.FrameProcessed(sw.Stop(), value->Iteration);
-				_stats.totalProcessing.FrameProcessed(value->Total.Stop(),value->Iteration);
+				auto ct = sw.Stop();
+				_stats.callbackProcessing.FrameProcessed(ct, value->Iteration);
+				Trace(TraceStage::Callback, value, ct);
+				auto total = value->Total.Stop();
+				_stats.totalProcessing.FrameProcessed(total,value->Iteration);
+				Trace(TraceStage::Total, value, total);
+				_scheduler.FrameCompleted(value->Id.CameraId, total);
+				// the result is the callback's now, it gives it back with segmentation_result_dispose.
+				value->Result = nullptr;
+				FrameContext::Return(value);
+			}
+			else if(value != nullptr) {
+				SegmentationResult::Return(value->Result);
+				FrameContext::Return(value);
 			}
-			else if(value != nullptr)
-				delete value;
 		}
 		else { // this should only happen when time-out happens.
 			std::this_thread::yield();  // Yield to allow other threads to run
@@ -792,9 +725,69 @@ void HailoAsyncProcessor::ConfidenceThreshold(float value) {
 	_threshold = value;
 }
 
+int HailoAsyncProcessor::Interpolation() {
+	return _interpolation;
+}
+
+void HailoAsyncProcessor::Interpolation(int value) {
+	_interpolation = value;
+}
+
+ResizeMode HailoAsyncProcessor::Resizing() {
+	return _resizeMode;
+}
+
+void HailoAsyncProcessor::Resizing(ResizeMode value) {
+	_resizeMode = value;
+}
+
+RgbColor HailoAsyncProcessor::PadColor() {
+	uint32_t c = _padColor;
+	return RgbColor{ static_cast<uint8_t>(c >> 16), static_cast<uint8_t>(c >> 8), static_cast<uint8_t>(c) };
+}
+
+void HailoAsyncProcessor::PadColor(const RgbColor& value) {
+	_padColor = (static_cast<uint32_t>(value.r) << 16) | (static_cast<uint32_t>(value.g) << 8) | value.b;
+}
+
+MaskMode HailoAsyncProcessor::Masking() {
+	return _maskMode;
+}
+
+void HailoAsyncProcessor::Masking(MaskMode value) {
+	_maskMode = value;
+}
+MaskFormat HailoAsyncProcessor::MaskFormatting() {
+	return _maskFormat;
+}
+void HailoAsyncProcessor::MaskFormatting(MaskFormat value) {
+	_maskFormat = value;
+}
+float HailoAsyncProcessor::MaskThreshold() {
+	return _maskThreshold;
+}
+void HailoAsyncProcessor::MaskThreshold(float value) {
+	_maskThreshold = value;
+}
+CameraConfig HailoAsyncProcessor::Camera(uint32_t cameraId) {
+	return _scheduler.Config(cameraId);
+}
+void HailoAsyncProcessor::Camera(uint32_t cameraId, const CameraConfig& value) {
+	_scheduler.Configure(cameraId, value);
+}
+
 void HailoAsyncProcessor::Deallocate() {
-	// should we delete the ptr?
-	this->_dev.release();
+	// the workers use the backend until they are joined.
+	if (this->_isRunning)
+		Stop();
+	this->_backend.reset();
 }
 
+#define INSTANTIATE_WRITE(F) \
+	template void HailoAsyncProcessor::Write<F>(const FrameView<F>&, const cv::Rect&, const FrameIdentifier&, float); \
+	template void HailoAsyncProcessor::Write<F>(const FrameView<F>&, const cv::Rect&, const TileGrid&, const FrameIdentifier&, float);
 
+INSTANTIATE_WRITE(PixelFormat::I420)
+INSTANTIATE_WRITE(PixelFormat::NV12)
+INSTANTIATE_WRITE(PixelFormat::YUYV)
+INSTANTIATE_WRITE(PixelFormat::I422)
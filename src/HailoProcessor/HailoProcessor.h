@@ -6,6 +6,8 @@
 #include "common.h"
 #include "Export.h"
 #include "Frame.h"
+#include "Preprocessor.h"
+#include "Tiling.h"
 #include "Notifier.h"
 #include "StopWatch.h"
 #include <barrier>
@@ -30,6 +32,12 @@
 #include "HailoProcessorStats.h"
 #include "StageStats.h"
 #include "HailoException.h"
+#include "InferenceBackend.h"
+#include "TensorRing.h"
+#include "DecodePlan.h"
+#include "CameraScheduler.h"
+#include "AdmissionController.h"
+#include "Tracer.h"
 
 using namespace std;
 using namespace cv;
@@ -52,27 +60,71 @@ private:
 class HailoAsyncProcessor {
 public:
 	static unique_ptr<HailoAsyncProcessor> Load(const string& fileName);
+	// Runs the pipeline on any backend, e.g. a ReplayBackend when there is no device.
+	static unique_ptr<HailoAsyncProcessor> Load(unique_ptr<InferenceBackend> backend);
 
 	// this method would push mat object on the queue.
 
 	void Write(const YuvFrame &frame, const FrameIdentifier &frameId);
 	void Write(const YuvFrame &frame, const cv::Rect &roi, const FrameIdentifier &frameId, float threshold);
+	// Runs the model on every tile of the grid over roi; the callback fires once with the merged result.
+	void Write(const YuvFrame &frame, const cv::Rect &roi, const TileGrid &grid, const FrameIdentifier &frameId, float threshold);
+	// Same as above for frames in any PixelFormat, read in place through per-plane pointers and strides.
+	template<PixelFormat F>
+	void Write(const FrameView<F> &frame, const cv::Rect &roi, const FrameIdentifier &frameId, float threshold);
+	template<PixelFormat F>
+	void Write(const FrameView<F> &frame, const cv::Rect &roi, const TileGrid &grid, const FrameIdentifier &frameId, float threshold);
 	void StartAsync(unsigned int postProcessThreadCount);
 	void StartAsync(CallbackWithContext callback, void * context);
 
 	float ConfidenceThreshold();
 	void ConfidenceThreshold(float value);
+	// cv::INTER_LINEAR (default) or cv::INTER_AREA, used when the ROI is scaled to the network input.
+	int Interpolation();
+	void Interpolation(int value);
+	// Stretch (default) or Letterbox. Results are mapped back to frame pixels either way, see Segment::Transform.
+	ResizeMode Resizing();
+	void Resizing(ResizeMode value);
+	// Color of the letterbox bars, YOLO's gray (114, 114, 114) by default.
+	RgbColor PadColor();
+	void PadColor(const RgbColor& value);
+	// Full (default) or Box. Box-local masks cover only the detection box, see Segment::MaskRect.
+	MaskMode Masking();
+	void Masking(MaskMode value);
+	// Float (default), Probability, Bits or Rle. The compact formats shrink results and the copy to managed code.
+	MaskFormat MaskFormatting();
+	void MaskFormatting(MaskFormat value);
+	// Probability above which a pixel is foreground in the Bits and Rle formats, 0.5 by default.
+	float MaskThreshold();
+	void MaskThreshold(float value);
+	// Priority class, share of the device, fps cap and queue depth of one camera; cameras not configured get the defaults.
+	CameraConfig Camera(uint32_t cameraId);
+	void Camera(uint32_t cameraId, const CameraConfig& value);
+	// Releases the device, stopping first if running; the processor cannot be started again.
 	void Deallocate();
 	void Stop();
 
 	HailoProcessorStats& Stats();
+	CameraScheduler& Scheduler();
+	// Admit, drop or downscale per frame, off by default.
+	AdmissionController& Admission();
+	// Depths of the queues between the stages, as they are now.
+	void Snapshot(HailoProcessorStatsExDto::QueuesDto& dto);
+	// Per-frame stage spans, off by default.
+	Tracer& Tracing();
 
 private:
 
-	static std::shared_ptr<ConfiguredNetworkGroup> ConfigureNetworkGroup(VDevice &vdevice, const std::string &yolov_hef);
-	static std::shared_ptr<FeatureData<uint8>> CreateFeature(const hailo_vstream_info_t &vstream_info, size_t frameSize);
-	void OnWrite(const cv::Mat &frame, FrameContext* frameInfo);
-	void OnWrite(const cv::Mat &org_frame, size_t frame_size, FrameContext *frameId);
+	template<PixelFormat F>
+	void Schedule(const FrameView<F> &frame, const cv::Rect &roi, const FrameIdentifier &frameId, float threshold);
+	void Submit(const CameraScheduler::Ticket &ticket, FrameContext *frameId, void *buffer);
+	PipelineLoad CurrentLoad();
+	void OnDispatch();
+	void OnWrite(const uint8 *data, size_t frame_size, FrameContext *frameId);
+	template<PixelFormat F>
+	void* Preprocess(const FrameView<F> &frame, FrameContext *frameId);
+	void ReturnInputBuffer(void *buffer);
+	void OnTileCompleted(FrameContext *tile, SegmentationResult *result);
 
 	void OnFrameDrop(FrameContext *ptr);
 	void OnRead(int nr);
@@ -80,26 +132,39 @@ private:
 
 	void OnFrameDrop_OnWrite(FrameContext *ptr);
 
+	void OnFrameDrop_OnSchedule(const ScheduledWrite &write);
+
+	void OnFrameDrop_OnAdmission(uint32_t cameraId);
+
 	void OnFrameDrop_OnRead(FrameContext *ptr);
 
 	void OnFrameDrop_OnPostProcess(FrameContext *ptr);
 
 	void OnFrameDrop_OnCallback(FrameContext *ptr);
 
+	void Trace(TraceStage stage, const FrameContext *context, std::chrono::nanoseconds duration);
+
 	void OnCallback();
-	std::vector<std::shared_ptr<FeatureData<uint8>>> _features;
+	DecodePlan _plan;
+	unique_ptr<TensorRing> _tensors;
 	std::vector<std::thread> _threads;
 	volatile bool _isRunning;
-	std::atomic_int _readOutputCounter;
-	//std::atomic_int _readOutputCounter;
 	std::mutex _writeMx;
 	uint64_t _iteration;
 	float _threshold = 0.8f;
+	std::atomic_int _interpolation = INTER_LINEAR;
+	std::atomic<ResizeMode> _resizeMode = ResizeMode::Stretch;
+	std::atomic_uint32_t _padColor = 0x727272;
+	std::atomic<MaskMode> _maskMode = MaskMode::Full;
+	std::atomic<MaskFormat> _maskFormat = MaskFormat::Float;
+	std::atomic<float> _maskThreshold = 0.5f;
+	cv::Size _inputSize;
+	size_t _inputFrameSize;
 	HailoProcessorStats _stats;
-	unique_ptr<VDevice> _dev;
-	pair<vector<InputVStream>, vector<OutputVStream>> _vstreams;
-	InputVStream* _input_vstream;
-
+	unique_ptr<InferenceBackend> _backend;
+	CameraScheduler _scheduler;
+	AdmissionController _admission;
+	Tracer _tracer;
 
 	Channel<FrameContext*> _writeChannel;
 	Channel<FrameContext*> _readChannel;
@@ -109,7 +174,7 @@ private:
 	CallbackWithContext _callback;
 	void *_context;
 
-	HailoAsyncProcessor(std::unique_ptr<VDevice> &dev, std::shared_ptr<ConfiguredNetworkGroup> networkGroup);
+	HailoAsyncProcessor(unique_ptr<InferenceBackend> backend);
 };
 
 
@@ -79,7 +79,7 @@ unique_ptr<SegmentationResult> HailoProcessor::ProcessFrame(const YuvFrame& fram
 		const auto& quant = _model->output(output_name)->get_quant_infos()[0];
 		const auto& shape = _model->output(output_name)->shape();
 		const auto& format = _model->output(output_name)->format();
-		OutTensor& t = outputNodes.emplace_back(_allocator, output_name, quant, shape, format, output_size);
+		OutTensor& t = outputNodes.emplace_back(output_name, quant, shape, format, output_size);
 
 		status = _bindings.output(output_name)->set_buffer(MemoryView(t.data.get(), output_size));
 		if (status != HAILO_SUCCESS) throw HailoException(status);
@@ -55,7 +55,6 @@ private:
     shared_ptr<ConfiguredInferModel> _configured_infer_model;
     ConfiguredInferModel::Bindings _bindings;
     size_t _input_frame_size;
-    shared_ptr<PageAlignedMemoryPool> _allocator = make_shared<PageAlignedMemoryPool>();
     float _confidenceThreshold = 0.8f;
     ArrayMemoryPool<float> _floatPool;
     ArrayMemoryPool<uint8> _bytePool;
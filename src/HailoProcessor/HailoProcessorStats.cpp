@@ -7,6 +7,7 @@
 #include <string>
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
 
 
 HailoProcessorStats::HailoProcessorStats(int writeThreadCount, int readInterferenceThreadCount,
@@ -26,11 +27,62 @@ unsigned long HailoProcessorStats::InFlight() const {
 unsigned long HailoProcessorStats::Dropped()  const{
     return writeProcessing.Dropped() + readInterferenceProcessing.Dropped() + postProcessing.Dropped() + callbackProcessing.Dropped();
 }
+WorkerStats::BusyScope WorkerStats::Work() {
+    const auto now = std::chrono::steady_clock::now();
+    IdleTime.fetch_add((now - _mark).count(), std::memory_order_relaxed);
+    _mark = now;
+    return BusyScope(*this);
+}
+
+void WorkerStats::EndBusy() {
+    const auto now = std::chrono::steady_clock::now();
+    const auto busy = (now - _mark).count();
+    BusyTime.fetch_add(busy, std::memory_order_relaxed);
+    // a long item counts to the second it ended in; Utilization caps the share at 1.
+    Busy.Add(WindowedCounter::Now(), busy);
+    _mark = now;
+}
+
+float WorkerStats::Utilization(std::chrono::seconds window) const {
+    const int seconds = std::clamp<int>(static_cast<int>(window.count()), 1, WindowedCounter::MaxWindow);
+    const double busy = static_cast<double>(Busy.Sum(WindowedCounter::Now(), seconds));
+    return static_cast<float>(std::min(1.0, busy / (seconds * 1e9)));
+}
+
+void WorkerStats::Start(WorkerStage stage, uint32_t index) {
+    Stage = stage;
+    Index = index;
+    _mark = std::chrono::steady_clock::now();
+}
+
+WorkerStats& HailoProcessorStats::AddWorker(WorkerStage stage) {
+    std::lock_guard<std::mutex> lock(_workersMx);
+    WorkerStats& worker = _workers.emplace_back();
+    worker.Start(stage, _stageWorkers[static_cast<int>(stage)]++);
+    return worker;
+}
+
+size_t HailoProcessorStats::Workers(HailoProcessorStatsExDto::WorkerStatsDto* dst, size_t capacity) {
+    std::lock_guard<std::mutex> lock(_workersMx);
+    for (size_t i = 0; i < _workers.size() && i < capacity; i++) {
+        const WorkerStats& worker = _workers[i];
+        auto& dto = dst[i];
+        dto.stage = static_cast<int>(worker.Stage);
+        dto.index = worker.Index;
+        dto.busyTime = worker.BusyTime.load(std::memory_order_relaxed);
+        dto.idleTime = worker.IdleTime.load(std::memory_order_relaxed);
+        dto.utilization1s = worker.Utilization(std::chrono::seconds(1));
+        dto.utilization10s = worker.Utilization(std::chrono::seconds(10));
+        dto.utilization60s = worker.Utilization(std::chrono::seconds(60));
+    }
+    return _workers.size();
+}
+
 void HailoProcessorStats::Print2() {
-    std::cout << "| Stage                    | Processed | Dropped | Behind | Threads | Est.FPS | Avg. Time (ms) |\n";
-    std::cout << "|--------------------------|-----------|---------|--------|---------|---------|----------------|\n";
+    std::cout << "| Stage                    | Processed | Dropped | Behind | Threads | FPS 1s  | FPS 10s | FPS 60s | Avg. Time (ms) | P99 (ms) |\n";
+    std::cout << "|--------------------------|-----------|---------|--------|---------|---------|---------|---------|----------------|----------|\n";
 
-    auto printStage = [this](const char* name, const StageStats& stats, unsigned long* dropped = nullptr) {
+    auto printStage = [this](const char* name, StageStats& stats, unsigned long* dropped = nullptr) {
         std::cout << "| " << std::left << std::setw(24) << name << " | ";
         std::cout << std::right << std::setw(9) << stats.Processed() << " | ";
 
@@ -41,10 +93,13 @@ void HailoProcessorStats::Print2() {
 
         std::cout << std::right << std::setw(6) << stats.Behind() << " | "; // New column for Behind
         std::cout << std::right << std::setw(7) << stats.ThreadCount() << " | ";
-        float fps = stats.Fps();
         std::chrono::milliseconds avgTime = stats.FrameProcessingTime();
-        std::cout << std::right << std::setw(7) << std::fixed << std::setprecision(2) << fps << " | ";
-        std::cout << std::right << std::setw(14) << avgTime.count() << " |" << std::endl;
+        for (auto window : {std::chrono::seconds(1), std::chrono::seconds(10), std::chrono::seconds(60)})
+            std::cout << std::right << std::setw(7) << std::fixed << std::setprecision(2) << stats.ProcessedRate(window) << " | ";
+        std::cout << std::right << std::setw(14) << avgTime.count() << " | ";
+        LatencyHistogram::Snapshot latency;
+        stats.Latency().Merge(latency);
+        std::cout << std::right << std::setw(8) << latency.Percentile(0.99).count() * 1e-6 << " |" << std::endl;
     };
 
     auto dropped = Dropped();
@@ -54,6 +109,39 @@ void HailoProcessorStats::Print2() {
     printStage("Callback Processing", callbackProcessing);
     // Assuming totalProcessing is a cumulative StageStats object
     printStage("Total Processing", totalProcessing, &dropped);
+    printStage("Tile Processing", tileProcessing);
+
+    static const char* stageNames[] = {"Read", "Dispatch", "Post Processing", "Callback"};
+    std::cout << "| Worker                   | Busy 1s | Busy 10s | Busy 60s |\n";
+    std::cout << "|--------------------------|---------|----------|----------|\n";
+    std::lock_guard<std::mutex> lock(_workersMx);
+    for (const WorkerStats& worker : _workers) {
+        std::string name = std::string(stageNames[static_cast<int>(worker.Stage)]) + " #" + std::to_string(worker.Index);
+        std::cout << "| " << std::left << std::setw(24) << name << " | " << std::right << std::setprecision(0);
+        std::cout << std::setw(6) << worker.Utilization(std::chrono::seconds(1)) * 100 << "% | ";
+        std::cout << std::setw(7) << worker.Utilization(std::chrono::seconds(10)) * 100 << "% | ";
+        std::cout << std::setw(7) << worker.Utilization(std::chrono::seconds(60)) * 100 << "% |" << std::endl;
+    }
+
+    if (!PerfCounters::Enabled())
+        return;
+    std::cout << "| Counters per frame       |   Cycles (k) |   IPC | Cache misses | Branch misses |\n";
+    std::cout << "|--------------------------|--------------|-------|--------------|---------------|\n";
+    auto printPerf = [](const char* name, const StageStats& stats) {
+        const StagePerfStats& perf = stats.Perf();
+        const double frames = std::max<double>(1.0, perf.Frames.load(std::memory_order_relaxed));
+        const double cycles = perf.Cycles.load(std::memory_order_relaxed);
+        const double instructions = perf.Instructions.load(std::memory_order_relaxed);
+        std::cout << "| " << std::left << std::setw(24) << name << " | " << std::right << std::setprecision(0);
+        std::cout << std::setw(12) << cycles / frames / 1000 << " | ";
+        std::cout << std::setw(5) << std::setprecision(2) << (cycles > 0 ? instructions / cycles : 0.0) << " | " << std::setprecision(0);
+        std::cout << std::setw(12) << perf.CacheMisses.load(std::memory_order_relaxed) / frames << " | ";
+        std::cout << std::setw(13) << perf.BranchMisses.load(std::memory_order_relaxed) / frames << " |" << std::endl;
+    };
+    printPerf("Write Processing", writeProcessing);
+    printPerf("Read Interference", readInterferenceProcessing);
+    printPerf("Post Processing", postProcessing);
+    printPerf("Callback Processing", callbackProcessing);
 }
 void HailoProcessorStats::Print() {
     std::cout << "| Stage                    | Processed | Dropped | Threads | Est.FPS | Avg. Time (ms) |\n";
@@ -82,4 +170,5 @@ void HailoProcessorStats::Print() {
     printStage("Callback Processing", callbackProcessing);
     // Assuming there's a totalProcessing member in HailoProcessorStats for cumulative stats
     printStage("Total Processing", totalProcessing, &dropped);
+    printStage("Tile Processing", tileProcessing);
 }
@@ -4,7 +4,63 @@
 
 #ifndef HAILOPROCESSORSTATS_H
 #define HAILOPROCESSORSTATS_H
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
 #include "StageStats.h"
+#include "HailoProcessorStatsDto.h"
+#include "WindowedCounter.h"
+
+// Arena sizes of the post-processing workers, published on every Arena::Reset.
+struct ArenaStats {
+    // Bytes one frame needed at most, over all workers.
+    std::atomic<uint64_t> Peak{0};
+    // Blocks of all workers.
+    std::atomic<uint64_t> Capacity{0};
+    // Frames that did not fit and made their worker's block grow.
+    std::atomic<uint64_t> Overflows{0};
+};
+
+// The loop a pipeline thread runs.
+enum class WorkerStage : int {
+    Read = 0,
+    Dispatch = 1,
+    PostProcessing = 2,
+    Callback = 3
+};
+
+// Busy and idle time of one pipeline thread. Written only by its thread, on a cache line of its own.
+struct alignas(64) WorkerStats {
+    // Busy from construction to destruction, idle since the previous scope ended.
+    class BusyScope {
+    public:
+        explicit BusyScope(WorkerStats& worker) : _worker(worker) {}
+        ~BusyScope() { _worker.EndBusy(); }
+        BusyScope(const BusyScope&) = delete;
+        BusyScope& operator=(const BusyScope&) = delete;
+    private:
+        WorkerStats& _worker;
+    };
+
+    WorkerStage Stage = WorkerStage::Read;
+    // within the stage, in the order the threads started.
+    uint32_t Index = 0;
+    std::atomic<int64_t> BusyTime{0}; // Nanoseconds
+    std::atomic<int64_t> IdleTime{0};
+    // busy nanoseconds per second.
+    WindowedCounter Busy;
+
+    [[nodiscard]] BusyScope Work();
+    // Busy share of the last window of whole seconds.
+    float Utilization(std::chrono::seconds window) const;
+
+    void Start(WorkerStage stage, uint32_t index);
+private:
+    void EndBusy();
+    std::chrono::steady_clock::time_point _mark;
+};
 
 struct HailoProcessorStats {
     HailoProcessorStats(int writeThreadCount, int readInterferenceThreadCount, int postProcessingThreadCount, int callbackProcessingThreadCount, int totalCpuCount);
@@ -13,11 +69,22 @@ struct HailoProcessorStats {
     StageStats postProcessing;
     StageStats callbackProcessing;
     StageStats totalProcessing;
+    // per tile of tiled writes, from write to the end of its postprocessing.
+    StageStats tileProcessing;
+    ArenaStats postProcessingArena;
+    // Registers the calling thread; its loop wraps every item in Work(). The reference stays valid for the stats' lifetime.
+    WorkerStats& AddWorker(WorkerStage stage);
+    // Fills up to capacity entries, returns the number of workers.
+    size_t Workers(HailoProcessorStatsExDto::WorkerStatsDto* dst, size_t capacity);
     unsigned long InFlight() const;
     unsigned long Dropped() const;
     void Print();
     void Print2();
-
+private:
+    // guards the list only, workers update their entries without it.
+    std::mutex _workersMx;
+    std::deque<WorkerStats> _workers;
+    uint32_t _stageWorkers[4]{};
 };
 
 
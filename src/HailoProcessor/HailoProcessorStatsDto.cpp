@@ -5,6 +5,8 @@
 #include "HailoProcessorStatsDto.h"
 
 #include "HailoProcessorStats.h"
+#include "Frame.h"
+#include "Allocator.h"
 
 inline void PopulateStageStatsDto(HailoProcessorStatsDto::StageStatsDto& dest, const StageStats& src) {
     dest.processed = src.Processed();
@@ -14,6 +16,39 @@ inline void PopulateStageStatsDto(HailoProcessorStatsDto::StageStatsDto& dest, c
     dest.threadCount = src.ThreadCount();
     dest.totalProcessingTime = src.Total().count();
 }
+template<typename T>
+inline void PopulatePoolStatsDto(HailoProcessorStatsDto::PoolStatsDto& dest, const ObjectPool<T>& src) {
+    dest.capacity = src.Capacity();
+    dest.inUse = src.InUse();
+    dest.peak = src.Peak();
+    dest.overflow = src.Overflow();
+}
+inline void PopulateLatencyDto(HailoProcessorStatsExDto::LatencyDto& dest, StageStats& src, bool reset) {
+    LatencyHistogram::Snapshot snapshot;
+    src.Latency().Merge(snapshot, reset);
+    dest.count = snapshot.Count;
+    dest.p50 = snapshot.Percentile(0.5).count();
+    dest.p90 = snapshot.Percentile(0.9).count();
+    dest.p99 = snapshot.Percentile(0.99).count();
+    dest.p999 = snapshot.Percentile(0.999).count();
+    dest.max = snapshot.Max;
+}
+inline void PopulateRateDto(HailoProcessorStatsExDto::RateDto& dest, const StageStats& src) {
+    dest.processed1s = src.ProcessedRate(std::chrono::seconds(1));
+    dest.processed10s = src.ProcessedRate(std::chrono::seconds(10));
+    dest.processed60s = src.ProcessedRate(std::chrono::seconds(60));
+    dest.dropped1s = src.DroppedRate(std::chrono::seconds(1));
+    dest.dropped10s = src.DroppedRate(std::chrono::seconds(10));
+    dest.dropped60s = src.DroppedRate(std::chrono::seconds(60));
+}
+inline void PopulatePerfDto(HailoProcessorStatsExDto::PerfDto& dest, const StageStats& src) {
+    const StagePerfStats& perf = src.Perf();
+    dest.frames = perf.Frames.load(std::memory_order_relaxed);
+    dest.cycles = perf.Cycles.load(std::memory_order_relaxed);
+    dest.instructions = perf.Instructions.load(std::memory_order_relaxed);
+    dest.cacheMisses = perf.CacheMisses.load(std::memory_order_relaxed);
+    dest.branchMisses = perf.BranchMisses.load(std::memory_order_relaxed);
+}
 void HailoProcessorStatsDto::UpdateFrom(const HailoProcessorStats& stats) {
     PopulateStageStatsDto(writeProcessing, stats.writeProcessing);
     PopulateStageStatsDto(readInterferenceProcessing, stats.readInterferenceProcessing);
@@ -23,4 +58,45 @@ void HailoProcessorStatsDto::UpdateFrom(const HailoProcessorStats& stats) {
 
     inFlight = stats.InFlight();
     droppedTotal = stats.Dropped();
-}
\ No newline at end of file
+    PopulateStageStatsDto(tileProcessing, stats.tileProcessing);
+    PopulatePoolStatsDto(contextPool, FrameContext::Pool());
+    PopulatePoolStatsDto(resultPool, SegmentationResult::Pool());
+    PageAlignedMemoryPool::Shared().Snapshot(memoryPool);
+    postProcessingArena.peakBytes = stats.postProcessingArena.Peak.load(std::memory_order_relaxed);
+    postProcessingArena.capacityBytes = stats.postProcessingArena.Capacity.load(std::memory_order_relaxed);
+    postProcessingArena.overflows = stats.postProcessingArena.Overflows.load(std::memory_order_relaxed);
+}
+
+uint32_t HailoProcessorStatsExDto::VersionOf(uint32_t size) {
+    if (size >= sizeof(HailoProcessorStatsExDto))
+        return 3;
+    if (size >= offsetof(HailoProcessorStatsExDto, writePerf))
+        return 2;
+    if (size >= offsetof(HailoProcessorStatsExDto, writeRate))
+        return 1;
+    return 0;
+}
+
+void HailoProcessorStatsExDto::UpdateFrom(HailoProcessorStats& stats, bool resetWindow) {
+    PopulateLatencyDto(writeLatency, stats.writeProcessing, resetWindow);
+    PopulateLatencyDto(readInterferenceLatency, stats.readInterferenceProcessing, resetWindow);
+    PopulateLatencyDto(postProcessingLatency, stats.postProcessing, resetWindow);
+    PopulateLatencyDto(callbackLatency, stats.callbackProcessing, resetWindow);
+    PopulateLatencyDto(totalLatency, stats.totalProcessing, resetWindow);
+    PopulateLatencyDto(tileLatency, stats.tileProcessing, resetWindow);
+
+    PopulateRateDto(writeRate, stats.writeProcessing);
+    PopulateRateDto(readInterferenceRate, stats.readInterferenceProcessing);
+    PopulateRateDto(postProcessingRate, stats.postProcessing);
+    PopulateRateDto(callbackRate, stats.callbackProcessing);
+    PopulateRateDto(totalRate, stats.totalProcessing);
+    PopulateRateDto(tileRate, stats.tileProcessing);
+    workerCount = static_cast<uint32_t>(stats.Workers(nullptr, 0));
+
+    PopulatePerfDto(writePerf, stats.writeProcessing);
+    PopulatePerfDto(readInterferencePerf, stats.readInterferenceProcessing);
+    PopulatePerfDto(postProcessingPerf, stats.postProcessing);
+    PopulatePerfDto(callbackPerf, stats.callbackProcessing);
+    perfStatus = PerfCounters::Status();
+    perfEventParanoid = PerfCounters::Paranoid();
+}
@@ -5,6 +5,7 @@
 #ifndef HAILOPROCESSORSTATSDTO_H
 #define HAILOPROCESSORSTATSDTO_H
 #include <cstdint>
+#include <cstddef>
 
 // forward declaration.
 struct HailoProcessorStats;
@@ -23,8 +24,142 @@ struct HailoProcessorStatsDto {
     uint64_t inFlight;
     uint64_t droppedTotal;
 
+    StageStatsDto tileProcessing;
+
+    // per CameraId, read with hailo_processor_get_camera_stats.
+    struct CameraStatsDto {
+        uint32_t cameraId;
+        int priority;
+        uint32_t weight;
+        float maxFps;
+        uint64_t admitted;
+        uint64_t throttled; // over the fps cap, never preprocessed
+        uint64_t evicted; // dropped from the full camera queue
+        uint64_t dropped; // admitted but never delivered, evictions included
+        uint64_t dispatched; // frames that reached the device
+        uint64_t processed; // delivered to the callback
+        uint64_t queued;
+        int64_t totalQueueTime; // Nanoseconds from admission to the first device write, over dispatched
+        int64_t totalProcessingTime; // Nanoseconds end-to-end, over processed
+        int64_t maxProcessingTime;
+    };
+    uint32_t cameraCount;
+
+    struct AdmissionStatsDto {
+        int mode;
+        uint64_t admitted;
+        uint64_t dropped;
+        uint64_t downscaled;
+        int64_t predictedLatency; // Nanoseconds, of the last frame offered
+        int64_t deviceServiceTime; // Nanoseconds, EWMA
+        int64_t postProcessingServiceTime;
+        int64_t callbackServiceTime;
+    } admission;
+
+    // FrameContext and SegmentationResult pools.
+    struct PoolStatsDto {
+        uint32_t capacity;
+        uint32_t inUse;
+        uint32_t peak;
+        uint64_t overflow; // rents served from the heap
+    } contextPool, resultPool;
+
+    // PageAlignedMemoryPool, shared by every processor of the process.
+    struct MemoryPoolStatsDto {
+        int hugePages;
+        int locked;
+        uint64_t mappedBytes;
+        uint64_t peakMappedBytes;
+        uint64_t inUseBytes; // rounded up to the size classes
+        uint64_t peakInUseBytes;
+        uint64_t rents;
+        uint64_t threadCacheHits;
+        uint64_t freeListHits;
+        uint64_t maps; // rents that mapped a new block
+        uint64_t unmaps;
+        uint64_t hugePageBlocks; // mapped with MAP_HUGETLB
+        uint64_t lockFailures; // mlock refused, see RLIMIT_MEMLOCK
+    } memoryPool;
+
+    // post-processing arenas, see Arena.
+    struct ArenaStatsDto {
+        uint64_t peakBytes; // one frame at most
+        uint64_t capacityBytes; // all workers
+        uint64_t overflows;
+    } postProcessingArena;
+
     void UpdateFrom(const HailoProcessorStats& stats);
 };
+
+// Stats beyond HailoProcessorStatsDto, read with hailo_processor_update_stats_ex; the counters stay in
+// HailoProcessorStatsDto, read on their own, whose layout is not versioned and so is not embedded here.
+// Fields are only ever appended, each group with a new version: the caller sets size to the size of its struct,
+// and gets back the version it can read, filled up to what both sides know.
+#define HAILO_PROCESSOR_STATS_EX_VERSION 3
+struct HailoProcessorStatsExDto {
+    uint32_t version;
+    uint32_t size;
+
+    // version 1: percentiles of the frame processing time, over the lifetime or since the last reset.
+    struct LatencyDto {
+        uint64_t count;
+        int64_t p50; // Nanoseconds
+        int64_t p90;
+        int64_t p99;
+        int64_t p999;
+        int64_t max;
+    } writeLatency, readInterferenceLatency, postProcessingLatency, callbackLatency, totalLatency, tileLatency;
+
+    // version 2: frames per second observed over the last 1, 10 and 60 whole seconds.
+    struct RateDto {
+        float processed1s;
+        float processed10s;
+        float processed60s;
+        float dropped1s;
+        float dropped10s;
+        float dropped60s;
+    } writeRate, readInterferenceRate, postProcessingRate, callbackRate, totalRate, tileRate;
+
+    // items queued at the time of the read.
+    struct QueueDto {
+        uint32_t pending;
+        uint32_t capacity; // 0 - bounded per camera, see CameraStatsDto
+    };
+    struct QueuesDto {
+        QueueDto scheduled; // camera queues, waiting for the dispatcher
+        QueueDto write; // written, waiting for the device's outputs
+        QueueDto postProcessing;
+        QueueDto callback;
+    } queues;
+
+    // per pipeline thread, read with hailo_processor_get_worker_stats.
+    struct WorkerStatsDto {
+        int stage; // WorkerStage
+        uint32_t index; // within the stage
+        int64_t busyTime; // Nanoseconds
+        int64_t idleTime;
+        float utilization1s; // busy share of the window
+        float utilization10s;
+        float utilization60s;
+    };
+    uint32_t workerCount;
+
+    // version 3: hardware counters of the stages' own threads, user space only, see perf_counters_enable.
+    struct PerfDto {
+        uint64_t frames; // processed while counting
+        uint64_t cycles;
+        uint64_t instructions;
+        uint64_t cacheMisses;
+        uint64_t branchMisses;
+    } writePerf, readInterferencePerf, postProcessingPerf, callbackPerf;
+    int perfStatus; // 1 counting, 0 off, -errno when perf_event_open was refused
+    int perfEventParanoid; // INT32_MIN when unreadable
+
+    // The highest version whose fields fit in size bytes, 0 when not even the first does.
+    static uint32_t VersionOf(uint32_t size);
+    // Percentiles and rates; with resetWindow the stages' histograms start over. Queues are the processor's.
+    void UpdateFrom(HailoProcessorStats& stats, bool resetWindow);
+};
 #pragma pack(pop)
 
 
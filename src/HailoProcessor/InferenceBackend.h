@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <hailo/hailort.h>
+
+// What the pipeline needs from the accelerator: one input stream, N output streams.
+// Write and Read are called from different threads (one reader per output);
+// Read returns HAILO_TIMEOUT when nothing arrived in time, so callers can re-check their running flag.
+class InferenceBackend {
+public:
+	virtual ~InferenceBackend() = default;
+
+	virtual const hailo_vstream_info_t& InputInfo() const = 0;
+	virtual size_t InputFrameSize() const = 0;
+
+	virtual size_t OutputCount() const = 0;
+	virtual const hailo_vstream_info_t& OutputInfo(size_t output) const = 0;
+	virtual size_t OutputFrameSize(size_t output) const = 0;
+
+	virtual hailo_status Write(const uint8_t* data, size_t size) = 0;
+	virtual hailo_status Read(size_t output, uint8_t* data, size_t size) = 0;
+
+	// Unblocks pending writes and reads; the backend is not usable afterwards.
+	virtual void Abort() = 0;
+};
@@ -0,0 +1,75 @@
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+
+#include "ThreadShard.h"
+
+LatencyHistogram::LatencyHistogram() : _shards(new Shard[Shards])
+{
+	for (int s = 0; s < Shards; s++) {
+		for (auto& c : _shards[s].Counts)
+			c.store(0, std::memory_order_relaxed);
+		_shards[s].Max.store(0, std::memory_order_relaxed);
+	}
+}
+
+// Values below SubBuckets have a bucket each; above, bucket = the exponent's row, then the next SubBucketBits bits.
+int LatencyHistogram::BucketOf(uint64_t value)
+{
+	if (value < SubBuckets)
+		return static_cast<int>(value);
+	const int exponent = 63 - __builtin_clzll(value);
+	if (exponent >= MaxExponent)
+		return BucketCount - 1;
+	const int shift = exponent - SubBucketBits;
+	return ((shift + 1) << SubBucketBits) + static_cast<int>(value >> shift) - SubBuckets;
+}
+
+uint64_t LatencyHistogram::UpperBound(int bucket)
+{
+	if (bucket < SubBuckets)
+		return static_cast<uint64_t>(bucket);
+	const int shift = (bucket >> SubBucketBits) - 1;
+	const uint64_t sub = static_cast<uint64_t>(bucket & (SubBuckets - 1)) + SubBuckets;
+	return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(std::chrono::nanoseconds value)
+{
+	const int64_t ns = std::max<int64_t>(value.count(), 0);
+	Shard& shard = _shards[ThreadShard(Shards)];
+	shard.Counts[BucketOf(static_cast<uint64_t>(ns))].fetch_add(1, std::memory_order_relaxed);
+	int64_t max = shard.Max.load(std::memory_order_relaxed);
+	while (ns > max && !shard.Max.compare_exchange_weak(max, ns, std::memory_order_relaxed)) ;
+}
+
+void LatencyHistogram::Merge(Snapshot& dst, bool reset)
+{
+	for (int s = 0; s < Shards; s++) {
+		Shard& shard = _shards[s];
+		for (int b = 0; b < BucketCount; b++) {
+			const uint64_t n = reset
+				? shard.Counts[b].exchange(0, std::memory_order_relaxed)
+				: shard.Counts[b].load(std::memory_order_relaxed);
+			dst.Counts[b] += n;
+			dst.Count += n;
+		}
+		const int64_t max = reset ? shard.Max.exchange(0, std::memory_order_relaxed) : shard.Max.load(std::memory_order_relaxed);
+		dst.Max = std::max(dst.Max, max);
+	}
+}
+
+std::chrono::nanoseconds LatencyHistogram::Snapshot::Percentile(double q) const
+{
+	if (Count == 0)
+		return std::chrono::nanoseconds::zero();
+	// the rank of the value, 1-based: p50 of 1..100 is the 50th.
+	const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * static_cast<double>(Count) + 0.5));
+	uint64_t seen = 0;
+	for (int b = 0; b < BucketCount; b++) {
+		seen += Counts[b];
+		if (seen >= rank)
+			return std::chrono::nanoseconds(std::min<int64_t>(static_cast<int64_t>(UpperBound(b)), Max));
+	}
+	return std::chrono::nanoseconds(Max);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+// Log-bucketed latency histogram in nanoseconds (HDR style): every power of two is split into 16 linear sub-buckets,
+// so a percentile is reported at most 1/16 above the true value, from 1 ns to about 18 minutes.
+// Writers record without locks into one of a few cache-line separated shards, picked once per thread;
+// readers merge the shards on demand and may reset them to start a new window.
+class LatencyHistogram {
+public:
+	static constexpr int SubBucketBits = 4;
+	static constexpr int SubBuckets = 1 << SubBucketBits;
+	// values from 2^MaxExponent ns on land in the last bucket.
+	static constexpr int MaxExponent = 40;
+	static constexpr int BucketCount = (MaxExponent - SubBucketBits + 1) * SubBuckets;
+
+	struct Snapshot {
+		std::array<uint64_t, BucketCount> Counts{};
+		uint64_t Count = 0;
+		int64_t Max = 0;
+
+		// The value fraction q of the recorded values do not exceed; the top of its bucket, never above Max.
+		std::chrono::nanoseconds Percentile(double q) const;
+	};
+
+	LatencyHistogram();
+
+	void Record(std::chrono::nanoseconds value);
+	// Adds every shard to dst. With reset the counts are taken out, so the next merge covers only what was recorded since.
+	void Merge(Snapshot& dst, bool reset = false);
+
+	static int BucketOf(uint64_t value);
+	// The largest value of the bucket.
+	static uint64_t UpperBound(int bucket);
+private:
+	static constexpr int Shards = 8;
+	struct alignas(64) Shard {
+		std::atomic<uint64_t> Counts[BucketCount];
+		std::atomic<int64_t> Max;
+	};
+	std::unique_ptr<Shard[]> _shards;
+};
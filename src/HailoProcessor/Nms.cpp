@@ -0,0 +1,200 @@
+#include "Nms.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+void BoxSet::Clear()
+{
+	X1.clear(); Y1.clear(); X2.clear(); Y2.clear();
+	Score.clear();
+	ClassId.clear();
+}
+
+void BoxSet::Reserve(size_t count)
+{
+	X1.reserve(count); Y1.reserve(count); X2.reserve(count); Y2.reserve(count);
+	Score.reserve(count);
+	ClassId.reserve(count);
+}
+
+void BoxSet::Add(float x1, float y1, float x2, float y2, float score, int classId)
+{
+	X1.push_back(x1); Y1.push_back(y1); X2.push_back(x2); Y2.push_back(y2);
+	Score.push_back(score);
+	ClassId.push_back(classId);
+}
+
+void Nms::Overlaps(float x1, float y1, float x2, float y2,
+	const float* bx1, const float* by1, const float* bx2, const float* by2, size_t n,
+	NmsOverlap kind, float* dst)
+{
+	const float area = (x2 - x1) * (y2 - y1);
+	const bool iou = kind == NmsOverlap::Iou;
+	size_t i = 0;
+#if defined(__ARM_NEON)
+	const float32x4_t ax1 = vdupq_n_f32(x1), ay1 = vdupq_n_f32(y1), ax2 = vdupq_n_f32(x2), ay2 = vdupq_n_f32(y2);
+	const float32x4_t aarea = vdupq_n_f32(area), zero = vdupq_n_f32(0.0f);
+	for (; i + 4 <= n; i += 4) {
+		float32x4_t qx1 = vld1q_f32(bx1 + i), qy1 = vld1q_f32(by1 + i), qx2 = vld1q_f32(bx2 + i), qy2 = vld1q_f32(by2 + i);
+		float32x4_t w = vmaxq_f32(vsubq_f32(vminq_f32(ax2, qx2), vmaxq_f32(ax1, qx1)), zero);
+		float32x4_t h = vmaxq_f32(vsubq_f32(vminq_f32(ay2, qy2), vmaxq_f32(ay1, qy1)), zero);
+		float32x4_t inter = vmulq_f32(w, h);
+		float32x4_t barea = vmulq_f32(vsubq_f32(qx2, qx1), vsubq_f32(qy2, qy1));
+		float32x4_t denom = iou ? vsubq_f32(vaddq_f32(aarea, barea), inter) : vminq_f32(aarea, barea);
+		uint32x4_t valid = vcgtq_f32(denom, zero);
+		float32x4_t ratio = vdivq_f32(inter, vbslq_f32(valid, denom, vdupq_n_f32(1.0f)));
+		vst1q_f32(dst + i, vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(ratio), valid)));
+	}
+#elif defined(__AVX2__)
+	const __m256 ax1 = _mm256_set1_ps(x1), ay1 = _mm256_set1_ps(y1), ax2 = _mm256_set1_ps(x2), ay2 = _mm256_set1_ps(y2);
+	const __m256 aarea = _mm256_set1_ps(area), zero = _mm256_setzero_ps();
+	for (; i + 8 <= n; i += 8) {
+		__m256 qx1 = _mm256_loadu_ps(bx1 + i), qy1 = _mm256_loadu_ps(by1 + i), qx2 = _mm256_loadu_ps(bx2 + i), qy2 = _mm256_loadu_ps(by2 + i);
+		__m256 w = _mm256_max_ps(_mm256_sub_ps(_mm256_min_ps(ax2, qx2), _mm256_max_ps(ax1, qx1)), zero);
+		__m256 h = _mm256_max_ps(_mm256_sub_ps(_mm256_min_ps(ay2, qy2), _mm256_max_ps(ay1, qy1)), zero);
+		__m256 inter = _mm256_mul_ps(w, h);
+		__m256 barea = _mm256_mul_ps(_mm256_sub_ps(qx2, qx1), _mm256_sub_ps(qy2, qy1));
+		__m256 denom = iou ? _mm256_sub_ps(_mm256_add_ps(aarea, barea), inter) : _mm256_min_ps(aarea, barea);
+		__m256 valid = _mm256_cmp_ps(denom, zero, _CMP_GT_OQ);
+		__m256 ratio = _mm256_div_ps(inter, _mm256_blendv_ps(_mm256_set1_ps(1.0f), denom, valid));
+		_mm256_storeu_ps(dst + i, _mm256_and_ps(ratio, valid));
+	}
+#elif defined(__SSE4_1__)
+	const __m128 ax1 = _mm_set1_ps(x1), ay1 = _mm_set1_ps(y1), ax2 = _mm_set1_ps(x2), ay2 = _mm_set1_ps(y2);
+	const __m128 aarea = _mm_set1_ps(area), zero = _mm_setzero_ps();
+	for (; i + 4 <= n; i += 4) {
+		__m128 qx1 = _mm_loadu_ps(bx1 + i), qy1 = _mm_loadu_ps(by1 + i), qx2 = _mm_loadu_ps(bx2 + i), qy2 = _mm_loadu_ps(by2 + i);
+		__m128 w = _mm_max_ps(_mm_sub_ps(_mm_min_ps(ax2, qx2), _mm_max_ps(ax1, qx1)), zero);
+		__m128 h = _mm_max_ps(_mm_sub_ps(_mm_min_ps(ay2, qy2), _mm_max_ps(ay1, qy1)), zero);
+		__m128 inter = _mm_mul_ps(w, h);
+		__m128 barea = _mm_mul_ps(_mm_sub_ps(qx2, qx1), _mm_sub_ps(qy2, qy1));
+		__m128 denom = iou ? _mm_sub_ps(_mm_add_ps(aarea, barea), inter) : _mm_min_ps(aarea, barea);
+		__m128 valid = _mm_cmpgt_ps(denom, zero);
+		__m128 ratio = _mm_div_ps(inter, _mm_blendv_ps(_mm_set1_ps(1.0f), denom, valid));
+		_mm_storeu_ps(dst + i, _mm_and_ps(ratio, valid));
+	}
+#endif
+	for (; i < n; i++) {
+		float w = std::max(std::min(x2, bx2[i]) - std::max(x1, bx1[i]), 0.0f);
+		float h = std::max(std::min(y2, by2[i]) - std::max(y1, by1[i]), 0.0f);
+		float inter = w * h;
+		float barea = (bx2[i] - bx1[i]) * (by2[i] - by1[i]);
+		float denom = iou ? area + barea - inter : std::min(area, barea);
+		dst[i] = denom > 0.0f ? inter / denom : 0.0f;
+	}
+}
+
+namespace {
+
+// Clears alive[j] of every box overlapping the kept one (of class classId) by at least threshold.
+inline void Suppress(const float* overlap, const int* classes, uint8_t* alive, size_t n, int classId, bool crossClass, float threshold)
+{
+	for (size_t j = 0; j < n; j++)
+		alive[j] &= static_cast<uint8_t>(!(overlap[j] >= threshold && (crossClass || classes[j] == classId)));
+}
+
+void SoftNms(const BoxSet& boxes, const NmsOptions& options, size_t limit, std::vector<int>& keep, std::vector<float>* scores)
+{
+	const size_t n = boxes.Size();
+	const bool crossClass = options.Mode == NmsMode::CrossClass;
+	thread_local std::vector<float> decayed, overlap;
+	thread_local std::vector<uint8_t> alive;
+	decayed.assign(boxes.Score.begin(), boxes.Score.end());
+	overlap.resize(n);
+	alive.assign(n, 1);
+
+	while (keep.size() < limit) {
+		int best = -1;
+		for (size_t j = 0; j < n; j++)
+			if (alive[j] && (best < 0 || decayed[j] > decayed[best]))
+				best = static_cast<int>(j);
+		if (best < 0 || decayed[best] < options.ScoreThreshold)
+			break;
+		keep.push_back(best);
+		if (scores)
+			scores->push_back(decayed[best]);
+		alive[best] = 0;
+
+		Nms::Overlaps(boxes.X1[best], boxes.Y1[best], boxes.X2[best], boxes.Y2[best],
+			boxes.X1.data(), boxes.Y1.data(), boxes.X2.data(), boxes.Y2.data(), n, options.Overlap, overlap.data());
+		const int classId = boxes.ClassId[best];
+		for (size_t j = 0; j < n; j++) {
+			if (alive[j] && overlap[j] >= options.Threshold && (crossClass || boxes.ClassId[j] == classId))
+				decayed[j] *= std::exp(-overlap[j] * overlap[j] / options.Sigma);
+		}
+	}
+}
+
+}
+
+void Nms::Run(const BoxSet& boxes, const NmsOptions& options, std::vector<int>& keep, std::vector<float>* scores)
+{
+	keep.clear();
+	if (scores)
+		scores->clear();
+	const size_t n = boxes.Size();
+	const size_t limit = options.MaxDetections > 0 ? options.MaxDetections : n;
+	if (n == 0)
+		return;
+	if (options.Soft) {
+		SoftNms(boxes, options, limit, keep, scores);
+		return;
+	}
+
+	const bool crossClass = options.Mode == NmsMode::CrossClass;
+	const float* score = boxes.Score.data();
+	auto higher = [score](int a, int b) {
+		return score[a] > score[b] || (score[a] == score[b] && a < b);
+	};
+
+	// the sorted candidates of the current chunk, gathered so the overlap pass reads contiguous memory.
+	thread_local std::vector<int> order, classes;
+	thread_local std::vector<float> x1, y1, x2, y2, overlap;
+	thread_local std::vector<uint8_t> alive;
+	order.resize(n);
+	std::iota(order.begin(), order.end(), 0);
+
+	// With a detection limit, usually only the head of the order is ever looked at,
+	// so it is sorted first and the tail only when the head runs out.
+	size_t sorted = 0;
+	while (sorted < n && keep.size() < limit) {
+		const size_t end = sorted == 0 && options.MaxDetections > 0 ? std::min(n, std::max<size_t>(64, 4 * limit)) : n;
+		std::partial_sort(order.begin() + sorted, order.begin() + end, order.end(), higher);
+		const size_t count = end - sorted;
+		x1.resize(count); y1.resize(count); x2.resize(count); y2.resize(count);
+		classes.resize(count); overlap.resize(count);
+		alive.assign(count, 1);
+		for (size_t i = 0; i < count; i++) {
+			int k = order[sorted + i];
+			x1[i] = boxes.X1[k]; y1[i] = boxes.Y1[k]; x2[i] = boxes.X2[k]; y2[i] = boxes.Y2[k];
+			classes[i] = boxes.ClassId[k];
+		}
+
+		// boxes kept from earlier chunks outrank the whole chunk.
+		for (int k : keep) {
+			Overlaps(boxes.X1[k], boxes.Y1[k], boxes.X2[k], boxes.Y2[k], x1.data(), y1.data(), x2.data(), y2.data(), count, options.Overlap, overlap.data());
+			Suppress(overlap.data(), classes.data(), alive.data(), count, boxes.ClassId[k], crossClass, options.Threshold);
+		}
+
+		for (size_t i = 0; i < count && keep.size() < limit; i++) {
+			if (!alive[i])
+				continue;
+			keep.push_back(order[sorted + i]);
+			const size_t rest = count - i - 1;
+			Overlaps(x1[i], y1[i], x2[i], y2[i], x1.data() + i + 1, y1.data() + i + 1, x2.data() + i + 1, y2.data() + i + 1, rest, options.Overlap, overlap.data());
+			Suppress(overlap.data(), classes.data() + i + 1, alive.data() + i + 1, rest, classes[i], crossClass, options.Threshold);
+		}
+		sorted = end;
+	}
+	if (scores) {
+		for (int k : keep)
+			scores->push_back(boxes.Score[k]);
+	}
+}
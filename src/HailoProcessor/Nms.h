@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Boxes as parallel arrays of corners, any consistent unit. Indices into these arrays identify the boxes.
+struct BoxSet {
+	std::vector<float> X1, Y1, X2, Y2;
+	std::vector<float> Score;
+	std::vector<int> ClassId;
+
+	size_t Size() const { return Score.size(); }
+	void Clear();
+	void Reserve(size_t count);
+	void Add(float x1, float y1, float x2, float y2, float score, int classId);
+};
+
+enum class NmsMode {
+	// Boxes suppress only boxes of the same class.
+	ClassAware,
+	// Any box suppresses any other.
+	CrossClass
+};
+
+enum class NmsOverlap {
+	// Intersection over union.
+	Iou,
+	// Intersection over the smaller area, so a box nested in a larger one counts as a duplicate.
+	IntersectionOverSmaller
+};
+
+struct NmsOptions {
+	// Boxes overlapping a kept box by at least this much are suppressed (hard) or decayed (soft).
+	float Threshold = 0.5f;
+	NmsMode Mode = NmsMode::ClassAware;
+	NmsOverlap Overlap = NmsOverlap::Iou;
+	// Stops once this many boxes are kept, 0 for no limit. Only as many boxes as needed are sorted.
+	size_t MaxDetections = 0;
+	// Gaussian Soft-NMS: score *= exp(-overlap^2 / Sigma) instead of dropping the box.
+	bool Soft = false;
+	float Sigma = 0.5f;
+	// Soft-NMS stops once the best remaining (decayed) score is below this.
+	float ScoreThreshold = 0.001f;
+};
+
+// Greedy non-maximum suppression over a BoxSet.
+// The overlap of one kept box against all remaining candidates is computed in one vectorized pass
+// (NEON on aarch64, AVX2 or SSE4.1 on x86, scalar otherwise).
+class Nms {
+public:
+	// Indices of the kept boxes, highest score first; ties keep the lower index first.
+	// With Soft, scores receives the decayed score of every kept box.
+	static void Run(const BoxSet& boxes, const NmsOptions& options, std::vector<int>& keep, std::vector<float>* scores = nullptr);
+
+	// Overlap of the box (x1, y1, x2, y2) with n boxes given as parallel corner arrays.
+	static void Overlaps(float x1, float y1, float x2, float y2,
+		const float* bx1, const float* by1, const float* bx2, const float* by2, size_t n,
+		NmsOverlap kind, float* dst);
+};
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+
+// A fixed number of reusable objects, rented and returned without locks.
+// Objects are constructed once and recycled as they are, so the containers inside them keep their capacity;
+// whoever rents one reinitializes it. When all of them are rented, Rent falls back to the heap and counts an overflow,
+// and Return tells the two apart, so callers do not care where an object came from.
+// Every slot has a generation, odd while rented and bumped on every rent and return. A handle is the slot and
+// its generation, so a handle of a returned object no longer resolves: a stale or repeated dispose coming back
+// through the C API is detected instead of releasing an object that was rented again meanwhile.
+// Heap objects have no slot, so the set of those still rented stands in for the generation: a repeated dispose of one
+// finds it gone instead of deleting it twice. Overflow is the exception, so a lock is good enough there.
+// Returning is two steps when the object needs cleaning up: Acquire takes it from the renter by bumping the generation,
+// so only one of several racing returns wins and only the winner touches it; Release then puts it back on the free list.
+template<typename T>
+class ObjectPool {
+public:
+	explicit ObjectPool(uint32_t capacity) : _capacity(capacity), _slots(new Slot[capacity]) {
+		for (uint32_t i = 0; i < capacity; i++)
+			_slots[i].Next.store(i + 1 < capacity ? i + 1 : Empty, std::memory_order_relaxed);
+		_head.store(capacity > 0 ? 0 : Empty, std::memory_order_release);
+	}
+	ObjectPool(const ObjectPool&) = delete;
+	ObjectPool& operator=(const ObjectPool&) = delete;
+
+	T* Rent() {
+		const uint32_t index = Pop();
+		if (index == Empty) {
+			_overflow.fetch_add(1, std::memory_order_relaxed);
+			T* item = new T();
+			std::lock_guard<std::mutex> lock(_heapMx);
+			_heap.insert(item);
+			return item;
+		}
+		_slots[index].Generation.fetch_add(1, std::memory_order_acq_rel);
+		const uint32_t used = _inUse.fetch_add(1, std::memory_order_relaxed) + 1;
+		uint32_t peak = _peak.load(std::memory_order_relaxed);
+		while (used > peak && !_peak.compare_exchange_weak(peak, used, std::memory_order_relaxed)) ;
+		return &_slots[index].Value;
+	}
+
+	// Takes back an object from Rent, heap ones are deleted. False when it was not rented.
+	bool Return(T* item) {
+		if (!Acquire(item))
+			return false;
+		Release(item);
+		return true;
+	}
+	// False for a stale handle, the object is then left alone.
+	bool Return(uint64_t handle) {
+		T* item = Acquire(handle);
+		if (item == nullptr)
+			return false;
+		Release(item);
+		return true;
+	}
+
+	// Ends the rent: handles stop resolving and any other Acquire or Return of it fails. False when it was not rented.
+	// The caller owns the object until it hands it to Release.
+	bool Acquire(T* item) {
+		const uint32_t index = IndexOf(item);
+		if (index == Empty) {
+			std::lock_guard<std::mutex> lock(_heapMx);
+			return _heap.erase(item) == 1;
+		}
+		return Claim(index, _slots[index].Generation.load(std::memory_order_acquire));
+	}
+	// The handle's object, or nullptr for a stale handle.
+	T* Acquire(uint64_t handle) {
+		const uint32_t index = static_cast<uint32_t>(handle) - 1;
+		if (index >= _capacity || !Claim(index, static_cast<uint32_t>(handle >> 32)))
+			return nullptr;
+		return &_slots[index].Value;
+	}
+	// Makes an acquired object available to Rent again; heap ones are deleted.
+	void Release(T* item) {
+		const uint32_t index = IndexOf(item);
+		if (index == Empty) {
+			delete item;
+			return;
+		}
+		_inUse.fetch_sub(1, std::memory_order_relaxed);
+		Push(index);
+	}
+
+	// Never 0 for a rented pooled object; 0 for heap objects, which have no generation.
+	uint64_t Handle(const T* item) const {
+		const uint32_t index = IndexOf(item);
+		if (index == Empty)
+			return 0;
+		return static_cast<uint64_t>(_slots[index].Generation.load(std::memory_order_acquire)) << 32 | (index + 1);
+	}
+	// nullptr unless the handle's object is still rented.
+	T* Resolve(uint64_t handle) const {
+		const uint32_t index = static_cast<uint32_t>(handle) - 1;
+		if (index >= _capacity || _slots[index].Generation.load(std::memory_order_acquire) != static_cast<uint32_t>(handle >> 32))
+			return nullptr;
+		return &_slots[index].Value;
+	}
+
+	uint32_t Capacity() const { return _capacity; }
+	uint32_t InUse() const { return _inUse.load(std::memory_order_relaxed); }
+	uint32_t Peak() const { return _peak.load(std::memory_order_relaxed); }
+	// Rents served from the heap because the pool was exhausted.
+	uint64_t Overflow() const { return _overflow.load(std::memory_order_relaxed); }
+
+private:
+	static constexpr uint32_t Empty = UINT32_MAX;
+
+	struct Slot {
+		T Value;
+		std::atomic<uint32_t> Generation{0};
+		std::atomic<uint32_t> Next{Empty};
+	};
+
+	uint32_t IndexOf(const T* item) const {
+		const auto first = reinterpret_cast<uintptr_t>(&_slots[0].Value);
+		const auto p = reinterpret_cast<uintptr_t>(item);
+		if (_capacity == 0 || p < first)
+			return Empty;
+		const uintptr_t index = (p - first) / sizeof(Slot);
+		return index < _capacity && &_slots[index].Value == item ? static_cast<uint32_t>(index) : Empty;
+	}
+
+	// Rented (odd) generation to the next, returned one; fails when someone else got there first.
+	bool Claim(uint32_t index, uint32_t generation) {
+		return (generation & 1) != 0 &&
+			_slots[index].Generation.compare_exchange_strong(generation, generation + 1, std::memory_order_acq_rel);
+	}
+
+	// Treiber stack of free slots. The head carries a tag bumped on every change, so a pop racing with
+	// a pop and push of the same slot (ABA) fails its compare-exchange.
+	uint32_t Pop() {
+		uint64_t head = _head.load(std::memory_order_acquire);
+		for (;;) {
+			const uint32_t index = static_cast<uint32_t>(head);
+			if (index == Empty)
+				return Empty;
+			const uint64_t next = ((head >> 32) + 1) << 32 | _slots[index].Next.load(std::memory_order_relaxed);
+			if (_head.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_acquire))
+				return index;
+		}
+	}
+
+	void Push(uint32_t index) {
+		uint64_t head = _head.load(std::memory_order_relaxed);
+		for (;;) {
+			_slots[index].Next.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+			const uint64_t next = ((head >> 32) + 1) << 32 | index;
+			if (_head.compare_exchange_weak(head, next, std::memory_order_release, std::memory_order_relaxed))
+				return;
+		}
+	}
+
+	const uint32_t _capacity;
+	std::unique_ptr<Slot[]> _slots;
+	std::atomic<uint64_t> _head{Empty};
+	std::atomic<uint32_t> _inUse{0};
+	std::atomic<uint32_t> _peak{0};
+	std::atomic<uint64_t> _overflow{0};
+	// heap objects rented and not yet acquired back.
+	std::mutex _heapMx;
+	std::unordered_set<const T*> _heap;
+};
@@ -21,12 +21,11 @@ public:
 	hailo_quant_info_t     quant_info;
 	hailo_3d_image_shape_t shape;
 	hailo_format_t         format;
-	shared_ptr<PageAlignedMemoryPool>   allocator;
 	const size_t		   output_size;
-	OutTensor(shared_ptr<PageAlignedMemoryPool> alloc, const std::string& name, const hailo_quant_info_t& quant_info,
+	OutTensor(const std::string& name, const hailo_quant_info_t& quant_info,
 		const hailo_3d_image_shape_t& shape, hailo_format_t format, const size_t dataSize)
 		: name(name), quant_info(quant_info), shape(shape), format(format), output_size(dataSize),
-		allocator(alloc), data(alloc->Rent<uint8_t>(dataSize))
+		data(PageAlignedMemoryPool::Shared().Rent<uint8_t>(dataSize))
 	{
 		
 	}
@@ -0,0 +1,163 @@
+#include "PerfCounters.h"
+
+#include <cerrno>
+#include <climits>
+#include <fstream>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+// Counter group of one thread; members the CPU lacks are skipped, so Slots maps the read values onto Sample::Values.
+struct ThreadGroup {
+	int Leader = -1;
+	int Fds[4] = {-1, -1, -1, -1};
+	int Slots[4] = {-1, -1, -1, -1};
+	int Count = 0;
+	int Error = 0;
+
+	ThreadGroup();
+	~ThreadGroup();
+	bool Read(PerfScope::Sample& sample) const;
+	// opened on the first call of the thread; Leader < 0 when the kernel refused, with Error its errno.
+	static ThreadGroup& OfThread();
+};
+
+#if defined(__linux__)
+
+namespace {
+
+const uint64_t Events[4] = {
+	PERF_COUNT_HW_CPU_CYCLES,
+	PERF_COUNT_HW_INSTRUCTIONS,
+	PERF_COUNT_HW_CACHE_MISSES,
+	PERF_COUNT_HW_BRANCH_MISSES
+};
+
+int Open(uint64_t config, int group)
+{
+	perf_event_attr attr;
+	std::memset(&attr, 0, sizeof(attr));
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof(attr);
+	attr.config = config;
+	// user space only: allowed up to perf_event_paranoid 2, and the stages' waits in the kernel are not their work.
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	attr.disabled = group < 0 ? 1 : 0;
+	return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group, PERF_FLAG_FD_CLOEXEC));
+}
+
+}
+
+ThreadGroup::ThreadGroup()
+{
+	for (int i = 0; i < 4; i++) {
+		int fd = Open(Events[i], Leader);
+		if (fd < 0) {
+			if (Leader < 0)
+				Error = errno;
+			continue;
+		}
+		if (Leader < 0)
+			Leader = fd;
+		Fds[i] = fd;
+		Slots[i] = Count++;
+	}
+	if (Leader >= 0) {
+		Error = 0;
+		ioctl(Leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(Leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	}
+}
+
+ThreadGroup::~ThreadGroup()
+{
+	for (int fd : Fds)
+		if (fd >= 0)
+			close(fd);
+}
+
+bool ThreadGroup::Read(PerfScope::Sample& sample) const
+{
+	// nr, time enabled, time running, then a value per member.
+	uint64_t buffer[3 + 4];
+	const ssize_t size = read(Leader, buffer, sizeof(buffer));
+	if (size < static_cast<ssize_t>((3 + Count) * sizeof(uint64_t)))
+		return false;
+	sample.Enabled = buffer[1];
+	sample.Running = buffer[2];
+	for (int i = 0; i < 4; i++)
+		sample.Values[i] = Slots[i] >= 0 ? buffer[3 + Slots[i]] : 0;
+	return true;
+}
+
+#else
+
+ThreadGroup::ThreadGroup() : Error(ENOSYS) {}
+ThreadGroup::~ThreadGroup() = default;
+bool ThreadGroup::Read(PerfScope::Sample&) const { return false; }
+
+#endif
+
+ThreadGroup& ThreadGroup::OfThread()
+{
+	thread_local ThreadGroup group;
+	return group;
+}
+
+int PerfCounters::Enable(bool value)
+{
+	if (!value) {
+		_enabled.store(false, std::memory_order_relaxed);
+		_status.store(0, std::memory_order_relaxed);
+		return 0;
+	}
+	// the calling thread's group tells whether the kernel lets this process count at all.
+	const ThreadGroup& probe = ThreadGroup::OfThread();
+	const int status = probe.Leader >= 0 ? 1 : -(probe.Error != 0 ? probe.Error : ENOSYS);
+	_status.store(status, std::memory_order_relaxed);
+	_enabled.store(status > 0, std::memory_order_relaxed);
+	return status;
+}
+
+int PerfCounters::Status()
+{
+	return _status.load(std::memory_order_relaxed);
+}
+
+int PerfCounters::Paranoid()
+{
+	std::ifstream file("/proc/sys/kernel/perf_event_paranoid");
+	int value;
+	if (file >> value)
+		return value;
+	return INT32_MIN;
+}
+
+PerfScope::PerfScope(StagePerfStats& stats) : _stats(stats), _group(nullptr)
+{
+	if (!PerfCounters::Enabled())
+		return;
+	ThreadGroup& group = ThreadGroup::OfThread();
+	if (group.Leader >= 0 && group.Read(_start))
+		_group = &group;
+}
+
+PerfScope::~PerfScope()
+{
+	Sample end;
+	if (_group == nullptr || !_group->Read(end))
+		return;
+	// the counters were multiplexed when the group did not run all the time it was enabled.
+	const uint64_t enabled = end.Enabled - _start.Enabled;
+	const uint64_t running = end.Running - _start.Running;
+	const double scale = running > 0 && running < enabled ? static_cast<double>(enabled) / static_cast<double>(running) : 1.0;
+	std::atomic<uint64_t>* totals[4] = {&_stats.Cycles, &_stats.Instructions, &_stats.CacheMisses, &_stats.BranchMisses};
+	for (int i = 0; i < 4; i++)
+		totals[i]->fetch_add(static_cast<uint64_t>(static_cast<double>(end.Values[i] - _start.Values[i]) * scale), std::memory_order_relaxed);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Hardware counters of the work a stage does on its own threads, user space only.
+struct StagePerfStats {
+	// frames the stage processed while counting.
+	std::atomic<uint64_t> Frames{0};
+	std::atomic<uint64_t> Cycles{0};
+	std::atomic<uint64_t> Instructions{0};
+	std::atomic<uint64_t> CacheMisses{0};
+	std::atomic<uint64_t> BranchMisses{0};
+};
+
+// Process-wide switch for per-thread perf_event_open counter groups (cycles, instructions, cache and branch misses).
+// Off by default. A thread opens its group on the first PerfScope after Enable and keeps it until it exits;
+// a counter the CPU or the kernel does not offer stays 0. When the kernel refuses (perf_event_paranoid,
+// seccomp, no PMU in the VM), Enable reports why and the scopes stay a single branch.
+class PerfCounters {
+public:
+	// 1 when counting, 0 when off, -errno of perf_event_open when refused.
+	static int Enable(bool value);
+	static bool Enabled() { return _enabled.load(std::memory_order_relaxed); }
+	static int Status();
+	// /proc/sys/kernel/perf_event_paranoid, INT32_MIN when unreadable.
+	static int Paranoid();
+private:
+	inline static std::atomic<bool> _enabled{false};
+	inline static std::atomic<int> _status{0};
+};
+
+// Adds the counts of the calling thread between construction and destruction to a stage.
+class PerfScope {
+public:
+	explicit PerfScope(StagePerfStats& stats);
+	~PerfScope();
+	PerfScope(const PerfScope&) = delete;
+	PerfScope& operator=(const PerfScope&) = delete;
+
+	struct Sample {
+		uint64_t Enabled;
+		uint64_t Running;
+		uint64_t Values[4];
+	};
+private:
+	StagePerfStats& _stats;
+	// null when not counting.
+	struct ThreadGroup* _group;
+	Sample _start;
+};
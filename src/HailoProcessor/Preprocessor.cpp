@@ -0,0 +1,391 @@
+#include "Preprocessor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// Resampling works in luma pixel space, where pixel centers are at integer + 0.5 (the cv::resize convention).
+// A destination row is resampled into a small planar row set (Y at full destination width, U/V at half width)
+// that is then converted with the SIMD row kernels from YuvConverter.
+// The source format only changes how rows are fetched (SourceRows), so every kernel is specialized per format.
+
+namespace {
+
+constexpr int WeightBits = 11;
+constexpr int WeightOne = 1 << WeightBits;
+
+struct Tap {
+	int i0;
+	int i1;
+	int w;	// weight of i1, in 1/WeightOne units
+};
+
+struct Span {
+	int begin;
+	int end;
+};
+
+Tap MakeTap(double f, int lo, int hi) {
+	if (f < lo) f = lo;
+	int i0 = static_cast<int>(std::floor(f));
+	if (i0 >= hi)
+		return Tap{ hi, hi, 0 };
+	int w = static_cast<int>(std::lround((f - i0) * WeightOne));
+	return Tap{ i0, i0 + 1, w };
+}
+
+inline uint8_t Lerp2D(const uint8_t* r0, const uint8_t* r1, const Tap& tx, int wy) {
+	int top = r0[tx.i0] * (WeightOne - tx.w) + r0[tx.i1] * tx.w;
+	int bottom = r1[tx.i0] * (WeightOne - tx.w) + r1[tx.i1] * tx.w;
+	return static_cast<uint8_t>((top * (WeightOne - wy) + bottom * wy + (1 << (2 * WeightBits - 1))) >> (2 * WeightBits));
+}
+
+// Scratch reused by every call made from the same thread; grows only when the images get wider.
+struct Scratch {
+	std::vector<Tap> lumaTaps;
+	std::vector<Tap> chromaTaps;
+	std::vector<Span> lumaSpans;
+	std::vector<Span> chromaSpans;
+	std::vector<int> lumaSums;
+	std::vector<int> uSums;
+	std::vector<int> vSums;
+	std::vector<uint8_t> y;
+	std::vector<uint8_t> u;
+	std::vector<uint8_t> v;
+	std::vector<uint8_t> rows;
+
+	void Reserve(int dstWidth) {
+		size_t chromaWidth = static_cast<size_t>(dstWidth + 1) / 2;
+		if (y.size() < static_cast<size_t>(dstWidth)) {
+			lumaTaps.resize(dstWidth);
+			lumaSpans.resize(dstWidth);
+			lumaSums.resize(dstWidth);
+			y.resize(dstWidth);
+		}
+		if (u.size() < chromaWidth) {
+			chromaTaps.resize(chromaWidth);
+			chromaSpans.resize(chromaWidth);
+			uSums.resize(chromaWidth);
+			vSums.resize(chromaWidth);
+			u.resize(chromaWidth);
+			v.resize(chromaWidth);
+		}
+	}
+};
+
+thread_local Scratch scratch;
+
+constexpr int ChromaShiftY(PixelFormat f) {
+	return (f == PixelFormat::I420 || f == PixelFormat::NV12) ? 1 : 0;
+}
+
+void SplitUV(const uint8_t* src, uint8_t* u, uint8_t* v, int count) {
+	int i = 0;
+#if defined(__ARM_NEON)
+	for (; i + 16 <= count; i += 16) {
+		uint8x16x2_t uv = vld2q_u8(src + 2 * i);
+		vst1q_u8(u + i, uv.val[0]);
+		vst1q_u8(v + i, uv.val[1]);
+	}
+#endif
+	for (; i < count; i++) {
+		u[i] = src[2 * i];
+		v[i] = src[2 * i + 1];
+	}
+}
+
+// Y0 U Y1 V -> planar; count is the number of pixel pairs.
+void SplitYUYV(const uint8_t* src, uint8_t* y, uint8_t* u, uint8_t* v, int count) {
+	int i = 0;
+#if defined(__ARM_NEON)
+	for (; i + 16 <= count; i += 16) {
+		uint8x16x4_t p = vld4q_u8(src + 4 * i);
+		uint8x16x2_t yy = { { p.val[0], p.val[2] } };
+		vst2q_u8(y + 2 * i, yy);
+		vst1q_u8(u + i, p.val[1]);
+		vst1q_u8(v + i, p.val[3]);
+	}
+#endif
+	for (; i < count; i++) {
+		y[2 * i] = src[4 * i];
+		u[i] = src[4 * i + 1];
+		y[2 * i + 1] = src[4 * i + 2];
+		v[i] = src[4 * i + 3];
+	}
+}
+
+// Hands out source rows as separate Y, U and V rows starting at column 0, the layout YuvConverter consumes.
+// Planar formats point straight into the planes. Interleaved formats are split on demand into
+// two cached rows, enough for the two taps of bilinear filtering;
+// a caller must consume the luma rows before asking for chroma rows of other lines.
+template<PixelFormat F>
+class SourceRows {
+public:
+	static constexpr int ChromaShift = ChromaShiftY(F);
+
+	// Only columns [x, x + width) of interleaved rows are split.
+	SourceRows(const FrameView<F>& src, int x, int width) : _src(src), _pair(x / 2), _pairs((x + width + 1) / 2 - x / 2) {
+		if constexpr (F == PixelFormat::NV12 || F == PixelFormat::YUYV) {
+			const size_t chromaWidth = static_cast<size_t>(src.Width + 1) / 2;
+			const size_t slot = (F == PixelFormat::YUYV ? src.Width : 0) + 2 * chromaWidth;
+			if (scratch.rows.size() < 2 * slot)
+				scratch.rows.resize(2 * slot);
+			for (int i = 0; i < 2; i++) {
+				uint8_t* base = scratch.rows.data() + i * slot;
+				_y[i] = base;
+				_u[i] = base + (F == PixelFormat::YUYV ? src.Width : 0);
+				_v[i] = _u[i] + chromaWidth;
+			}
+		}
+	}
+
+	const uint8_t* Y(int row) {
+		if constexpr (F == PixelFormat::YUYV)
+			return _y[Load(row)];
+		else
+			return _src.Planes[0] + static_cast<size_t>(row) * _src.Strides[0];
+	}
+	const uint8_t* U(int chromaRow) {
+		if constexpr (F == PixelFormat::NV12 || F == PixelFormat::YUYV)
+			return _u[Load(chromaRow)];
+		else
+			return _src.Planes[1] + static_cast<size_t>(chromaRow) * _src.Strides[1];
+	}
+	const uint8_t* V(int chromaRow) {
+		if constexpr (F == PixelFormat::NV12 || F == PixelFormat::YUYV)
+			return _v[Load(chromaRow)];
+		else
+			return _src.Planes[2] + static_cast<size_t>(chromaRow) * _src.Strides[2];
+	}
+
+private:
+	int Load(int row) {
+		if (_rows[0] == row) { _next = 1; return 0; }
+		if (_rows[1] == row) { _next = 0; return 1; }
+		int slot = _next;
+		_next ^= 1;
+		_rows[slot] = row;
+		if constexpr (F == PixelFormat::NV12)
+			SplitUV(_src.Planes[1] + static_cast<size_t>(row) * _src.Strides[1] + 2 * _pair,
+				_u[slot] + _pair, _v[slot] + _pair, _pairs);
+		else
+			SplitYUYV(_src.Planes[0] + static_cast<size_t>(row) * _src.Strides[0] + 4 * _pair,
+				_y[slot] + 2 * _pair, _u[slot] + _pair, _v[slot] + _pair, _pairs);
+		return slot;
+	}
+
+	const FrameView<F>& _src;
+	const int _pair;
+	const int _pairs;
+	uint8_t* _y[2] = {};
+	uint8_t* _u[2] = {};
+	uint8_t* _v[2] = {};
+	int _rows[2] = { -1, -1 };
+	int _next = 0;
+};
+
+template<PixelFormat F>
+void ResizeBilinear(SourceRows<F>& rows,
+	int x, int y, int width, int height,
+	uint8_t* dst, int dstWidth, int dstHeight, int dstStride, ChannelOrder order)
+{
+	constexpr int shift = SourceRows<F>::ChromaShift;
+	const double sx = static_cast<double>(width) / dstWidth;
+	const double sy = static_cast<double>(height) / dstHeight;
+	const int chromaWidth = (dstWidth + 1) / 2;
+	const int cxLo = x / 2, cxHi = (x + width - 1) / 2;
+	const int cyLo = y >> shift, cyHi = (y + height - 1) >> shift;
+
+	for (int dx = 0; dx < dstWidth; dx++)
+		scratch.lumaTaps[dx] = MakeTap(x + (dx + 0.5) * sx - 0.5, x, x + width - 1);
+	// chroma is sampled once per destination pixel pair, at the center of the pair.
+	for (int p = 0; p < chromaWidth; p++)
+		scratch.chromaTaps[p] = MakeTap((x + (2 * p + 1) * sx) / 2 - 0.5, cxLo, cxHi);
+
+	for (int dy = 0; dy < dstHeight; dy++) {
+		double fy = y + (dy + 0.5) * sy;
+		Tap ty = MakeTap(fy - 0.5, y, y + height - 1);
+		Tap tc = MakeTap(fy / (1 << shift) - 0.5, cyLo, cyHi);
+
+		const uint8_t* y0 = rows.Y(ty.i0);
+		const uint8_t* y1 = rows.Y(ty.i1);
+		for (int dx = 0; dx < dstWidth; dx++)
+			scratch.y[dx] = Lerp2D(y0, y1, scratch.lumaTaps[dx], ty.w);
+
+		const uint8_t* u0 = rows.U(tc.i0);
+		const uint8_t* u1 = rows.U(tc.i1);
+		const uint8_t* v0 = rows.V(tc.i0);
+		const uint8_t* v1 = rows.V(tc.i1);
+		for (int p = 0; p < chromaWidth; p++) {
+			scratch.u[p] = Lerp2D(u0, u1, scratch.chromaTaps[p], tc.w);
+			scratch.v[p] = Lerp2D(v0, v1, scratch.chromaTaps[p], tc.w);
+		}
+
+		YuvConverter::ConvertRow(scratch.y.data(), scratch.u.data(), scratch.v.data(), 0, dstWidth,
+			dst + static_cast<size_t>(dy) * dstStride, order);
+	}
+}
+
+inline Span LumaSpan(int origin, int length, int dstLength, int i) {
+	int begin = origin + static_cast<int>(static_cast<int64_t>(i) * length / dstLength);
+	int end = origin + static_cast<int>(static_cast<int64_t>(i + 1) * length / dstLength);
+	return Span{ begin, std::max(end, begin + 1) };
+}
+
+inline Span ChromaSpan(const Span& first, const Span& last, int shift) {
+	int begin = first.begin >> shift;
+	return Span{ begin, std::max((last.end + (1 << shift) - 1) >> shift, begin + 1) };
+}
+
+inline void AccumulateRow(const uint8_t* row, const Span* spans, int* sums, int count) {
+	for (int i = 0; i < count; i++) {
+		int sum = 0;
+		for (int c = spans[i].begin; c < spans[i].end; c++)
+			sum += row[c];
+		sums[i] += sum;
+	}
+}
+
+inline void Average(const int* sums, const Span* spans, int rowCount, uint8_t* dst, int count) {
+	for (int i = 0; i < count; i++) {
+		int n = (spans[i].end - spans[i].begin) * rowCount;
+		dst[i] = static_cast<uint8_t>((sums[i] + n / 2) / n);
+	}
+}
+
+// Box filter, walked row by row so every source row is fetched (or split) once per destination row.
+template<PixelFormat F>
+void ResizeArea(SourceRows<F>& rows,
+	int x, int y, int width, int height,
+	uint8_t* dst, int dstWidth, int dstHeight, int dstStride, ChannelOrder order)
+{
+	constexpr int shift = SourceRows<F>::ChromaShift;
+	const int chromaWidth = (dstWidth + 1) / 2;
+	for (int dx = 0; dx < dstWidth; dx++)
+		scratch.lumaSpans[dx] = LumaSpan(x, width, dstWidth, dx);
+	for (int p = 0; p < chromaWidth; p++)
+		scratch.chromaSpans[p] = ChromaSpan(scratch.lumaSpans[2 * p], scratch.lumaSpans[std::min(2 * p + 1, dstWidth - 1)], 1);
+
+	for (int dy = 0; dy < dstHeight; dy++) {
+		Span ry = LumaSpan(y, height, dstHeight, dy);
+		Span rc = ChromaSpan(ry, ry, shift);
+
+		std::fill_n(scratch.lumaSums.begin(), dstWidth, 0);
+		for (int r = ry.begin; r < ry.end; r++)
+			AccumulateRow(rows.Y(r), scratch.lumaSpans.data(), scratch.lumaSums.data(), dstWidth);
+		Average(scratch.lumaSums.data(), scratch.lumaSpans.data(), ry.end - ry.begin, scratch.y.data(), dstWidth);
+
+		std::fill_n(scratch.uSums.begin(), chromaWidth, 0);
+		std::fill_n(scratch.vSums.begin(), chromaWidth, 0);
+		for (int r = rc.begin; r < rc.end; r++) {
+			AccumulateRow(rows.U(r), scratch.chromaSpans.data(), scratch.uSums.data(), chromaWidth);
+			AccumulateRow(rows.V(r), scratch.chromaSpans.data(), scratch.vSums.data(), chromaWidth);
+		}
+		Average(scratch.uSums.data(), scratch.chromaSpans.data(), rc.end - rc.begin, scratch.u.data(), chromaWidth);
+		Average(scratch.vSums.data(), scratch.chromaSpans.data(), rc.end - rc.begin, scratch.v.data(), chromaWidth);
+
+		YuvConverter::ConvertRow(scratch.y.data(), scratch.u.data(), scratch.v.data(), 0, dstWidth,
+			dst + static_cast<size_t>(dy) * dstStride, order);
+	}
+}
+
+}
+
+template<PixelFormat F>
+void Preprocessor::Convert(const FrameView<F>& src,
+	int x, int y, int width, int height,
+	uint8_t* dst, int dstStride, ChannelOrder order)
+{
+	SourceRows<F> rows(src, x, width);
+	constexpr int shift = SourceRows<F>::ChromaShift;
+	for (int iy = 0; iy < height; iy++) {
+		int row = y + iy;
+		const uint8_t* yRow = rows.Y(row);
+		YuvConverter::ConvertRow(yRow, rows.U(row >> shift), rows.V(row >> shift), x, width,
+			dst + static_cast<size_t>(iy) * dstStride, order);
+	}
+}
+
+template<PixelFormat F>
+void Preprocessor::Resize(const FrameView<F>& src,
+	int x, int y, int width, int height,
+	uint8_t* dst, int dstWidth, int dstHeight, int dstStride,
+	ChannelOrder order, ResizeFilter filter)
+{
+	if (width <= 0 || height <= 0 || dstWidth <= 0 || dstHeight <= 0)
+		return;
+	if (width == dstWidth && height == dstHeight) {
+		Convert(src, x, y, width, height, dst, dstStride, order);
+		return;
+	}
+	scratch.Reserve(dstWidth);
+	SourceRows<F> rows(src, x, width);
+
+	if (filter == ResizeFilter::Area && width >= dstWidth && height >= dstHeight)
+		ResizeArea(rows, x, y, width, height, dst, dstWidth, dstHeight, dstStride, order);
+	else
+		ResizeBilinear(rows, x, y, width, height, dst, dstWidth, dstHeight, dstStride, order);
+}
+
+template<PixelFormat F>
+void Preprocessor::Letterbox(const FrameView<F>& src,
+	int x, int y, int width, int height,
+	uint8_t* dst, int dstWidth, int dstHeight, int dstStride,
+	int contentX, int contentY, int contentWidth, int contentHeight,
+	const uint8_t pad[3], ChannelOrder order, ResizeFilter filter)
+{
+	// bars first, then the content is written in place; nothing is copied twice.
+	Fill(dst, dstStride, 0, 0, dstWidth, contentY, pad);
+	Fill(dst, dstStride, 0, contentY + contentHeight, dstWidth, dstHeight - contentY - contentHeight, pad);
+	Fill(dst, dstStride, 0, contentY, contentX, contentHeight, pad);
+	Fill(dst, dstStride, contentX + contentWidth, contentY, dstWidth - contentX - contentWidth, contentHeight, pad);
+
+	uint8_t* content = dst + static_cast<size_t>(contentY) * dstStride + static_cast<size_t>(contentX) * 3;
+	Resize(src, x, y, width, height, content, contentWidth, contentHeight, dstStride, order, filter);
+}
+
+void Preprocessor::ResizeI420(const uint8_t* yPlane, int yStride,
+	const uint8_t* uPlane, const uint8_t* vPlane, int uvStride,
+	int x, int y, int width, int height,
+	uint8_t* dst, int dstWidth, int dstHeight, int dstStride,
+	ChannelOrder order, ResizeFilter filter)
+{
+	FrameView<PixelFormat::I420> src;
+	src.Width = x + width;
+	src.Height = y + height;
+	src.Planes[0] = yPlane;
+	src.Planes[1] = uPlane;
+	src.Planes[2] = vPlane;
+	src.Strides[0] = yStride;
+	src.Strides[1] = src.Strides[2] = uvStride;
+	Resize(src, x, y, width, height, dst, dstWidth, dstHeight, dstStride, order, filter);
+}
+
+void Preprocessor::Fill(uint8_t* dst, int dstStride, int x, int y, int width, int height, const uint8_t pixel[3])
+{
+	if (width <= 0 || height <= 0)
+		return;
+	uint8_t* first = dst + static_cast<size_t>(y) * dstStride + static_cast<size_t>(x) * 3;
+	for (int c = 0; c < width; c++) {
+		first[3 * c] = pixel[0];
+		first[3 * c + 1] = pixel[1];
+		first[3 * c + 2] = pixel[2];
+	}
+	for (int r = 1; r < height; r++)
+		std::memcpy(first + static_cast<size_t>(r) * dstStride, first, static_cast<size_t>(width) * 3);
+}
+
+#define INSTANTIATE_FORMAT(F) \
+	template void Preprocessor::Convert<F>(const FrameView<F>&, int, int, int, int, uint8_t*, int, ChannelOrder); \
+	template void Preprocessor::Resize<F>(const FrameView<F>&, int, int, int, int, uint8_t*, int, int, int, ChannelOrder, ResizeFilter); \
+	template void Preprocessor::Letterbox<F>(const FrameView<F>&, int, int, int, int, uint8_t*, int, int, int, int, int, int, int, const uint8_t[3], ChannelOrder, ResizeFilter);
+
+INSTANTIATE_FORMAT(PixelFormat::I420)
+INSTANTIATE_FORMAT(PixelFormat::NV12)
+INSTANTIATE_FORMAT(PixelFormat::YUYV)
+INSTANTIATE_FORMAT(PixelFormat::I422)
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include "YuvConverter.h"
+#include "FrameView.h"
+
+enum class ResizeFilter {
+	Bilinear,
+	Area
+};
+
+enum class ResizeMode {
+	// The ROI is scaled to the whole model input, aspect ratio is not preserved.
+	Stretch,
+	// The ROI is scaled uniformly and centered, the remaining bars are filled with the pad color.
+	Letterbox
+};
+
+// Fused crop + resize + color conversion.
+// Samples the source planes directly at the destination grid and writes packed 24-bit pixels,
+// so the ROI is never materialized as a full-resolution BGR image.
+// Per call it only touches small per-thread row buffers that are reused between frames.
+// The templates are instantiated for every PixelFormat in Preprocessor.cpp.
+class Preprocessor {
+public:
+	// Resizes the (x, y, width, height) rectangle of src into dstWidth x dstHeight packed pixels.
+	// Area filtering is used only when downscaling in both directions; otherwise it falls back to bilinear.
+	template<PixelFormat F>
+	static void Resize(const FrameView<F>& src,
+		int x, int y, int width, int height,
+		uint8_t* dst, int dstWidth, int dstHeight, int dstStride,
+		ChannelOrder order, ResizeFilter filter);
+
+	// Converts the (x, y, width, height) rectangle of src without scaling.
+	template<PixelFormat F>
+	static void Convert(const FrameView<F>& src,
+		int x, int y, int width, int height,
+		uint8_t* dst, int dstStride, ChannelOrder order);
+
+	// Resizes the rectangle into the content area of dst and fills the rest with pad (in destination channel order).
+	template<PixelFormat F>
+	static void Letterbox(const FrameView<F>& src,
+		int x, int y, int width, int height,
+		uint8_t* dst, int dstWidth, int dstHeight, int dstStride,
+		int contentX, int contentY, int contentWidth, int contentHeight,
+		const uint8_t pad[3], ChannelOrder order, ResizeFilter filter);
+
+	static void ResizeI420(const uint8_t* yPlane, int yStride,
+		const uint8_t* uPlane, const uint8_t* vPlane, int uvStride,
+		int x, int y, int width, int height,
+		uint8_t* dst, int dstWidth, int dstHeight, int dstStride,
+		ChannelOrder order, ResizeFilter filter);
+
+	// Fills a rectangle of packed 24-bit pixels with a single color, given in destination channel order.
+	static void Fill(uint8_t* dst, int dstStride, int x, int y, int width, int height, const uint8_t pixel[3]);
+};
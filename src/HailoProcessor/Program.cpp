@@ -150,7 +150,14 @@ int main(int argc, char** argv)
     auto frame = YuvFrame::LoadFile(input_path.c_str()).release();
     cout << "File " << input_path << ": " << GREEN << "loaded" << RESET << endl;
 
-    auto p = hailo_processor_load_hef(yolov_hef.c_str());
+    // Anything but a .hef is taken as a capture, so the pipeline can be benchmarked without the device.
+    auto p = std::filesystem::path(yolov_hef).extension() == ".hef"
+        ? hailo_processor_load_hef(yolov_hef.c_str())
+        : hailo_processor_load_replay(yolov_hef.c_str(), 25000, 2000, 0);
+    if (p == nullptr) {
+        std::cerr << get_last_hailo_error() << endl;
+        return 1;
+    }
     cout << "Hef file " << yolov_hef << " ";
     cout << GREEN << "loaded" << RESET << endl;
 
@@ -0,0 +1,210 @@
+#include "ReplayBackend.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include "HailoException.h"
+
+static const char CAPTURE_MAGIC[4] = { 'H', 'R', 'P', 'L' };
+constexpr uint32_t CAPTURE_VERSION = 1;
+constexpr auto READ_TIMEOUT = std::chrono::seconds(1);
+
+template<typename T>
+static void WriteValue(std::ofstream &file, const T &value) {
+	file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+static void ReadValue(std::ifstream &file, T &value) {
+	if (!file.read(reinterpret_cast<char*>(&value), sizeof(T)))
+		throw HailoException(HAILO_FILE_OPERATION_FAILURE);
+}
+
+CaptureBackend::CaptureBackend(std::unique_ptr<InferenceBackend> inner, const std::string &captureFile, int maxFrames)
+	: _inner(std::move(inner)), _file(captureFile, std::ios::binary | std::ios::trunc), _recorded(_inner->OutputCount(), 0), _maxFrames(maxFrames)
+{
+	if (!_file)
+		throw HailoException(HAILO_OPEN_FILE_FAILURE);
+
+	_file.write(CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+	WriteValue(_file, CAPTURE_VERSION);
+	WriteValue(_file, static_cast<uint32_t>(sizeof(hailo_vstream_info_t)));
+	WriteValue(_file, _inner->InputInfo());
+	WriteValue(_file, static_cast<uint64_t>(_inner->InputFrameSize()));
+	WriteValue(_file, static_cast<uint32_t>(_inner->OutputCount()));
+	for (size_t i = 0; i < _inner->OutputCount(); i++) {
+		WriteValue(_file, _inner->OutputInfo(i));
+		WriteValue(_file, static_cast<uint64_t>(_inner->OutputFrameSize(i)));
+	}
+}
+
+const hailo_vstream_info_t& CaptureBackend::InputInfo() const { return _inner->InputInfo(); }
+size_t CaptureBackend::InputFrameSize() const { return _inner->InputFrameSize(); }
+size_t CaptureBackend::OutputCount() const { return _inner->OutputCount(); }
+const hailo_vstream_info_t& CaptureBackend::OutputInfo(size_t output) const { return _inner->OutputInfo(output); }
+size_t CaptureBackend::OutputFrameSize(size_t output) const { return _inner->OutputFrameSize(output); }
+
+hailo_status CaptureBackend::Write(const uint8_t *data, size_t size)
+{
+	return _inner->Write(data, size);
+}
+
+hailo_status CaptureBackend::Read(size_t output, uint8_t *data, size_t size)
+{
+	auto status = _inner->Read(output, data, size);
+	if (status != HAILO_SUCCESS)
+		return status;
+
+	std::lock_guard<std::mutex> lock(_fileMx);
+	if (_maxFrames > 0 && _recorded[output] >= _maxFrames)
+		return status;
+	_recorded[output]++;
+	WriteValue(_file, static_cast<uint32_t>(output));
+	_file.write(reinterpret_cast<const char*>(data), size);
+	return status;
+}
+
+void CaptureBackend::Abort()
+{
+	_inner->Abort();
+	std::lock_guard<std::mutex> lock(_fileMx);
+	_file.flush();
+}
+
+ReplayBackend::ReplayBackend(std::chrono::microseconds latency, std::chrono::microseconds jitter, uint32_t seed, size_t depth)
+	: _inputFrameSize(0), _frameCount(0), _latency(latency), _jitter(jitter), _random(seed), _depth(std::max<size_t>(depth, 1))
+{
+}
+
+std::unique_ptr<ReplayBackend> ReplayBackend::Load(const std::string &captureFile,
+	std::chrono::microseconds latency, std::chrono::microseconds jitter, uint32_t seed, size_t depth)
+{
+	std::ifstream file(captureFile, std::ios::binary);
+	if (!file)
+		throw HailoException(HAILO_OPEN_FILE_FAILURE);
+
+	char magic[4];
+	uint32_t version, infoSize, outputCount;
+	uint64_t frameSize;
+	if (!file.read(magic, sizeof(magic)) || memcmp(magic, CAPTURE_MAGIC, sizeof(magic)) != 0)
+		throw HailoException("Not a capture file: " + captureFile);
+	ReadValue(file, version);
+	ReadValue(file, infoSize);
+	if (version != CAPTURE_VERSION || infoSize != sizeof(hailo_vstream_info_t))
+		throw HailoException("Capture file was recorded with an incompatible version: " + captureFile);
+
+	std::unique_ptr<ReplayBackend> backend(new ReplayBackend(latency, jitter, seed, depth));
+	ReadValue(file, backend->_inputInfo);
+	ReadValue(file, frameSize);
+	backend->_inputFrameSize = frameSize;
+
+	ReadValue(file, outputCount);
+	backend->_outputs.resize(outputCount);
+	for (auto &output : backend->_outputs) {
+		ReadValue(file, output.Info);
+		ReadValue(file, frameSize);
+		output.FrameSize = frameSize;
+	}
+
+	uint32_t index;
+	while (file.read(reinterpret_cast<char*>(&index), sizeof(index))) {
+		if (index >= outputCount)
+			throw HailoException(HAILO_FILE_OPERATION_FAILURE);
+		auto &output = backend->_outputs[index];
+		std::vector<uint8_t> frame(output.FrameSize);
+		if (!file.read(reinterpret_cast<char*>(frame.data()), frame.size()))
+			break; // capture cut short while recording, keep what is complete.
+		output.Frames.push_back(std::move(frame));
+	}
+
+	size_t frames = SIZE_MAX;
+	for (auto &output : backend->_outputs)
+		frames = std::min(frames, output.Frames.size());
+	if (outputCount == 0 || frames == 0)
+		throw HailoException("Capture file has no frames: " + captureFile);
+	backend->_frameCount = frames;
+
+	std::cout << "Replay of " << frames << " frames loaded from " << captureFile << std::endl;
+	return backend;
+}
+
+const hailo_vstream_info_t& ReplayBackend::InputInfo() const { return _inputInfo; }
+size_t ReplayBackend::InputFrameSize() const { return _inputFrameSize; }
+size_t ReplayBackend::OutputCount() const { return _outputs.size(); }
+const hailo_vstream_info_t& ReplayBackend::OutputInfo(size_t output) const { return _outputs[output].Info; }
+size_t ReplayBackend::OutputFrameSize(size_t output) const { return _outputs[output].FrameSize; }
+
+uint64_t ReplayBackend::Consumed() const
+{
+	uint64_t consumed = UINT64_MAX;
+	for (auto &output : _outputs)
+		consumed = std::min(consumed, output.ReadCount);
+	return consumed;
+}
+
+hailo_status ReplayBackend::Write(const uint8_t *data, size_t size)
+{
+	if (size != _inputFrameSize)
+		return HAILO_INVALID_ARGUMENT;
+
+	std::unique_lock<std::mutex> lock(_mx);
+	_cv.wait(lock, [this]() { return _aborted || _written - Consumed() < _depth; });
+	if (_aborted)
+		return HAILO_STREAM_ABORT;
+
+	auto now = Clock::now();
+	auto start = _ready.empty() ? now : std::max(now, _ready.back());
+	std::chrono::microseconds jitter(0);
+	if (_jitter.count() > 0)
+		jitter = std::chrono::microseconds(std::uniform_int_distribution<int64_t>(0, _jitter.count())(_random));
+
+	_ready.push_back(start + _latency + jitter);
+	_written++;
+	_cv.notify_all();
+	return HAILO_SUCCESS;
+}
+
+hailo_status ReplayBackend::Read(size_t output, uint8_t *data, size_t size)
+{
+	auto &stream = _outputs[output];
+	if (size != stream.FrameSize)
+		return HAILO_INVALID_ARGUMENT;
+
+	std::unique_lock<std::mutex> lock(_mx);
+	auto deadline = Clock::now() + READ_TIMEOUT;
+	while (true) {
+		if (_aborted)
+			return HAILO_STREAM_ABORT;
+		if (stream.ReadCount < _written) {
+			auto ready = _ready[stream.ReadCount - _readyBase];
+			if (ready <= Clock::now())
+				break;
+			if (ready > deadline) {
+				_cv.wait_until(lock, deadline);
+				return HAILO_TIMEOUT;
+			}
+			_cv.wait_until(lock, ready);
+		}
+		else if (_cv.wait_until(lock, deadline) == std::cv_status::timeout)
+			return HAILO_TIMEOUT;
+	}
+
+	auto &frame = stream.Frames[stream.ReadCount % _frameCount];
+	memcpy(data, frame.data(), size);
+	stream.ReadCount++;
+
+	auto consumed = Consumed();
+	while (_readyBase < consumed) {
+		_ready.pop_front();
+		_readyBase++;
+	}
+	_cv.notify_all();
+	return HAILO_SUCCESS;
+}
+
+void ReplayBackend::Abort()
+{
+	std::lock_guard<std::mutex> lock(_mx);
+	_aborted = true;
+	_cv.notify_all();
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "InferenceBackend.h"
+
+// Records the raw output tensors of another backend to a capture file, so a session on the device
+// can be replayed later on a machine without one. Stream infos (shape, quantization) are stored in the header.
+// Capture layout: "HRPL", version, sizeof(hailo_vstream_info_t), input info + frame size, output count,
+// output infos + frame sizes, then records of (uint32 output index, frame bytes) in read order.
+class CaptureBackend : public InferenceBackend {
+public:
+	// maxFrames limits the number of frames recorded per output, 0 means unlimited.
+	CaptureBackend(std::unique_ptr<InferenceBackend> inner, const std::string& captureFile, int maxFrames);
+
+	const hailo_vstream_info_t& InputInfo() const override;
+	size_t InputFrameSize() const override;
+	size_t OutputCount() const override;
+	const hailo_vstream_info_t& OutputInfo(size_t output) const override;
+	size_t OutputFrameSize(size_t output) const override;
+	hailo_status Write(const uint8_t* data, size_t size) override;
+	hailo_status Read(size_t output, uint8_t* data, size_t size) override;
+	void Abort() override;
+
+private:
+	std::unique_ptr<InferenceBackend> _inner;
+	std::mutex _fileMx;
+	std::ofstream _file;
+	std::vector<int> _recorded;
+	int _maxFrames;
+};
+
+// Stand-in for the NPU that serves recorded output tensors with a modeled latency.
+// The device is modeled as a single server: frame k is ready at max(written_k, ready_k-1) + latency + jitter_k,
+// jitter is drawn from a seeded generator, so two runs with the same input timing produce the same output timing.
+// Frames are served round-robin from the capture, whatever the input is.
+// Like the device, Write blocks once 'depth' frames are in flight.
+class ReplayBackend : public InferenceBackend {
+public:
+	static std::unique_ptr<ReplayBackend> Load(const std::string& captureFile,
+		std::chrono::microseconds latency, std::chrono::microseconds jitter, uint32_t seed = 0, size_t depth = 4);
+
+	const hailo_vstream_info_t& InputInfo() const override;
+	size_t InputFrameSize() const override;
+	size_t OutputCount() const override;
+	const hailo_vstream_info_t& OutputInfo(size_t output) const override;
+	size_t OutputFrameSize(size_t output) const override;
+	hailo_status Write(const uint8_t* data, size_t size) override;
+	hailo_status Read(size_t output, uint8_t* data, size_t size) override;
+	void Abort() override;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+	struct Output {
+		hailo_vstream_info_t Info;
+		size_t FrameSize;
+		std::vector<std::vector<uint8_t>> Frames;
+		uint64_t ReadCount = 0;
+	};
+
+	ReplayBackend(std::chrono::microseconds latency, std::chrono::microseconds jitter, uint32_t seed, size_t depth);
+	uint64_t Consumed() const;
+
+	hailo_vstream_info_t _inputInfo;
+	size_t _inputFrameSize;
+	std::vector<Output> _outputs;
+	size_t _frameCount;
+
+	std::chrono::microseconds _latency;
+	std::chrono::microseconds _jitter;
+	std::mt19937 _random;
+	size_t _depth;
+
+	std::mutex _mx;
+	std::condition_variable _cv;
+	// ready times of frames written and not yet read by every output, the front one is frame _readyBase.
+	std::deque<Clock::time_point> _ready;
+	uint64_t _readyBase = 0;
+	uint64_t _written = 0;
+	bool _aborted = false;
+};
@@ -1,7 +1,9 @@
 #include "StageStats.h"
+#include <algorithm>
+#include "ThreadShard.h"
 
 
-StageStats::StageStats(int threadCount, StageStats *prvStage) : _total(0),_dropped(0), _processed(0) {
+StageStats::StageStats(int threadCount, StageStats *prvStage) : _total(0),_dropped(0), _processed(0), _rates(new RateShard[RateShards]) {
     _prvStage = prvStage;
     _threadCount = threadCount;
 }
@@ -11,11 +13,22 @@ void StageStats::FrameProcessed(const std::chrono::nanoseconds &duration, unsign
     _processed.fetch_add(1, std::memory_order_relaxed);
     _total.fetch_add(duration.count(), std::memory_order_relaxed);
     _lastIteration.store(iteration);
+    _latency.Record(duration);
+    if (PerfCounters::Enabled())
+        _perf.Frames.fetch_add(1, std::memory_order_relaxed);
+    _rates[ThreadShard(RateShards)].Processed.Add(WindowedCounter::Now());
+
+    auto prv = _serviceTime.load(std::memory_order_relaxed);
+    std::chrono::nanoseconds::rep next;
+    do {
+        next = prv == 0 ? duration.count() : prv + (duration.count() - prv) / 8;
+    } while (!_serviceTime.compare_exchange_weak(prv, next, std::memory_order_relaxed));
 }
 
 // Method to record when a frame is dropped
 void StageStats::FrameDropped(unsigned long iteration) {
     _dropped.fetch_add(1, std::memory_order_relaxed);
+    _rates[ThreadShard(RateShards)].Dropped.Add(WindowedCounter::Now());
     _lastIteration.store(iteration);
 }
 
@@ -70,6 +83,39 @@ float StageStats::Fps() const {
     return result * _threadCount;
 }
 
+float StageStats::ProcessedRate(std::chrono::seconds window) const {
+    return Rate(&RateShard::Processed, window);
+}
+
+float StageStats::DroppedRate(std::chrono::seconds window) const {
+    return Rate(&RateShard::Dropped, window);
+}
+
+float StageStats::Rate(WindowedCounter RateShard::*counter, std::chrono::seconds window) const {
+    const int seconds = std::clamp<int>(static_cast<int>(window.count()), 1, WindowedCounter::MaxWindow);
+    const uint64_t now = WindowedCounter::Now();
+    uint64_t sum = 0;
+    for (int i = 0; i < RateShards; i++)
+        sum += (_rates[i].*counter).Sum(now, seconds);
+    return static_cast<float>(sum) / static_cast<float>(seconds);
+}
+
+std::chrono::nanoseconds StageStats::ServiceTime() const {
+    return std::chrono::nanoseconds(_serviceTime.load(std::memory_order_relaxed));
+}
+
+LatencyHistogram& StageStats::Latency() {
+    return _latency;
+}
+
+StagePerfStats& StageStats::Perf() {
+    return _perf;
+}
+
+const StagePerfStats& StageStats::Perf() const {
+    return _perf;
+}
+
 // Calculate and return the average frame processing time in milliseconds
 std::chrono::milliseconds StageStats::FrameProcessingTime() const {
     auto p = Processed();
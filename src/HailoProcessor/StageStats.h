@@ -3,6 +3,10 @@
 #include <chrono>
 #include <atomic>
 #include <cstdint>
+#include <memory>
+#include "LatencyHistogram.h"
+#include "WindowedCounter.h"
+#include "PerfCounters.h"
 
 class StageStats {
 public:
@@ -18,8 +22,20 @@ public:
     uint64_t Behind() const;
     int ThreadCount() const;
     std::chrono::nanoseconds Total() const;
+    // Frames per second the stage could sustain at its lifetime average processing time, not what it delivers; see ProcessedRate.
     float Fps() const;
+    // Observed frames per second over the last window (whole seconds, at most WindowedCounter::MaxWindow).
+    float ProcessedRate(std::chrono::seconds window) const;
+    float DroppedRate(std::chrono::seconds window) const;
     std::chrono::milliseconds FrameProcessingTime() const;
+    // Exponentially weighted moving average of the frame processing time, each frame weighs 1/8.
+    // Follows load changes within a few frames, unlike the lifetime average.
+    std::chrono::nanoseconds ServiceTime() const;
+    // Distribution of the frame processing time, for percentiles.
+    LatencyHistogram& Latency();
+    // Hardware counters of the stage's PerfScopes, see PerfCounters.
+    StagePerfStats& Perf();
+    const StagePerfStats& Perf() const;
 private:
     StageStats* _prvStage;
     int _threadCount;
@@ -27,6 +43,17 @@ private:
     std::atomic<uint64_t> _processed{0};
     std::atomic<uint64_t> _lastIteration{0};
     std::atomic<std::chrono::nanoseconds::rep> _total{0};
+    std::atomic<std::chrono::nanoseconds::rep> _serviceTime{0};
+    LatencyHistogram _latency;
+    StagePerfStats _perf;
+    // per thread, so stages with many workers do not share the counters' cache lines.
+    static constexpr int RateShards = 8;
+    struct alignas(64) RateShard {
+        WindowedCounter Processed;
+        WindowedCounter Dropped;
+    };
+    std::unique_ptr<RateShard[]> _rates;
+    float Rate(WindowedCounter RateShard::*counter, std::chrono::seconds window) const;
 };
 
 #endif //STAGESTATS_H
@@ -0,0 +1,63 @@
+#include "TensorRing.h"
+
+TensorRing::TensorRing(size_t slots, const std::vector<size_t> &frameSizes)
+	: _slots(slots), _outputs(frameSizes.size())
+{
+	for (size_t i = 0; i < slots; i++) {
+		auto &slot = _slots[i];
+		slot.Frame = i;
+		slot.Missing = _outputs;
+		for (auto size : frameSizes)
+			slot.Buffers.emplace_back(size);
+	}
+}
+
+size_t TensorRing::Slots() const
+{
+	return _slots.size();
+}
+
+uint8_t* TensorRing::AcquireWrite(size_t output, uint64_t frame)
+{
+	auto &slot = _slots[frame % _slots.size()];
+	std::unique_lock<std::mutex> lock(_mx);
+	// the slot still holds frame - Slots() until post-processing releases it.
+	_cv.wait(lock, [this, &slot, frame]() { return _aborted || slot.Frame == frame; });
+	if (_aborted)
+		return nullptr;
+	return slot.Buffers[output].data();
+}
+
+int TensorRing::CompleteWrite(size_t output, uint64_t frame)
+{
+	int index = static_cast<int>(frame % _slots.size());
+	std::lock_guard<std::mutex> lock(_mx);
+	if (--_slots[index].Missing > 0)
+		return -1;
+	return index;
+}
+
+uint8_t* TensorRing::Buffer(int slot, size_t output)
+{
+	return _slots[slot].Buffers[output].data();
+}
+
+void TensorRing::Release(int slot)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mx);
+		auto &s = _slots[slot];
+		s.Frame += _slots.size();
+		s.Missing = _outputs;
+	}
+	_cv.notify_all();
+}
+
+void TensorRing::Abort()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mx);
+		_aborted = true;
+	}
+	_cv.notify_all();
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "Allocator.h"
+
+// Ring of complete output tensor sets, one slot per frame in flight.
+// Frame n of every output is read into slot n % Slots(); once the last output of a frame is in,
+// the slot is handed to one post-processing worker and stays untouched until it is released.
+// Workers never share buffers, so any number of them can run at once;
+// readers only wait when every slot is still being post-processed.
+class TensorRing {
+public:
+	TensorRing(size_t slots, const std::vector<size_t>& frameSizes);
+
+	size_t Slots() const;
+
+	// Buffer for 'output' of device frame 'frame'. Blocks until the slot is released; nullptr after Abort.
+	uint8_t* AcquireWrite(size_t output, uint64_t frame);
+	// Marks 'output' of 'frame' as read. Returns the slot when the frame is complete, -1 otherwise.
+	int CompleteWrite(size_t output, uint64_t frame);
+
+	uint8_t* Buffer(int slot, size_t output);
+	void Release(int slot);
+	void Abort();
+
+private:
+	struct Slot {
+		std::vector<PooledBytes> Buffers;
+		uint64_t Frame;
+		size_t Missing;
+	};
+
+	std::vector<Slot> _slots;
+	size_t _outputs;
+	bool _aborted = false;
+	std::mutex _mx;
+	std::condition_variable _cv;
+};
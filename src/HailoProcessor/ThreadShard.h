@@ -0,0 +1,12 @@
+#pragma once
+
+#include <atomic>
+
+// Index of the calling thread among shards, fixed for the thread's lifetime. Threads are numbered in the order they
+// first ask, so the few pipeline threads of a processor mostly land on shards of their own.
+inline int ThreadShard(int shards)
+{
+	static std::atomic<int> next{0};
+	thread_local const int ordinal = next.fetch_add(1, std::memory_order_relaxed);
+	return ordinal % shards;
+}
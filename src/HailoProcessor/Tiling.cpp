@@ -0,0 +1,106 @@
+#include "Tiling.h"
+
+#include <algorithm>
+#include <cmath>
+#include "Nms.h"
+
+namespace {
+
+// Start offsets and length of n tiles covering [0, length) with the given overlap.
+// Offsets are even, so chroma of I420 tiles starts on a sample boundary. The tile length has the parity of length,
+// so the last offset, length - tileLength, is even too and the last tile ends exactly at length.
+std::vector<int> Split(int length, int n, float overlap, int& tileLength)
+{
+	n = std::max(n, 1);
+	double size = length / (n - (n - 1) * static_cast<double>(overlap));
+	tileLength = std::min(length, ((static_cast<int>(std::ceil(size)) + 1) & ~1) + (length & 1));
+	std::vector<int> offsets(n);
+	for (int i = 0; i < n; i++) {
+		int offset = n == 1 ? 0 : static_cast<int>(std::lround(i * (length - tileLength) / static_cast<double>(n - 1)));
+		offsets[i] = offset & ~1;
+	}
+	return offsets;
+}
+
+}
+
+std::vector<cv::Rect> TileGrid::Tiles(const cv::Rect& area) const
+{
+	float overlap = std::clamp(Overlap, 0.0f, 0.49f);
+	int tileWidth, tileHeight;
+	auto xs = Split(area.width, Columns, overlap, tileWidth);
+	auto ys = Split(area.height, Rows, overlap, tileHeight);
+
+	std::vector<cv::Rect> tiles;
+	tiles.reserve(xs.size() * ys.size());
+	for (int y : ys)
+		for (int x : xs)
+			tiles.emplace_back(area.x + x, area.y + y, tileWidth, tileHeight);
+	return tiles;
+}
+
+TileGroup::TileGroup(const FrameIdentifier& id, const cv::Rect& area, float threshold, int count, float mergeThreshold)
+	: _context(FrameContext::Rent(id, area, threshold)), _mergeThreshold(mergeThreshold), _remaining(count)
+{
+	_context->Total.Start();
+	_results.reserve(count);
+}
+
+TileGroup::~TileGroup()
+{
+	// only set when the group never completed.
+	FrameContext::Return(_context);
+	for (auto r : _results)
+		SegmentationResult::Return(r);
+}
+
+FrameContext* TileGroup::Complete(SegmentationResult* tileResult, uint64_t iteration)
+{
+	if (tileResult != nullptr) {
+		std::lock_guard<std::mutex> lock(_mx);
+		_results.emplace_back(tileResult);
+	}
+	if (_remaining.fetch_sub(1, std::memory_order_acq_rel) != 1)
+		return nullptr;
+
+	// last one in, no other thread touches _results anymore.
+	FrameContext* context = _context;
+	_context = nullptr;
+	context->Iteration = iteration;
+	if (_results.empty())
+		return context;
+	context->Result = Merge(context->Id, context->Roi, context->Threshold, _results, _mergeThreshold);
+	for (auto r : _results)
+		SegmentationResult::Return(r);
+	_results.clear();
+	return context;
+}
+
+SegmentationResult* TileGroup::Merge(const FrameIdentifier& id, const cv::Rect& area, float threshold,
+	const std::vector<SegmentationResult*>& results, float mergeThreshold)
+{
+	std::vector<Segment*> segments;
+	BoxSet boxes;
+	auto merged = SegmentationResult::Rent(id, area, threshold);
+	for (auto& r : results) {
+		for (int i = 0; i < r->Count(); i++) {
+			Segment& s = r->Get(i);
+			cv::Rect2f box = s.FrameBbox();
+			segments.push_back(&s);
+			boxes.Add(box.x, box.y, box.x + box.width, box.y + box.height, s.Confidence, s.ClassId);
+		}
+		for (int i = 0; i < r->UncertainCounter(); i++)
+			merged->IncrementUncertainCounter();
+	}
+
+	// a detection cut by a tile border is nested in the full one from the neighbouring tile, hence intersection over the smaller box.
+	NmsOptions options;
+	options.Threshold = mergeThreshold;
+	options.Mode = NmsMode::ClassAware;
+	options.Overlap = NmsOverlap::IntersectionOverSmaller;
+	std::vector<int> keep;
+	Nms::Run(boxes, options, keep);
+	for (int k : keep)
+		merged->Add(*segments[k]);
+	return merged;
+}
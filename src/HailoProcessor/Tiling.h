@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "Frame.h"
+#include "FrameIdentifier.h"
+
+// Splits a frame region into an evenly spaced grid of overlapping tiles.
+struct TileGrid {
+	int Columns = 2;
+	int Rows = 2;
+	// Fraction of a tile shared with its neighbour, in [0, 0.5).
+	float Overlap = 0.2f;
+	// Two detections of the same class are merged when intersection / smaller area reaches this.
+	float MergeThreshold = 0.5f;
+
+	std::vector<cv::Rect> Tiles(const cv::Rect& area) const;
+};
+
+// Gathers the per-tile results of one frame.
+// Every tile context holds a reference; the last tile to complete (or to be dropped)
+// merges the detections in frame coordinates and receives the frame-level context for the callback.
+class TileGroup {
+public:
+	TileGroup(const FrameIdentifier& id, const cv::Rect& area, float threshold, int count, float mergeThreshold);
+	~TileGroup();
+
+	// Takes ownership of tileResult, which is nullptr when the tile was dropped.
+	// Returns the frame context when this was the last outstanding tile, nullptr otherwise.
+	// Its Result stays nullptr when every tile was dropped.
+	FrameContext* Complete(SegmentationResult* tileResult, uint64_t iteration);
+
+	static SegmentationResult* Merge(const FrameIdentifier& id, const cv::Rect& area, float threshold,
+		const std::vector<SegmentationResult*>& results, float mergeThreshold);
+private:
+	FrameContext* _context;
+	const float _mergeThreshold;
+	std::atomic_int _remaining;
+	std::mutex _mx;
+	// pooled, returned once merged.
+	std::vector<SegmentationResult*> _results;
+};
@@ -0,0 +1,156 @@
+#include "Tracer.h"
+
+#include <vector>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char* StageName(TraceStage stage)
+{
+	switch (stage) {
+		case TraceStage::Write: return "Write";
+		case TraceStage::InferenceAndRead: return "InferenceAndRead";
+		case TraceStage::PostProcessing: return "PostProcessing";
+		case TraceStage::Callback: return "Callback";
+		case TraceStage::Total: return "Total";
+		case TraceStage::Tile: return "Tile";
+	}
+	return "Unknown";
+}
+
+uint32_t ThreadId()
+{
+#if defined(__linux__)
+	thread_local const uint32_t id = static_cast<uint32_t>(syscall(SYS_gettid));
+#else
+	static std::atomic<uint32_t> next{1};
+	thread_local const uint32_t id = next.fetch_add(1, std::memory_order_relaxed);
+#endif
+	return id;
+}
+
+uint32_t ProcessId()
+{
+#if defined(__linux__)
+	return static_cast<uint32_t>(getpid());
+#else
+	return 1;
+#endif
+}
+
+int64_t Now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Span {
+	int64_t Begin;
+	int64_t End;
+	uint64_t FrameId;
+	uint64_t Iteration;
+	uint64_t Source;
+	TraceStage Stage;
+};
+
+// Chrome expects microseconds; nanoseconds stay as the fraction.
+void WriteTimestamp(std::ostream& out, int64_t ns)
+{
+	out << ns / 1000 << '.';
+	const int64_t fraction = ns % 1000;
+	out << static_cast<char>('0' + fraction / 100) << static_cast<char>('0' + fraction / 10 % 10) << static_cast<char>('0' + fraction % 10);
+}
+
+}
+
+Tracer::Tracer() = default;
+
+Tracer::~Tracer()
+{
+	delete[] _slots.load(std::memory_order_relaxed);
+}
+
+void Tracer::Enable(bool value)
+{
+	if (value && _slots.load(std::memory_order_acquire) == nullptr) {
+		Slot* slots = new Slot[Capacity];
+		Slot* expected = nullptr;
+		if (!_slots.compare_exchange_strong(expected, slots, std::memory_order_acq_rel))
+			delete[] slots;
+	}
+	_enabled.store(value, std::memory_order_relaxed);
+}
+
+void Tracer::Record(TraceStage stage, std::chrono::nanoseconds duration, uint32_t cameraId, uint64_t frameId, uint64_t iteration)
+{
+	Slot* slots = _slots.load(std::memory_order_acquire);
+	if (slots == nullptr)
+		return;
+	const int64_t end = Now();
+	const uint64_t index = _next.fetch_add(1, std::memory_order_relaxed);
+	Slot& slot = slots[index & (Capacity - 1)];
+	slot.Sequence.store(2 * index + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.Begin.store(end - duration.count(), std::memory_order_relaxed);
+	slot.End.store(end, std::memory_order_relaxed);
+	slot.FrameId.store(frameId, std::memory_order_relaxed);
+	slot.Iteration.store(iteration, std::memory_order_relaxed);
+	slot.Source.store(static_cast<uint64_t>(cameraId) << 32 | ThreadId(), std::memory_order_relaxed);
+	slot.Stage.store(static_cast<uint8_t>(stage), std::memory_order_relaxed);
+	slot.Sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+size_t Tracer::Export(std::ostream& out, std::chrono::nanoseconds window) const
+{
+	std::vector<Span> spans;
+	const Slot* slots = _slots.load(std::memory_order_acquire);
+	const int64_t since = window.count() > 0 ? Now() - window.count() : INT64_MIN;
+	if (slots != nullptr) {
+		spans.reserve(Capacity);
+		for (size_t i = 0; i < Capacity; i++) {
+			const Slot& slot = slots[i];
+			const uint64_t sequence = slot.Sequence.load(std::memory_order_acquire);
+			if (sequence == 0 || (sequence & 1) != 0)
+				continue;
+			Span span{slot.Begin.load(std::memory_order_relaxed), slot.End.load(std::memory_order_relaxed),
+				slot.FrameId.load(std::memory_order_relaxed), slot.Iteration.load(std::memory_order_relaxed),
+				slot.Source.load(std::memory_order_relaxed), static_cast<TraceStage>(slot.Stage.load(std::memory_order_relaxed))};
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (slot.Sequence.load(std::memory_order_relaxed) != sequence || span.End < since)
+				continue;
+			spans.push_back(span);
+		}
+	}
+
+	const uint32_t pid = ProcessId();
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool first = true;
+	for (const Span& span : spans) {
+		const uint32_t cameraId = static_cast<uint32_t>(span.Source >> 32);
+		const uint32_t tid = static_cast<uint32_t>(span.Source);
+		out << (first ? "\n" : ",\n");
+		first = false;
+		if (span.Stage == TraceStage::Total) {
+			// a begin/end pair per frame; the id keeps overlapping frames of a camera apart.
+			for (const char* phase : {"b", "e"}) {
+				out << "{\"name\":\"Frame\",\"cat\":\"camera " << cameraId << "\",\"ph\":\"" << phase << "\",\"id\":" << span.Iteration
+					<< ",\"pid\":" << pid << ",\"tid\":" << tid << ",\"ts\":";
+				WriteTimestamp(out, phase[0] == 'b' ? span.Begin : span.End);
+				if (phase[0] == 'b')
+					out << ",\"args\":{\"camera\":" << cameraId << ",\"frame\":" << span.FrameId << ",\"iteration\":" << span.Iteration << "}},\n";
+				else
+					out << "}";
+			}
+			continue;
+		}
+		out << "{\"name\":\"" << StageName(span.Stage) << "\",\"cat\":\"pipeline\",\"ph\":\"X\",\"pid\":" << pid << ",\"tid\":" << tid << ",\"ts\":";
+		WriteTimestamp(out, span.Begin);
+		out << ",\"dur\":";
+		WriteTimestamp(out, span.End - span.Begin);
+		out << ",\"args\":{\"camera\":" << cameraId << ",\"frame\":" << span.FrameId << ",\"iteration\":" << span.Iteration << "}}";
+	}
+	out << "\n]}\n";
+	return spans.size();
+}
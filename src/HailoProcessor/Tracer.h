@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+
+// The spans of one frame; Write covers preprocessing, the camera queue and the device write.
+enum class TraceStage : uint8_t {
+	Write = 0,
+	InferenceAndRead = 1,
+	PostProcessing = 2,
+	Callback = 3,
+	// from Write to the end of the callback, or of the tile's postprocessing.
+	Total = 4,
+	Tile = 5
+};
+
+// Opt-in record of per-frame stage spans, in a ring of the last Capacity spans that writers never wait on.
+// Off by default; call sites test Enabled() first, so a disabled tracer costs one relaxed load and a branch.
+// Each slot is a seqlock on a cache line of its own: a reader skips the slots being overwritten while it copies them.
+class Tracer {
+public:
+	static constexpr size_t Capacity = 1 << 16;
+
+	Tracer();
+	~Tracer();
+	Tracer(const Tracer&) = delete;
+	Tracer& operator=(const Tracer&) = delete;
+
+	// The ring is allocated on the first Enable and kept until destruction.
+	void Enable(bool value);
+	bool Enabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+	// A span of the calling thread that ended now and lasted duration.
+	void Record(TraceStage stage, std::chrono::nanoseconds duration, uint32_t cameraId, uint64_t frameId, uint64_t iteration);
+
+	// Chrome trace-event JSON (loads in Perfetto and chrome://tracing) of the spans that ended within window, all when zero.
+	// Stage spans are complete events on the thread that ended them; Total spans are async events per camera,
+	// since frames of one camera overlap. Returns the number of spans written.
+	size_t Export(std::ostream& out, std::chrono::nanoseconds window) const;
+private:
+	struct alignas(64) Slot {
+		// 2 * index + 1 while written, 2 * index + 2 once complete, 0 never written.
+		std::atomic<uint64_t> Sequence{0};
+		std::atomic<int64_t> Begin{0};
+		std::atomic<int64_t> End{0};
+		std::atomic<uint64_t> FrameId{0};
+		std::atomic<uint64_t> Iteration{0};
+		// cameraId << 32 | thread id.
+		std::atomic<uint64_t> Source{0};
+		std::atomic<uint8_t> Stage{0};
+	};
+
+	std::atomic<bool> _enabled{false};
+	std::atomic<Slot*> _slots{nullptr};
+	alignas(64) std::atomic<uint64_t> _next{0};
+};
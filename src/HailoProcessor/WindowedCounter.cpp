@@ -0,0 +1,40 @@
+#include "WindowedCounter.h"
+
+#include <chrono>
+#if defined(__linux__)
+#include <ctime>
+#endif
+
+void WindowedCounter::Add(uint64_t second, uint64_t count)
+{
+	std::atomic<uint64_t>& slot = _slots[second % Seconds];
+	const uint64_t epoch = second << CountBits;
+	uint64_t current = slot.load(std::memory_order_relaxed);
+	uint64_t next;
+	do {
+		next = (current & ~CountMask) == epoch ? current + count : epoch | count;
+	} while (!slot.compare_exchange_weak(current, next, std::memory_order_relaxed));
+}
+
+uint64_t WindowedCounter::Sum(uint64_t second, int seconds) const
+{
+	uint64_t sum = 0;
+	for (uint64_t s = second > uint64_t(seconds) ? second - seconds : 0; s < second; s++) {
+		const uint64_t value = _slots[s % Seconds].load(std::memory_order_relaxed);
+		if ((value & ~CountMask) == s << CountBits)
+			sum += value & CountMask;
+	}
+	return sum;
+}
+
+uint64_t WindowedCounter::Now()
+{
+#if defined(__linux__)
+	// a few ns from the vDSO, cheaper than CLOCK_MONOTONIC; both count from the same origin.
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+	return static_cast<uint64_t>(ts.tv_sec);
+#else
+	return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
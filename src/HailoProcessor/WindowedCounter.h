@@ -0,0 +1,25 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Counts per second of the last minute, for rates over sliding windows of whole seconds.
+// Each slot carries the second it counts, so a writer entering a new second starts its slot over without a timer thread.
+class WindowedCounter {
+public:
+	static constexpr int Seconds = 64;
+	// the current second is still being counted; one more slot is spare for writers late by a second.
+	static constexpr int MaxWindow = Seconds - 2;
+
+	void Add(uint64_t second, uint64_t count = 1);
+	// Sum over the whole seconds [second - seconds, second).
+	uint64_t Sum(uint64_t second, int seconds) const;
+
+	// Seconds of the monotonic clock, at the resolution of a scheduler tick.
+	static uint64_t Now();
+private:
+	static constexpr int CountBits = 40;
+	static constexpr uint64_t CountMask = (uint64_t(1) << CountBits) - 1;
+
+	std::atomic<uint64_t> _slots[Seconds]{};
+};
@@ -0,0 +1,272 @@
+#include "YuvConverter.h"
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+// Every kernel below computes, per pixel:
+//   r = (298 * (y - 16) + 409 * (v - 128) + 128) >> 8
+//   g = (298 * (y - 16) - 100 * (u - 128) - 208 * (v - 128) + 128) >> 8
+//   b = (298 * (y - 16) + 516 * (u - 128) + 128) >> 8
+// in 32-bit lanes, and saturates to [0, 255] on narrowing - the same as YuvColor::ToRgb.
+// Chroma terms are computed once per pixel pair and duplicated.
+
+namespace {
+
+#if defined(__ARM_NEON)
+
+constexpr int VectorPixels = 16;
+
+inline uint8x8_t NarrowToBytes(int32x4_t a, int32x4_t b) {
+	return vqmovun_s16(vcombine_s16(vqshrn_n_s32(a, 8), vqshrn_n_s32(b, 8)));
+}
+
+template<ChannelOrder order>
+inline void ConvertBlock(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst) {
+	uint8x16_t yv = vld1q_u8(y);
+	int16x8_t d = vreinterpretq_s16_u16(vsubl_u8(vld1_u8(u), vdup_n_u8(128)));
+	int16x8_t e = vreinterpretq_s16_u16(vsubl_u8(vld1_u8(v), vdup_n_u8(128)));
+
+	// chroma terms for 8 pixel pairs
+	int32x4_t rvLo = vmull_n_s16(vget_low_s16(e), 409);
+	int32x4_t rvHi = vmull_n_s16(vget_high_s16(e), 409);
+	int32x4_t guvLo = vmlal_n_s16(vmull_n_s16(vget_low_s16(d), -100), vget_low_s16(e), -208);
+	int32x4_t guvHi = vmlal_n_s16(vmull_n_s16(vget_high_s16(d), -100), vget_high_s16(e), -208);
+	int32x4_t buLo = vmull_n_s16(vget_low_s16(d), 516);
+	int32x4_t buHi = vmull_n_s16(vget_high_s16(d), 516);
+
+	int32x4_t rv[4] = { vzip1q_s32(rvLo, rvLo), vzip2q_s32(rvLo, rvLo), vzip1q_s32(rvHi, rvHi), vzip2q_s32(rvHi, rvHi) };
+	int32x4_t guv[4] = { vzip1q_s32(guvLo, guvLo), vzip2q_s32(guvLo, guvLo), vzip1q_s32(guvHi, guvHi), vzip2q_s32(guvHi, guvHi) };
+	int32x4_t bu[4] = { vzip1q_s32(buLo, buLo), vzip2q_s32(buLo, buLo), vzip1q_s32(buHi, buHi), vzip2q_s32(buHi, buHi) };
+
+	// luma term: 298 * (y - 16) + 128
+	int16x8_t cLo = vreinterpretq_s16_u16(vsubl_u8(vget_low_u8(yv), vdup_n_u8(16)));
+	int16x8_t cHi = vreinterpretq_s16_u16(vsubl_u8(vget_high_u8(yv), vdup_n_u8(16)));
+	int32x4_t rounding = vdupq_n_s32(128);
+	int32x4_t yt[4] = {
+		vmlal_n_s16(rounding, vget_low_s16(cLo), 298),
+		vmlal_n_s16(rounding, vget_high_s16(cLo), 298),
+		vmlal_n_s16(rounding, vget_low_s16(cHi), 298),
+		vmlal_n_s16(rounding, vget_high_s16(cHi), 298)
+	};
+
+	uint8x16_t r = vcombine_u8(NarrowToBytes(vaddq_s32(yt[0], rv[0]), vaddq_s32(yt[1], rv[1])),
+		NarrowToBytes(vaddq_s32(yt[2], rv[2]), vaddq_s32(yt[3], rv[3])));
+	uint8x16_t g = vcombine_u8(NarrowToBytes(vaddq_s32(yt[0], guv[0]), vaddq_s32(yt[1], guv[1])),
+		NarrowToBytes(vaddq_s32(yt[2], guv[2]), vaddq_s32(yt[3], guv[3])));
+	uint8x16_t b = vcombine_u8(NarrowToBytes(vaddq_s32(yt[0], bu[0]), vaddq_s32(yt[1], bu[1])),
+		NarrowToBytes(vaddq_s32(yt[2], bu[2]), vaddq_s32(yt[3], bu[3])));
+
+	uint8x16x3_t px;
+	if constexpr (order == ChannelOrder::Bgr) {
+		px.val[0] = b; px.val[1] = g; px.val[2] = r;
+	}
+	else {
+		px.val[0] = r; px.val[1] = g; px.val[2] = b;
+	}
+	vst3q_u8(dst, px);
+}
+
+#elif defined(__AVX2__) || defined(__SSE4_1__)
+
+// pshufb masks that interleave three planes of 16 bytes into 48 bytes of packed pixels.
+// Mask [k][s] moves channel s into output vector k.
+struct InterleaveMasks {
+	alignas(16) int8_t m[3][3][16];
+	constexpr InterleaveMasks() : m() {
+		for (int k = 0; k < 3; k++)
+			for (int s = 0; s < 3; s++)
+				for (int j = 0; j < 16; j++) {
+					int p = 16 * k + j;
+					m[k][s][j] = (p % 3 == s) ? static_cast<int8_t>(p / 3) : static_cast<int8_t>(-128);
+				}
+	}
+};
+constexpr InterleaveMasks Interleave;
+
+// Computes r, g, b for 16 pixels (one 128-bit lane) from 16-bit luma and chroma.
+// c0 holds pixels 0-7, c1 pixels 8-15 (already minus 16), d/e hold the 8 chroma samples (already minus 128).
+// The AVX2 path runs exactly the same sequence per 128-bit lane.
+#define YUV_CONVERT_LANE(P, V, c0, c1, d, e, r, g, b) \
+	{ \
+		V ones = P##_set1_epi16(1); \
+		V kLuma = P##_set1_epi32((128 << 16) | 298); \
+		V yt0 = P##_madd_epi16(P##_unpacklo_epi16(c0, ones), kLuma); \
+		V yt1 = P##_madd_epi16(P##_unpackhi_epi16(c0, ones), kLuma); \
+		V yt2 = P##_madd_epi16(P##_unpacklo_epi16(c1, ones), kLuma); \
+		V yt3 = P##_madd_epi16(P##_unpackhi_epi16(c1, ones), kLuma); \
+		V deLo = P##_unpacklo_epi16(d, e); \
+		V deHi = P##_unpackhi_epi16(d, e); \
+		V kR = P##_set1_epi32(409 << 16); \
+		V kG = P##_set1_epi32(static_cast<int32_t>((static_cast<uint32_t>(-208) << 16) | (static_cast<uint32_t>(-100) & 0xFFFF))); \
+		V kB = P##_set1_epi32(516); \
+		V rvLo = P##_madd_epi16(deLo, kR), rvHi = P##_madd_epi16(deHi, kR); \
+		V gvLo = P##_madd_epi16(deLo, kG), gvHi = P##_madd_epi16(deHi, kG); \
+		V bvLo = P##_madd_epi16(deLo, kB), bvHi = P##_madd_epi16(deHi, kB); \
+		r = P##_packus_epi16( \
+			P##_packs_epi32(P##_srai_epi32(P##_add_epi32(yt0, P##_unpacklo_epi32(rvLo, rvLo)), 8), \
+			                P##_srai_epi32(P##_add_epi32(yt1, P##_unpackhi_epi32(rvLo, rvLo)), 8)), \
+			P##_packs_epi32(P##_srai_epi32(P##_add_epi32(yt2, P##_unpacklo_epi32(rvHi, rvHi)), 8), \
+			                P##_srai_epi32(P##_add_epi32(yt3, P##_unpackhi_epi32(rvHi, rvHi)), 8))); \
+		g = P##_packus_epi16( \
+			P##_packs_epi32(P##_srai_epi32(P##_add_epi32(yt0, P##_unpacklo_epi32(gvLo, gvLo)), 8), \
+			                P##_srai_epi32(P##_add_epi32(yt1, P##_unpackhi_epi32(gvLo, gvLo)), 8)), \
+			P##_packs_epi32(P##_srai_epi32(P##_add_epi32(yt2, P##_unpacklo_epi32(gvHi, gvHi)), 8), \
+			                P##_srai_epi32(P##_add_epi32(yt3, P##_unpackhi_epi32(gvHi, gvHi)), 8))); \
+		b = P##_packus_epi16( \
+			P##_packs_epi32(P##_srai_epi32(P##_add_epi32(yt0, P##_unpacklo_epi32(bvLo, bvLo)), 8), \
+			                P##_srai_epi32(P##_add_epi32(yt1, P##_unpackhi_epi32(bvLo, bvLo)), 8)), \
+			P##_packs_epi32(P##_srai_epi32(P##_add_epi32(yt2, P##_unpacklo_epi32(bvHi, bvHi)), 8), \
+			                P##_srai_epi32(P##_add_epi32(yt3, P##_unpackhi_epi32(bvHi, bvHi)), 8))); \
+	}
+
+#if defined(__AVX2__)
+
+constexpr int VectorPixels = 32;
+
+inline __m256i LoadMask(int k, int s) {
+	return _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(Interleave.m[k][s])));
+}
+
+template<ChannelOrder order>
+inline void ConvertBlock(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst) {
+	// lane 0 holds pixels 0-15, lane 1 pixels 16-31.
+	__m256i yv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y));
+	__m256i zero = _mm256_setzero_si256();
+	__m256i luma16 = _mm256_set1_epi16(16);
+	__m256i chroma128 = _mm256_set1_epi16(128);
+	__m256i c0 = _mm256_sub_epi16(_mm256_unpacklo_epi8(yv, zero), luma16);
+	__m256i c1 = _mm256_sub_epi16(_mm256_unpackhi_epi8(yv, zero), luma16);
+	__m256i d = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(u))), chroma128);
+	__m256i e = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(v))), chroma128);
+
+	__m256i r, g, b;
+	YUV_CONVERT_LANE(_mm256, __m256i, c0, c1, d, e, r, g, b);
+
+	__m256i ch[3];
+	if constexpr (order == ChannelOrder::Bgr) {
+		ch[0] = b; ch[1] = g; ch[2] = r;
+	}
+	else {
+		ch[0] = r; ch[1] = g; ch[2] = b;
+	}
+	__m256i out[3];
+	for (int k = 0; k < 3; k++)
+		out[k] = _mm256_or_si256(_mm256_or_si256(
+			_mm256_shuffle_epi8(ch[0], LoadMask(k, 0)),
+			_mm256_shuffle_epi8(ch[1], LoadMask(k, 1))),
+			_mm256_shuffle_epi8(ch[2], LoadMask(k, 2)));
+
+	// out[k] lane 0 is part k of pixels 0-15, lane 1 is part k of pixels 16-31.
+	auto* o = reinterpret_cast<__m256i*>(dst);
+	_mm256_storeu_si256(o, _mm256_permute2x128_si256(out[0], out[1], 0x20));
+	_mm256_storeu_si256(o + 1, _mm256_permute2x128_si256(out[2], out[0], 0x30));
+	_mm256_storeu_si256(o + 2, _mm256_permute2x128_si256(out[1], out[2], 0x31));
+}
+
+#else
+
+constexpr int VectorPixels = 16;
+
+inline __m128i LoadMask(int k, int s) {
+	return _mm_load_si128(reinterpret_cast<const __m128i*>(Interleave.m[k][s]));
+}
+
+template<ChannelOrder order>
+inline void ConvertBlock(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst) {
+	__m128i yv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y));
+	__m128i luma16 = _mm_set1_epi16(16);
+	__m128i chroma128 = _mm_set1_epi16(128);
+	__m128i c0 = _mm_sub_epi16(_mm_cvtepu8_epi16(yv), luma16);
+	__m128i c1 = _mm_sub_epi16(_mm_cvtepu8_epi16(_mm_srli_si128(yv, 8)), luma16);
+	__m128i d = _mm_sub_epi16(_mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(u))), chroma128);
+	__m128i e = _mm_sub_epi16(_mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(v))), chroma128);
+
+	__m128i r, g, b;
+	YUV_CONVERT_LANE(_mm, __m128i, c0, c1, d, e, r, g, b);
+
+	__m128i ch[3];
+	if constexpr (order == ChannelOrder::Bgr) {
+		ch[0] = b; ch[1] = g; ch[2] = r;
+	}
+	else {
+		ch[0] = r; ch[1] = g; ch[2] = b;
+	}
+	auto* o = reinterpret_cast<__m128i*>(dst);
+	for (int k = 0; k < 3; k++)
+		_mm_storeu_si128(o + k, _mm_or_si128(_mm_or_si128(
+			_mm_shuffle_epi8(ch[0], LoadMask(k, 0)),
+			_mm_shuffle_epi8(ch[1], LoadMask(k, 1))),
+			_mm_shuffle_epi8(ch[2], LoadMask(k, 2))));
+}
+
+#endif
+#undef YUV_CONVERT_LANE
+
+#else
+
+constexpr int VectorPixels = 2;
+
+template<ChannelOrder order>
+inline void ConvertBlock(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst) {
+	YuvConverter::ToPixel(y[0], u[0], v[0], dst, order);
+	YuvConverter::ToPixel(y[1], u[0], v[0], dst + 3, order);
+}
+
+#endif
+
+template<ChannelOrder order>
+void ConvertRowImpl(const uint8_t* yRow, const uint8_t* uRow, const uint8_t* vRow, int x, int width, uint8_t* dst) {
+	int end = x + width;
+	// A pixel at an odd column shares chroma with its left neighbour, so the vector body must start even.
+	if (x & 1) {
+		YuvConverter::ToPixel(yRow[x], uRow[x >> 1], vRow[x >> 1], dst, order);
+		dst += 3;
+		x++;
+	}
+	for (; x + VectorPixels <= end; x += VectorPixels, dst += VectorPixels * 3)
+		ConvertBlock<order>(yRow + x, uRow + (x >> 1), vRow + (x >> 1), dst);
+
+	for (; x < end; x++, dst += 3)
+		YuvConverter::ToPixel(yRow[x], uRow[x >> 1], vRow[x >> 1], dst, order);
+}
+
+}
+
+void YuvConverter::ConvertRow(const uint8_t* yRow, const uint8_t* uRow, const uint8_t* vRow,
+	int x, int width, uint8_t* dst, ChannelOrder order)
+{
+	if (order == ChannelOrder::Bgr)
+		ConvertRowImpl<ChannelOrder::Bgr>(yRow, uRow, vRow, x, width, dst);
+	else
+		ConvertRowImpl<ChannelOrder::Rgb>(yRow, uRow, vRow, x, width, dst);
+}
+
+void YuvConverter::ConvertI420(const uint8_t* yPlane, int yStride,
+	const uint8_t* uPlane, const uint8_t* vPlane, int uvStride,
+	int x, int y, int width, int height,
+	uint8_t* dst, int dstStride, ChannelOrder order)
+{
+	for (int iy = 0; iy < height; iy++) {
+		int row = y + iy;
+		const uint8_t* yRow = yPlane + static_cast<size_t>(row) * yStride;
+		const uint8_t* uRow = uPlane + static_cast<size_t>(row >> 1) * uvStride;
+		const uint8_t* vRow = vPlane + static_cast<size_t>(row >> 1) * uvStride;
+		ConvertRow(yRow, uRow, vRow, x, width, dst + static_cast<size_t>(iy) * dstStride, order);
+	}
+}
+
+const char* YuvConverter::Implementation()
+{
+#if defined(__ARM_NEON)
+	return "neon";
+#elif defined(__AVX2__)
+	return "avx2";
+#elif defined(__SSE4_1__)
+	return "sse4.1";
+#else
+	return "scalar";
+#endif
+}
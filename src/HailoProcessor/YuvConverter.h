@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+enum class ChannelOrder {
+	Rgb,
+	Bgr
+};
+
+// Row oriented I420 -> packed 24-bit conversion kernels.
+// The integer coefficients are the same as in YuvColor::ToRgb, so the output is bit-exact with the per-pixel path.
+// Vectorized with NEON on aarch64, AVX2 or SSE4.1 on x86 (whichever the compiler targets), scalar otherwise.
+class YuvConverter {
+public:
+	// Converts 'width' pixels starting at luma column 'x' of a single row.
+	// yRow, uRow and vRow point at the beginning of the row in each plane (chroma is horizontally subsampled by 2).
+	// dst receives width * 3 bytes.
+	static void ConvertRow(const uint8_t* yRow, const uint8_t* uRow, const uint8_t* vRow,
+		int x, int width, uint8_t* dst, ChannelOrder order);
+
+	// Converts a rectangle of an I420 image. Chroma planes are subsampled by 2 in both directions.
+	static void ConvertI420(const uint8_t* yPlane, int yStride,
+		const uint8_t* uPlane, const uint8_t* vPlane, int uvStride,
+		int x, int y, int width, int height,
+		uint8_t* dst, int dstStride, ChannelOrder order);
+
+	// Name of the kernel set selected at compile time, handy when comparing benchmark numbers.
+	static const char* Implementation();
+
+	static inline void ToPixel(int y, int u, int v, uint8_t* dst, ChannelOrder order);
+};
+
+inline uint8_t ClampToByte(int value) {
+	return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+inline void YuvConverter::ToPixel(int y, int u, int v, uint8_t* dst, ChannelOrder order)
+{
+	int c = y - 16;
+	int d = u - 128;
+	int e = v - 128;
+
+	uint8_t r = ClampToByte((298 * c + 409 * e + 128) >> 8);
+	uint8_t g = ClampToByte((298 * c - 100 * d - 208 * e + 128) >> 8);
+	uint8_t b = ClampToByte((298 * c + 516 * d + 128) >> 8);
+
+	if (order == ChannelOrder::Bgr) {
+		dst[0] = b; dst[1] = g; dst[2] = r;
+	}
+	else {
+		dst[0] = r; dst[1] = g; dst[2] = b;
+	}
+}
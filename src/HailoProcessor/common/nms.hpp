@@ -6,6 +6,7 @@
 
 #include "hailo_objects.hpp"
 #include "hailo_common.hpp"
+#include "../Nms.h"
 namespace common
 {
 
@@ -38,45 +39,27 @@ namespace common
      */
     void nms(std::vector<HailoDetection> &objects, const float iou_thr, bool should_nms_cross_classes = false)
     {
-        std::vector<HailoDetection> objects_after_nms;
         // The network may propose multiple detections of similar size/score,
         // which are actually the same detection. We want to filter out the lesser
         // detections with a simple nms.
-        std::sort(objects.begin(), objects.end(),
-                  [](HailoDetection a, HailoDetection b)
-                  { return a.get_confidence() > b.get_confidence(); });
-
-        for (uint index = 0; index < objects.size(); index++)
-        {
-            if (objects[index].get_confidence() != 0.0f)
-            {
-                for (uint jindex = index + 1; jindex < objects.size(); jindex++)
-                {
-                    if ((should_nms_cross_classes || (objects[index].get_class_id() == objects[jindex].get_class_id())) &&
-                        objects[jindex].get_confidence() != 0.0f)
-                    {
-                        // For each detection, calculate the IOU against each following detection.
-                        float iou = iou_calc(objects[index].get_bbox(), objects[jindex].get_bbox());
-                        // If the IOU is above threshold, then we have two similar detections,
-                        // and want to delete the one.
-                        if (iou >= iou_thr)
-                        {
-                            // The detections are arranged in highest score order,
-                            // so we want to erase the latter detection.
-                            objects[jindex].set_confidence(0.0f);
-                        }
-                    }
-                }
-            }
-        }
-        for (uint index = 0; index < objects.size(); index++)
+        BoxSet boxes;
+        boxes.Reserve(objects.size());
+        for (auto &object : objects)
         {
-            if (objects[index].get_confidence() != 0.0f)
-            {
-                objects_after_nms.push_back(objects[index]);
-            }
+            HailoBBox bbox = object.get_bbox();
+            boxes.Add(bbox.xmin(), bbox.ymin(), bbox.xmax(), bbox.ymax(), object.get_confidence(), object.get_class_id());
         }
-        objects = objects_after_nms;
+        NmsOptions options;
+        options.Threshold = iou_thr;
+        options.Mode = should_nms_cross_classes ? NmsMode::CrossClass : NmsMode::ClassAware;
+        std::vector<int> keep;
+        Nms::Run(boxes, options, keep);
+
+        std::vector<HailoDetection> objects_after_nms;
+        objects_after_nms.reserve(keep.size());
+        for (int index : keep)
+            objects_after_nms.push_back(objects[index]);
+        objects = std::move(objects_after_nms);
     }
 
 }
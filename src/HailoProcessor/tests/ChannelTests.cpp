@@ -0,0 +1,77 @@
+// Channel stress: producers write distinct items with Oldest discard while consumers read them.
+// Every item must be read or reported dropped exactly once, whatever the capacity, one included.
+
+#include "../Channel.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int Producers = 3;
+constexpr int Consumers = 2;
+constexpr long ItemsPerProducer = 200000;
+
+// False when an item was lost, seen twice, or the run did not finish in time.
+bool Stress(size_t capacity)
+{
+	Channel<long> channel(capacity, DiscardPolicy::Oldest);
+	const long total = Producers * ItemsPerProducer;
+	std::vector<std::atomic<int>> seen(static_cast<size_t>(total));
+	std::atomic<long> done{0};
+	channel.connectDropped([&](const long& item) {
+		seen[static_cast<size_t>(item)].fetch_add(1, std::memory_order_relaxed);
+		done.fetch_add(1, std::memory_order_relaxed);
+	});
+
+	std::vector<std::thread> threads;
+	for (int p = 0; p < Producers; p++)
+		threads.emplace_back([&, p] {
+			for (long i = 0; i < ItemsPerProducer; i++)
+				channel.TryWrite(p * ItemsPerProducer + i);
+		});
+	for (int c = 0; c < Consumers; c++)
+		threads.emplace_back([&] {
+			long item;
+			while (done.load(std::memory_order_relaxed) < total) {
+				if (channel.TryRead(item, std::chrono::milliseconds(10))) {
+					seen[static_cast<size_t>(item)].fetch_add(1, std::memory_order_relaxed);
+					done.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+		});
+
+	// a wedged ring never finishes; report it instead of hanging the test run.
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+	while (done.load() < total && std::chrono::steady_clock::now() < deadline)
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	if (done.load() < total) {
+		std::printf("capacity %zu: %ld of %ld items after 60 s, pending %d\n", capacity, done.load(), total, channel.Pending());
+		std::fflush(stdout);
+		std::_Exit(1);
+	}
+	for (auto& t : threads)
+		t.join();
+
+	long wrong = 0;
+	for (auto& s : seen)
+		wrong += s.load() != 1 ? 1 : 0;
+	if (wrong != 0)
+		std::printf("capacity %zu: %ld items not read or dropped exactly once\n", capacity, wrong);
+	return wrong == 0;
+}
+
+}
+
+int main()
+{
+	int failures = 0;
+	for (size_t capacity : {1, 2, 3, 16})
+		for (int run = 0; run < 8; run++)
+			failures += Stress(capacity) ? 0 : 1;
+	std::printf("%d runs failed\n", failures);
+	return failures == 0 ? 0 : 1;
+}
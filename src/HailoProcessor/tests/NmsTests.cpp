@@ -0,0 +1,136 @@
+// Nms::Run against a brute-force reference: every pair compared in scalar code, boxes in score order.
+// Random sets cover ties, nested boxes, every mode and detection limits; the kept indices must be identical.
+
+#include "../Nms.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+
+// -ffp-contract and -funsafe-math-optimizations may round the decayed soft scores differently in either path.
+bool SameScores(const std::vector<float>& a, const std::vector<float>& b)
+{
+	if (a.size() != b.size())
+		return false;
+	for (size_t i = 0; i < a.size(); i++)
+		if (std::fabs(a[i] - b[i]) > 1e-5f * std::max(1.0f, std::fabs(b[i])))
+			return false;
+	return true;
+}
+
+float Overlap(const BoxSet& b, int i, int j, NmsOverlap kind)
+{
+	float overlap;
+	Nms::Overlaps(b.X1[i], b.Y1[i], b.X2[i], b.Y2[i], &b.X1[j], &b.Y1[j], &b.X2[j], &b.Y2[j], 1, kind, &overlap);
+	return overlap;
+}
+
+bool Related(const BoxSet& b, int i, int j, const NmsOptions& options)
+{
+	return options.Mode == NmsMode::CrossClass || b.ClassId[i] == b.ClassId[j];
+}
+
+void Reference(const BoxSet& b, const NmsOptions& options, std::vector<int>& keep, std::vector<float>& scores)
+{
+	keep.clear();
+	scores.clear();
+	const size_t n = b.Size();
+	const size_t limit = options.MaxDetections > 0 ? options.MaxDetections : n;
+	if (options.Soft) {
+		std::vector<float> decayed(b.Score);
+		std::vector<bool> alive(n, true);
+		while (keep.size() < limit) {
+			int best = -1;
+			for (size_t j = 0; j < n; j++)
+				if (alive[j] && (best < 0 || decayed[j] > decayed[best]))
+					best = static_cast<int>(j);
+			if (best < 0 || decayed[best] < options.ScoreThreshold)
+				break;
+			keep.push_back(best);
+			scores.push_back(decayed[best]);
+			alive[best] = false;
+			for (size_t j = 0; j < n; j++) {
+				const float o = Overlap(b, best, static_cast<int>(j), options.Overlap);
+				if (alive[j] && o >= options.Threshold && Related(b, best, static_cast<int>(j), options))
+					decayed[j] *= std::exp(-o * o / options.Sigma);
+			}
+		}
+		return;
+	}
+	std::vector<int> order(n);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](int x, int y) { return b.Score[x] > b.Score[y]; });
+	for (int i : order) {
+		if (keep.size() >= limit)
+			break;
+		bool suppressed = false;
+		for (int k : keep)
+			suppressed |= Overlap(b, k, i, options.Overlap) >= options.Threshold && Related(b, k, i, options);
+		if (!suppressed) {
+			keep.push_back(i);
+			scores.push_back(b.Score[i]);
+		}
+	}
+}
+
+void RandomSet(std::mt19937& rng, BoxSet& boxes)
+{
+	std::uniform_int_distribution<int> count(0, 300);
+	std::uniform_real_distribution<float> position(0.0f, 600.0f), extent(1.0f, 120.0f), unit(0.0f, 1.0f);
+	std::uniform_int_distribution<int> classId(0, 3);
+	boxes.Clear();
+	const int n = count(rng);
+	for (int i = 0; i < n; i++) {
+		float x = position(rng), y = position(rng), w = extent(rng), h = extent(rng);
+		// some boxes nested in the previous one, as a detection cut by a tile border.
+		if (i > 0 && unit(rng) < 0.2f) {
+			x = boxes.X1[i - 1] + 2.0f;
+			y = boxes.Y1[i - 1] + 2.0f;
+			w = std::max(1.0f, (boxes.X2[i - 1] - boxes.X1[i - 1]) * 0.6f);
+			h = std::max(1.0f, (boxes.Y2[i - 1] - boxes.Y1[i - 1]) * 0.6f);
+		}
+		// coarse scores, so ties are common.
+		const float score = std::round(unit(rng) * 50.0f) / 50.0f;
+		boxes.Add(x, y, x + w, y + h, score, classId(rng));
+	}
+}
+
+}
+
+int main()
+{
+	std::mt19937 rng(20241201);
+	BoxSet boxes;
+	std::vector<int> keep, expected;
+	std::vector<float> scores, expectedScores;
+	int failures = 0, runs = 0;
+	for (int set = 0; set < 2000; set++) {
+		RandomSet(rng, boxes);
+		for (NmsMode mode : {NmsMode::ClassAware, NmsMode::CrossClass})
+		for (NmsOverlap overlap : {NmsOverlap::Iou, NmsOverlap::IntersectionOverSmaller})
+		for (bool soft : {false, true})
+		for (size_t limit : {size_t(0), size_t(10)}) {
+			NmsOptions options;
+			options.Threshold = overlap == NmsOverlap::Iou ? 0.5f : 0.7f;
+			options.Mode = mode;
+			options.Overlap = overlap;
+			options.Soft = soft;
+			options.MaxDetections = limit;
+			Nms::Run(boxes, options, keep, &scores);
+			Reference(boxes, options, expected, expectedScores);
+			runs++;
+			if (keep != expected || !SameScores(scores, expectedScores)) {
+				if (failures++ < 10)
+					std::printf("set %d: %zu boxes, mode %d, overlap %d, soft %d, limit %zu: %zu kept, expected %zu\n",
+						set, boxes.Size(), static_cast<int>(mode), static_cast<int>(overlap), soft ? 1 : 0, limit, keep.size(), expected.size());
+			}
+		}
+	}
+	std::printf("%d of %d runs differ from the reference\n", failures, runs);
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,101 @@
+// Disposing a SegmentationResult through its handle: a repeated or racing dispose must fail
+// without touching the result, even when the pool has already rented the same object again.
+// Results from the heap fallback have no handle, so a repeated dispose of the pointer must fail as well.
+
+#include "../Frame.h"
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::atomic<int> failures{0};
+
+void Check(bool condition, const char* what)
+{
+	if (!condition && failures++ < 10)
+		std::printf("failed: %s\n", what);
+}
+
+SegmentationResult* RentWithSegment(uint64_t frameId)
+{
+	SegmentationResult* result = SegmentationResult::Rent(FrameIdentifier(1, frameId), Rect(0, 0, 8, 8), 0.5f);
+	Mat mask(8, 8, CV_32FC1, Scalar(1.0f));
+	result->Add(mask, 0, Size(8, 8), Rect2f(0, 0, 8, 8), 0.9f, "test", InputTransform());
+	return result;
+}
+
+void DoubleDispose()
+{
+	SegmentationResult* first = RentWithSegment(1);
+	const uint64_t handle = SegmentationResult::Pool().Handle(first);
+	Check(handle != 0, "a pooled result has a handle");
+	Check(SegmentationResult::Return(handle), "the first dispose returns the result");
+	Check(!SegmentationResult::Return(handle), "the second dispose is refused");
+
+	// the pool hands out the slot just returned, so the stale handle now names a rented object.
+	SegmentationResult* second = RentWithSegment(2);
+	Check(second == first, "the returned slot is rented again");
+	Check(!SegmentationResult::Return(handle), "a stale handle does not dispose the re-rented result");
+	Check(second->Count() == 1 && second->GetMask(0) != nullptr, "the re-rented result keeps its segment");
+	Check(second->Id().FrameId == 2, "the re-rented result keeps its frame");
+	Check(SegmentationResult::Pool().Resolve(SegmentationResult::Pool().Handle(second)) == second, "its own handle resolves");
+	SegmentationResult::Return(second);
+	Check(SegmentationResult::Pool().InUse() == 0, "nothing is left rented");
+}
+
+void RacingDispose()
+{
+	constexpr int Threads = 4;
+	for (int i = 0; i < 1000; i++) {
+		SegmentationResult* result = RentWithSegment(static_cast<uint64_t>(i));
+		const uint64_t handle = SegmentationResult::Pool().Handle(result);
+		std::atomic<int> disposed{0};
+		std::vector<std::thread> threads;
+		for (int t = 0; t < Threads; t++)
+			threads.emplace_back([&] {
+				if (SegmentationResult::Return(handle))
+					disposed.fetch_add(1);
+				// what the losers race with: the slot rented again by someone else.
+				SegmentationResult* other = RentWithSegment(1000000);
+				Check(other->Count() == 1, "a result rented during the race keeps its segment");
+				SegmentationResult::Return(other);
+			});
+		for (auto& t : threads)
+			t.join();
+		Check(disposed.load() == 1, "exactly one racing dispose wins");
+	}
+	Check(SegmentationResult::Pool().InUse() == 0, "nothing is left rented after the races");
+}
+
+
+void OverflowDispose()
+{
+	std::vector<SegmentationResult*> pooled;
+	for (uint32_t i = 0; i < SegmentationResult::Pool().Capacity(); i++)
+		pooled.push_back(RentWithSegment(i));
+	const uint64_t overflow = SegmentationResult::Pool().Overflow();
+	SegmentationResult* heap = RentWithSegment(1);
+	Check(SegmentationResult::Pool().Overflow() == overflow + 1, "a full pool falls back to the heap");
+	Check(SegmentationResult::Pool().Handle(heap) == 0, "a heap result has no handle");
+	SegmentationResult::Return(heap);
+	Check(!SegmentationResult::Pool().Acquire(heap), "a disposed heap result is no longer rented");
+	// would delete it a second time.
+	SegmentationResult::Return(heap);
+	for (SegmentationResult* result : pooled)
+		SegmentationResult::Return(result);
+	Check(SegmentationResult::Pool().InUse() == 0, "nothing is left rented after the overflow");
+}
+
+}
+
+int main()
+{
+	DoubleDispose();
+	RacingDispose();
+	OverflowDispose();
+	std::printf("%d checks failed\n", failures.load());
+	return failures.load() == 0 ? 0 : 1;
+}
@@ -62,6 +62,109 @@ namespace ModelingEvolution.VideoStreaming.Hailo
         public readonly ulong InFlight;
         public readonly ulong DroppedTotal;
 
+        public readonly StageStats TileProcessing;
+
+        [StructLayout(LayoutKind.Sequential, Pack=1)]
+        public struct CameraStats
+        {
+            public readonly uint CameraId;
+            private readonly int _priority;
+            public readonly uint Weight;
+            public readonly float MaxFps;
+            public readonly ulong Admitted;
+            // Over the fps cap, never preprocessed.
+            public readonly ulong Throttled;
+            // Dropped from the full camera queue.
+            public readonly ulong Evicted;
+            // Admitted but never delivered, evictions included.
+            public readonly ulong Dropped;
+            public readonly ulong Dispatched;
+            public readonly ulong Processed;
+            public readonly ulong Queued;
+            private readonly long _totalQueueTimeNanoseconds;
+            private readonly long _totalProcessingTimeNanoseconds;
+            private readonly long _maxProcessingTimeNanoseconds;
+
+            public CameraPriority Priority => (CameraPriority)_priority;
+            public TimeSpan QueueTime => Dispatched == 0 ? TimeSpan.Zero : TimeSpan.FromTicks(_totalQueueTimeNanoseconds / 100 / (long)Dispatched);
+            public TimeSpan Latency => Processed == 0 ? TimeSpan.Zero : TimeSpan.FromTicks(_totalProcessingTimeNanoseconds / 100 / (long)Processed);
+            public TimeSpan MaxLatency => TimeSpan.FromTicks(_maxProcessingTimeNanoseconds / 100);
+        }
+        // Number of cameras seen, see HailoProcessor.GetCameraStats.
+        public readonly uint CameraCount;
+
+        [StructLayout(LayoutKind.Sequential, Pack=1)]
+        public struct AdmissionStats
+        {
+            private readonly int _mode;
+            public readonly ulong Admitted;
+            public readonly ulong Dropped;
+            // Tiled frames run as a single inference over the whole roi.
+            public readonly ulong Downscaled;
+            private readonly long _predictedLatencyNanoseconds;
+            private readonly long _deviceServiceTimeNanoseconds;
+            private readonly long _postProcessingServiceTimeNanoseconds;
+            private readonly long _callbackServiceTimeNanoseconds;
+
+            public AdmissionMode Mode => (AdmissionMode)_mode;
+            // Of the last frame offered.
+            public TimeSpan PredictedLatency => TimeSpan.FromTicks(_predictedLatencyNanoseconds / 100);
+            public TimeSpan DeviceServiceTime => TimeSpan.FromTicks(_deviceServiceTimeNanoseconds / 100);
+            public TimeSpan PostProcessingServiceTime => TimeSpan.FromTicks(_postProcessingServiceTimeNanoseconds / 100);
+            public TimeSpan CallbackServiceTime => TimeSpan.FromTicks(_callbackServiceTimeNanoseconds / 100);
+        }
+        public readonly AdmissionStats Admission;
+
+        [StructLayout(LayoutKind.Sequential, Pack=1)]
+        public struct PoolStats
+        {
+            public readonly uint Capacity;
+            public readonly uint InUse;
+            public readonly uint Peak;
+            // Rents served from the heap because the pool was exhausted.
+            public readonly ulong Overflow;
+        }
+        public readonly PoolStats ContextPool;
+        public readonly PoolStats ResultPool;
+
+        [StructLayout(LayoutKind.Sequential, Pack=1)]
+        public struct MemoryPoolStats
+        {
+            private readonly int _hugePages;
+            private readonly int _locked;
+            public readonly ulong MappedBytes;
+            public readonly ulong PeakMappedBytes;
+            // Rounded up to the size classes.
+            public readonly ulong InUseBytes;
+            public readonly ulong PeakInUseBytes;
+            public readonly ulong Rents;
+            public readonly ulong ThreadCacheHits;
+            public readonly ulong FreeListHits;
+            // Rents that mapped a new block.
+            public readonly ulong Maps;
+            public readonly ulong Unmaps;
+            public readonly ulong HugePageBlocks;
+            // mlock refused, see RLIMIT_MEMLOCK.
+            public readonly ulong LockFailures;
+
+            public bool HugePages => _hugePages != 0;
+            public bool Locked => _locked != 0;
+        }
+        // Shared by every processor of the process.
+        public readonly MemoryPoolStats MemoryPool;
+
+        [StructLayout(LayoutKind.Sequential, Pack=1)]
+        public struct ArenaStats
+        {
+            // Temporaries of one frame at most.
+            public readonly ulong PeakBytes;
+            // All workers.
+            public readonly ulong CapacityBytes;
+            // Frames that made their worker's arena grow.
+            public readonly ulong Overflows;
+        }
+        public readonly ArenaStats PostProcessingArena;
+
         public void Print(TextWriter tx = null)
         {
             tx ??= Console.Out;
@@ -77,6 +180,7 @@ namespace ModelingEvolution.VideoStreaming.Hailo
             PrintStageStats(tx, "Post Processing", PostProcessing);
             PrintStageStats(tx, "Callback Processing", CallbackProcessing);
             PrintStageStats(tx, "Total Processing", TotalProcessing);
+            PrintStageStats(tx, "Tile Processing", TileProcessing);
 
             tx.WriteLine(header);
         }
@@ -94,7 +198,176 @@ namespace ModelingEvolution.VideoStreaming.Hailo
                 stats.TotalProcessingTime.WithTimeSuffix(0));
         }
     }
+
+    /// <summary>
+    /// Stats beyond HailoProcessorStats, read with HailoProcessor.GetStatsEx; the counters stay in HailoProcessor.Stats.
+    /// Fields of a version above Version were not filled by the native library.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential, Pack=1)]
+    public struct HailoProcessorStatsEx
+    {
+        public const uint CurrentVersion = 3;
+
+        public uint Version;
+        public uint Size;
+
+        [StructLayout(LayoutKind.Sequential, Pack=1)]
+        public struct Latency
+        {
+            public readonly ulong Count;
+            private readonly long _p50Nanoseconds;
+            private readonly long _p90Nanoseconds;
+            private readonly long _p99Nanoseconds;
+            private readonly long _p999Nanoseconds;
+            private readonly long _maxNanoseconds;
+
+            public TimeSpan P50 => TimeSpan.FromTicks(_p50Nanoseconds / 100);
+            public TimeSpan P90 => TimeSpan.FromTicks(_p90Nanoseconds / 100);
+            public TimeSpan P99 => TimeSpan.FromTicks(_p99Nanoseconds / 100);
+            public TimeSpan P999 => TimeSpan.FromTicks(_p999Nanoseconds / 100);
+            public TimeSpan Max => TimeSpan.FromTicks(_maxNanoseconds / 100);
+        }
+        // Version 1: percentiles of the frame processing time, over the lifetime or the window.
+        public readonly Latency WriteLatency;
+        public readonly Latency ReadInterferenceLatency;
+        public readonly Latency PostProcessingLatency;
+        public readonly Latency CallbackLatency;
+        public readonly Latency TotalLatency;
+        public readonly Latency TileLatency;
+
+        [StructLayout(LayoutKind.Sequential, Pack=1)]
+        public struct Rate
+        {
+            public readonly float Processed1s;
+            public readonly float Processed10s;
+            public readonly float Processed60s;
+            public readonly float Dropped1s;
+            public readonly float Dropped10s;
+            public readonly float Dropped60s;
+        }
+        // Version 2: frames per second observed over the last 1, 10 and 60 whole seconds.
+        public readonly Rate WriteRate;
+        public readonly Rate ReadInterferenceRate;
+        public readonly Rate PostProcessingRate;
+        public readonly Rate CallbackRate;
+        public readonly Rate TotalRate;
+        public readonly Rate TileRate;
+
+        [StructLayout(LayoutKind.Sequential, Pack=1)]
+        public struct Queue
+        {
+            public readonly uint Pending;
+            // 0 - bounded per camera.
+            public readonly uint Capacity;
+        }
+        // Items queued at the time of the read.
+        public readonly Queue ScheduledQueue;
+        public readonly Queue WriteQueue;
+        public readonly Queue PostProcessingQueue;
+        public readonly Queue CallbackQueue;
+
+        [StructLayout(LayoutKind.Sequential, Pack=1)]
+        public struct WorkerStats
+        {
+            private readonly int _stage;
+            // Within the stage.
+            public readonly uint Index;
+            private readonly long _busyTimeNanoseconds;
+            private readonly long _idleTimeNanoseconds;
+            // Busy share of the window.
+            public readonly float Utilization1s;
+            public readonly float Utilization10s;
+            public readonly float Utilization60s;
+
+            public WorkerStage Stage => (WorkerStage)_stage;
+            public TimeSpan BusyTime => TimeSpan.FromTicks(_busyTimeNanoseconds / 100);
+            public TimeSpan IdleTime => TimeSpan.FromTicks(_idleTimeNanoseconds / 100);
+        }
+        // Number of pipeline threads, see HailoProcessor.GetWorkerStats.
+        public readonly uint WorkerCount;
+
+        [StructLayout(LayoutKind.Sequential, Pack=1)]
+        public struct Perf
+        {
+            // Processed while counting.
+            public readonly ulong Frames;
+            public readonly ulong Cycles;
+            public readonly ulong Instructions;
+            public readonly ulong CacheMisses;
+            public readonly ulong BranchMisses;
+
+            public double InstructionsPerCycle => Cycles == 0 ? 0 : (double)Instructions / Cycles;
+            public double CyclesPerFrame => Frames == 0 ? 0 : (double)Cycles / Frames;
+        }
+        // Version 3: hardware counters of the stages' own threads, user space only, see HailoProcessor.EnablePerfCounters.
+        public readonly Perf WritePerf;
+        public readonly Perf ReadInterferencePerf;
+        public readonly Perf PostProcessingPerf;
+        public readonly Perf CallbackPerf;
+        // 1 counting, 0 off, -errno when the kernel refused.
+        public readonly int PerfStatus;
+        // int.MinValue when unreadable.
+        public readonly int PerfEventParanoid;
+    }
     
+    public enum PixelFormat
+    {
+        I420 = 0,
+        NV12 = 1,
+        YUYV = 2,
+        I422 = 3
+    }
+
+    public enum ResizeMode
+    {
+        Stretch = 0,
+        Letterbox = 1
+    }
+
+    public enum MaskMode
+    {
+        Full = 0,
+        // Masks cover only the detection box, see Segment.MaskRect.
+        Box = 1
+    }
+
+    public enum MaskFormat
+    {
+        Float = 0,
+        // Probabilities scaled to 0..255.
+        Probability = 1,
+        // Thresholded, one bit per pixel, row-major over MaskRect, most significant bit first.
+        Bits = 2,
+        // Thresholded, uint32 run lengths alternating background and foreground, background first.
+        Rle = 3
+    }
+
+    public enum AdmissionMode
+    {
+        // Every frame is admitted.
+        Off = 0,
+        // Frames are admitted while their predicted end-to-end latency is within the limit.
+        Latency = 1,
+        // Admissions are paced to the target fps, or to what the slowest stage sustains.
+        Throughput = 2
+    }
+
+    public enum WorkerStage
+    {
+        Read = 0,
+        Dispatch = 1,
+        PostProcessing = 2,
+        Callback = 3
+    }
+
+    public enum CameraPriority
+    {
+        // Served before any other class.
+        High = 0,
+        Normal = 1,
+        Low = 2
+    }
+
     [UnmanagedFunctionPointer(CallingConvention.StdCall)]
     delegate void NativeHandler(IntPtr results, IntPtr context);
     
@@ -109,6 +382,12 @@ namespace ModelingEvolution.VideoStreaming.Hailo
         [DllImport(Lib.Name, EntryPoint = "hailo_processor_load_hef")]
         private static extern IntPtr LoadHef(string filename);
 
+        [DllImport(Lib.Name, EntryPoint = "hailo_processor_load_replay")]
+        private static extern IntPtr LoadReplayNative(string captureFile, int latencyUs, int jitterUs, uint seed);
+
+        [DllImport(Lib.Name, EntryPoint = "hailo_processor_load_hef_capture")]
+        private static extern IntPtr LoadHefCapture(string filename, string captureFile, int maxFrames);
+
         [DllImport(Lib.Name, EntryPoint = "hailo_processor_stop")]
         private static extern void StopProcessor(IntPtr ptr);
 
@@ -125,6 +404,38 @@ namespace ModelingEvolution.VideoStreaming.Hailo
             int roiH,
             float threshold);
 
+        [DllImport(Lib.Name, EntryPoint = "hailo_processor_write_planes")]
+        private static extern void WritePlanes(IntPtr ptr,
+            int pixelFormat,
+            IntPtr plane0, int stride0,
+            IntPtr plane1, int stride1,
+            IntPtr plane2, int stride2,
+            uint cameraId,
+            ulong frameId,
+            int frameW,
+            int frameH,
+            int roiX,
+            int roiY,
+            int roiW,
+            int roiH,
+            float threshold);
+
+        [DllImport(Lib.Name, EntryPoint = "hailo_processor_write_frame_tiled")]
+        private static extern void WriteFrameTiled(IntPtr ptr,
+            IntPtr frame,
+            uint cameraId,
+            ulong frameId,
+            int frameW,
+            int frameH,
+            int roiX,
+            int roiY,
+            int roiW,
+            int roiH,
+            int cols,
+            int rows,
+            float overlap,
+            float threshold);
+
         [DllImport(Lib.Name, EntryPoint = "hailo_processor_start_async")]
         private static extern void StartAsyncProcessor(IntPtr ptr, IntPtr fPtr, IntPtr context);
 
@@ -134,9 +445,63 @@ namespace ModelingEvolution.VideoStreaming.Hailo
         [DllImport(Lib.Name, EntryPoint = "hailo_processor_set_confidence")]
         private static extern void SetConfidence(IntPtr ptr, float value);
 
+        [DllImport(Lib.Name, EntryPoint = "hailo_processor_get_resize_mode")]
+        private static extern int GetResizeMode(IntPtr ptr);
+
+        [DllImport(Lib.Name, EntryPoint = "hailo_processor_set_resize_mode")]
+        private static extern void SetResizeMode(IntPtr ptr, int value);
+
+        [DllImport(Lib.Name, EntryPoint = "hailo_processor_get_mask_mode")]
+        private static extern int GetMaskMode(IntPtr ptr);
+
+        [DllImport(Lib.Name, EntryPoint = "hailo_processor_set_mask_mode")]
+        private static extern void SetMaskMode(IntPtr ptr, int value);
+
+        [DllImport(Lib.Name, EntryPoint = "hailo_processor_get_mask_format")]
+        private static extern int GetMaskFormat(IntPtr ptr);
+
+        [DllImport(Lib.Name, EntryPoint = "hailo_processor_set_mask_format")]
+        private static extern void SetMaskFormat(IntPtr ptr, int value);
+
+        [DllImport(Lib.Name, EntryPoint = "hailo_processor_get_mask_threshold")]
+        private static extern float GetMaskThreshold(IntPtr ptr);
+
+        [DllImport(Lib.Name, EntryPoint = "hailo_processor_set_mask_threshold")]
+        private static extern void SetMaskThreshold(IntPtr ptr, float value);
+
+        [DllImport(Lib.Name, EntryPoint = "hailo_processor_set_pad_color")]
+        private static extern void SetPadColor(IntPtr ptr, byte r, byte g, byte b);
+
         [DllImport(Lib.Name, EntryPoint = "hailo_processor_update_stats")]
         private static extern void UpdateStats(IntPtr ptr, IntPtr stats);
 
+        [DllImport(Lib.Name, EntryPoint = "hailo_processor_update_stats_ex")]
+        private static extern unsafe int UpdateStatsEx(IntPtr ptr, HailoProcessorStatsEx* stats, int flags);
+
+        [DllImport(Lib.Name, EntryPoint = "hailo_processor_trace")]
+        private static extern void Trace(IntPtr ptr, int enable);
+
+        [DllImport(Lib.Name, EntryPoint = "hailo_processor_trace_export")]
+        private static extern int TraceExport(IntPtr ptr, string fileName, int seconds);
+
+        [DllImport(Lib.Name, EntryPoint = "hailo_processor_get_worker_stats")]
+        private static extern unsafe int GetWorkerStats(IntPtr ptr, HailoProcessorStatsEx.WorkerStats* dst, int capacity);
+
+        [DllImport(Lib.Name, EntryPoint = "hailo_processor_get_camera_stats")]
+        private static extern unsafe int GetCameraStats(IntPtr ptr, HailoProcessorStats.CameraStats* dst, int capacity);
+
+        [DllImport(Lib.Name, EntryPoint = "hailo_processor_set_admission")]
+        private static extern void SetAdmission(IntPtr ptr, int mode, int maxLatencyUs, float targetFps, int allowDownscale);
+
+        [DllImport(Lib.Name, EntryPoint = "memory_pool_configure")]
+        private static extern void MemoryPoolConfigure(int hugePages, int lockMemory);
+
+        [DllImport(Lib.Name, EntryPoint = "perf_counters_enable")]
+        private static extern int PerfCountersEnable(int enable);
+
+        [DllImport(Lib.Name, EntryPoint = "hailo_processor_set_camera")]
+        private static extern void SetCamera(IntPtr ptr, uint cameraId, int priority, uint weight, float maxFps, uint queueDepth);
+
         private readonly Stopwatch _sw = Stopwatch.StartNew();
         public ref HailoProcessorStats Stats
         {
@@ -156,6 +521,102 @@ namespace ModelingEvolution.VideoStreaming.Hailo
                 UpdateStats(_nativePtr, (IntPtr)ptr);
             }
         }
+        /// <summary>
+        /// Latency percentiles, rates and queues of every stage. With resetWindow the percentiles cover the time since the previous
+        /// reset, otherwise the lifetime; only one reader should reset.
+        /// </summary>
+        public unsafe HailoProcessorStatsEx GetStatsEx(bool resetWindow = false)
+        {
+            var result = new HailoProcessorStatsEx
+            {
+                Version = HailoProcessorStatsEx.CurrentVersion,
+                Size = (uint)sizeof(HailoProcessorStatsEx)
+            };
+            UpdateStatsEx(_nativePtr, &result, resetWindow ? 1 : 0);
+            return result;
+        }
+        /// <summary>
+        /// Records the start and end of every stage of every frame, with its thread, camera and iteration. Off by default.
+        /// </summary>
+        public void EnableTracing(bool enable)
+        {
+            Trace(_nativePtr, enable ? 1 : 0);
+        }
+
+        /// <summary>
+        /// Writes the spans of the last window (TimeSpan.Zero - all kept) as Chrome trace-event JSON, to open in Perfetto.
+        /// Returns the number of spans written.
+        /// </summary>
+        public int ExportTrace(string fileName, TimeSpan window = default)
+        {
+            int count = TraceExport(_nativePtr, fileName, (int)Math.Ceiling(window.TotalSeconds));
+            if (count < 0) throw new IOException($"Cannot write the trace to {fileName}.");
+            return count;
+        }
+        public unsafe HailoProcessorStatsEx.WorkerStats[] GetWorkerStats()
+        {
+            HailoProcessorStatsEx.WorkerStats[] result;
+            int count;
+            do
+            {
+                count = GetWorkerStats(_nativePtr, null, 0);
+                result = new HailoProcessorStatsEx.WorkerStats[count];
+                fixed (HailoProcessorStatsEx.WorkerStats* ptr = result)
+                    count = GetWorkerStats(_nativePtr, ptr, result.Length);
+            } while (count > result.Length);
+            return result;
+        }
+        public unsafe HailoProcessorStats.CameraStats[] GetCameraStats()
+        {
+            HailoProcessorStats.CameraStats[] result;
+            int count;
+            do
+            {
+                // cameras may show up between the calls.
+                count = GetCameraStats(_nativePtr, null, 0);
+                result = new HailoProcessorStats.CameraStats[count];
+                fixed (HailoProcessorStats.CameraStats* ptr = result)
+                    count = GetCameraStats(_nativePtr, ptr, result.Length);
+            } while (count > result.Length);
+            return result;
+        }
+
+        /// <summary>
+        /// Frames of cameras of a higher priority are always written first; within a priority cameras share the device by weight.
+        /// Frames over maxFps (0 - no cap) are skipped, and at most queueDepth frames wait per camera.
+        /// </summary>
+        public void ConfigureCamera(uint cameraId, CameraPriority priority = CameraPriority.Normal, uint weight = 1, float maxFps = 0, uint queueDepth = 2)
+        {
+            SetCamera(_nativePtr, cameraId, (int)priority, weight, maxFps, queueDepth);
+        }
+
+        /// <summary>
+        /// Decides per frame whether it is processed, dropped or, for tiled frames, run as one inference over the roi.
+        /// Latency mode keeps the predicted end-to-end latency within maxLatency; Throughput mode paces frames to targetFps (0 - what the pipeline sustains).
+        /// </summary>
+        public void ConfigureAdmission(AdmissionMode mode, TimeSpan maxLatency = default, float targetFps = 0, bool allowDownscale = true)
+        {
+            SetAdmission(_nativePtr, (int)mode, (int)(maxLatency.Ticks / 10), targetFps, allowDownscale ? 1 : 0);
+        }
+
+        /// <summary>
+        /// Backs frame, tensor and mask buffers with hugepages and/or locks them in memory. Process-wide;
+        /// only buffers allocated afterwards are affected, so call it before Load.
+        /// </summary>
+        public static void ConfigureMemoryPool(bool hugePages, bool lockMemory)
+        {
+            MemoryPoolConfigure(hugePages ? 1 : 0, lockMemory ? 1 : 0);
+        }
+
+        /// <summary>
+        /// Counts cycles, instructions, cache and branch misses per stage with perf_event_open. Process-wide, off by default.
+        /// Returns false when the kernel refuses, see HailoProcessorStatsEx.PerfStatus and PerfEventParanoid.
+        /// </summary>
+        public static bool EnablePerfCounters(bool enable)
+        {
+            return PerfCountersEnable(enable ? 1 : 0) > 0;
+        }
+
         private static string GetLastErrorMessage()
         {
             IntPtr errorPtr = GetLastError();
@@ -173,6 +634,26 @@ namespace ModelingEvolution.VideoStreaming.Hailo
                 throw new HailoException(GetLastErrorMessage());
             return Current = new HailoProcessor(ptr, fileName);
         }
+        // Loads the model and records the raw outputs of the first maxFrames frames (0 - all) to captureFile.
+        public static HailoProcessor LoadWithCapture(string fileName, string captureFile, int maxFrames = 0)
+        {
+            if (Current != null) throw new ArgumentException("Cannot load new model when Hailo is already in use.");
+
+            var ptr = LoadHefCapture(fileName, captureFile, maxFrames);
+            if (ptr == IntPtr.Zero)
+                throw new HailoException(GetLastErrorMessage());
+            return Current = new HailoProcessor(ptr, fileName);
+        }
+        // Runs the pipeline without the device: the recorded outputs are served with the given latency and jitter.
+        public static HailoProcessor LoadReplay(string captureFile, TimeSpan latency, TimeSpan jitter, uint seed = 0)
+        {
+            if (Current != null) throw new ArgumentException("Cannot load new model when Hailo is already in use.");
+
+            var ptr = LoadReplayNative(captureFile, (int)(latency.Ticks / 10), (int)(jitter.Ticks / 10), seed);
+            if (ptr == IntPtr.Zero)
+                throw new HailoException(GetLastErrorMessage());
+            return Current = new HailoProcessor(ptr, captureFile);
+        }
         public string FileName { get; }
         private HailoProcessor(IntPtr ptr, string fileName)
         {
@@ -204,6 +685,33 @@ namespace ModelingEvolution.VideoStreaming.Hailo
             WriteFrame(_nativePtr, frame, id.CameraId, id.FrameId,frameSize.Width, frameSize.Height, roi.X, roi.Y, roi.Width, roi.Height, threshold);
         }
 
+        /// <summary>
+        /// Writes a frame straight from capture buffers; strides are in bytes and unused planes are IntPtr.Zero.
+        /// </summary>
+        public void WritePlanes(PixelFormat format,
+            IntPtr plane0, int stride0,
+            IntPtr plane1, int stride1,
+            IntPtr plane2, int stride2,
+            in FrameIdentifier id,
+            in Size frameSize,
+            in Rectangle roi, float threshold = 0.8f)
+        {
+            WritePlanes(_nativePtr, (int)format, plane0, stride0, plane1, stride1, plane2, stride2,
+                id.CameraId, id.FrameId, frameSize.Width, frameSize.Height, roi.X, roi.Y, roi.Width, roi.Height, threshold);
+        }
+
+        /// <summary>
+        /// Runs the model on a cols x rows grid of overlapping tiles over the roi.
+        /// FrameProcessed fires once per frame with detections merged in frame coordinates.
+        /// </summary>
+        public void WriteFrameTiled(IntPtr frame,
+            in FrameIdentifier id,
+            in Size frameSize,
+            in Rectangle roi, int cols, int rows, float overlap = 0.2f, float threshold = 0.8f)
+        {
+            WriteFrameTiled(_nativePtr, frame, id.CameraId, id.FrameId, frameSize.Width, frameSize.Height, roi.X, roi.Y, roi.Width, roi.Height, cols, rows, overlap, threshold);
+        }
+
         public event EventHandler<SegmentationResult>? FrameProcessed; 
         private static void OnResult(IntPtr segmentationResult, IntPtr context)
         {
@@ -244,6 +752,33 @@ namespace ModelingEvolution.VideoStreaming.Hailo
             set => SetConfidence(_nativePtr, value);
         }
 
+        public ResizeMode ResizeMode
+        {
+            get => (ResizeMode)GetResizeMode(_nativePtr);
+            set => SetResizeMode(_nativePtr, (int)value);
+        }
+
+        public MaskMode MaskMode
+        {
+            get => (MaskMode)GetMaskMode(_nativePtr);
+            set => SetMaskMode(_nativePtr, (int)value);
+        }
+
+        public MaskFormat MaskFormat
+        {
+            get => (MaskFormat)GetMaskFormat(_nativePtr);
+            set => SetMaskFormat(_nativePtr, (int)value);
+        }
+
+        // Probability above which a pixel is foreground in the Bits and Rle formats.
+        public float MaskThreshold
+        {
+            get => GetMaskThreshold(_nativePtr);
+            set => SetMaskThreshold(_nativePtr, value);
+        }
+
+        public void SetPadColor(byte r, byte g, byte b) => SetPadColor(_nativePtr, r, g, b);
+
         public void Dispose()
         {
             if (_nativePtr != IntPtr.Zero && !_disposed)
@@ -258,6 +793,7 @@ namespace ModelingEvolution.VideoStreaming.Hailo
     public class SegmentationResult : IDisposable, IEnumerable<Segment>
     {
         private IntPtr _nativePtr;
+        private readonly ulong _handle;
         private bool _disposed = false;
 
         [DllImport(Lib.Name, EntryPoint = "segmentation_result_get")]
@@ -269,6 +805,12 @@ namespace ModelingEvolution.VideoStreaming.Hailo
         [DllImport(Lib.Name, EntryPoint = "segmentation_result_dispose")]
         private static extern void DisposeSegmentationResult(IntPtr ptr);
 
+        [DllImport(Lib.Name, EntryPoint = "segmentation_result_handle")]
+        private static extern ulong SegmentationResultHandle(IntPtr ptr);
+
+        [DllImport(Lib.Name, EntryPoint = "segmentation_result_release")]
+        private static extern int ReleaseSegmentationResult(ulong handle);
+
         [DllImport(Lib.Name, EntryPoint = "segmentation_result_id")]
         private static extern FrameIdentifier SegmentationResultId(IntPtr ptr);
 
@@ -288,6 +830,7 @@ namespace ModelingEvolution.VideoStreaming.Hailo
         public SegmentationResult(IntPtr nativePtr)
         {
             _nativePtr = nativePtr;
+            _handle = SegmentationResultHandle(nativePtr);
         }
 
         public Rectangle Roi => SegmentationResultRoi(_nativePtr);
@@ -319,7 +862,11 @@ namespace ModelingEvolution.VideoStreaming.Hailo
         {
             if (_nativePtr != IntPtr.Zero && !_disposed)
             {
-                DisposeSegmentationResult(_nativePtr);
+                // results are pooled, the handle does not release one that was reused meanwhile.
+                if (_handle != 0)
+                    ReleaseSegmentationResult(_handle);
+                else
+                    DisposeSegmentationResult(_nativePtr);
                 _nativePtr = IntPtr.Zero;
             }
             _segments?.Dispose();
@@ -362,6 +909,12 @@ namespace ModelingEvolution.VideoStreaming.Hailo
         [DllImport(Lib.Name, EntryPoint = "segment_get_bbox")]
         private static extern Rectangle<float> SegmentGetBbox(IntPtr segment);
 
+        [DllImport(Lib.Name, EntryPoint = "segment_get_frame_bbox")]
+        private static extern Rectangle<float> SegmentGetFrameBbox(IntPtr segment);
+
+        [DllImport(Lib.Name, EntryPoint = "segment_compute_frame_polygon")]
+        private static unsafe extern int ComputeFramePolygon(IntPtr segment, float threshold, int* buffer, int maxSize);
+
 
 
         [DllImport(Lib.Name, EntryPoint = "segment_get_resolution")]
@@ -369,6 +922,37 @@ namespace ModelingEvolution.VideoStreaming.Hailo
         
         public Size Resolution => SegmentGetResolution(_nativePtr);
 
+        [DllImport(Lib.Name, EntryPoint = "segment_get_mask_rect")]
+        private static extern Rectangle SegmentGetMaskRect(IntPtr segment);
+
+        /// <summary>
+        /// Gets the part of the resolution covered by the mask data; all of it unless MaskMode.Box is used.
+        /// </summary>
+        public Rectangle MaskRect => SegmentGetMaskRect(_nativePtr);
+
+        [DllImport(Lib.Name, EntryPoint = "segment_get_mask_format")]
+        private static extern int SegmentGetMaskFormat(IntPtr segment);
+
+        [DllImport(Lib.Name, EntryPoint = "segment_get_mask_buffer")]
+        private static extern unsafe byte* SegmentGetMaskBuffer(IntPtr segment, out int bytes);
+
+        /// <summary>
+        /// Gets the format the mask data is stored in, see HailoProcessor.MaskFormat.
+        /// </summary>
+        public MaskFormat MaskFormat => (MaskFormat)SegmentGetMaskFormat(_nativePtr);
+
+        /// <summary>
+        /// Gets the mask data in MaskFormat, without copying. Valid as long as the segmentation result is.
+        /// </summary>
+        public unsafe ReadOnlySpan<byte> MaskBuffer
+        {
+            get
+            {
+                byte* data = SegmentGetMaskBuffer(_nativePtr, out int bytes);
+                return new ReadOnlySpan<byte>(data, bytes);
+            }
+        }
+
         /// <summary>
         /// Gets the bbox normalized to the resolution.
         /// </summary>
@@ -388,6 +972,11 @@ namespace ModelingEvolution.VideoStreaming.Hailo
             }
         }
 
+        /// <summary>
+        /// Gets the bbox in pixels of the written frame.
+        /// </summary>
+        public Rectangle<float> FrameBbox => SegmentGetFrameBbox(this._nativePtr);
+
         public Segment(IntPtr nativePtr)
         {
             _nativePtr = nativePtr;
@@ -404,6 +993,25 @@ namespace ModelingEvolution.VideoStreaming.Hailo
             return new Mat(height, width, DepthType.Cv32F,1, dataPtr, width);
         }
 
+        /// <summary>
+        /// Gets the mask data, MaskRect sized. Bits and Rle masks have no pixels, use MaskBuffer.
+        /// </summary>
+        public unsafe Mat GetMask()
+        {
+            var rect = MaskRect;
+            switch (MaskFormat)
+            {
+                case MaskFormat.Float:
+                    return GetMask(rect.Width, rect.Height);
+                case MaskFormat.Probability:
+                    // segment_get_data serves float masks only; the bytes are stored as MaskRect-sized rows.
+                    byte* data = SegmentGetMaskBuffer(_nativePtr, out _);
+                    return new Mat(rect.Height, rect.Width, DepthType.Cv8U, 1, (IntPtr)data, rect.Width);
+                default:
+                    throw new InvalidOperationException($"{MaskFormat} masks are encoded, use MaskBuffer.");
+            }
+        }
+
         public unsafe ManagedArray<VectorU16> ComputePolygonVectorU16(float threshold = 0.8f)
         {
             int[] buffer = ArrayPool<int>.Shared.Rent(1024 * 128);
@@ -433,6 +1041,23 @@ namespace ModelingEvolution.VideoStreaming.Hailo
                 return result;
             }
         }
+
+        /// <summary>
+        /// Computes the polygon in pixels of the written frame.
+        /// </summary>
+        public unsafe Polygon<float>? ComputeFramePolygon(float threshold = 0.8f)
+        {
+            int[] buffer = ArrayPool<int>.Shared.Rent(1024 * 128);
+            fixed (int* ptr = buffer)
+            {
+                int count = ComputeFramePolygon(_nativePtr, threshold, ptr, buffer.Length);
+                if (count == 0) return null;
+
+                Polygon<float> result = new Polygon<float>(buffer.ToPointList(count));
+                ArrayPool<int>.Shared.Return(buffer);
+                return result;
+            }
+        }
     }
 
     static class ArrayToPointExtension